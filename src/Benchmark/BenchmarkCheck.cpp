@@ -0,0 +1,667 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "BenchmarkCheck.h"
+#include "PDB.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_IPIStream.h"
+#include "PDB_BinaryAnnotations.h"
+#include "PDB_Executor.h"
+#include "PDB_FunctionIndex.h"
+#include "PDB_ModuleInlineTable.h"
+#include "PDB_ModuleLineTable.h"
+#include "PDB_ModuleSymbolCursor.h"
+#include "PDB_SectionContributionIndex.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+	// number of RVAs checked against linear scans over whole streams, which are expensive for large files
+	static constexpr const size_t StreamSampleCount = 256u;
+
+	// number of RVAs checked against linear scans over the lines or inline sites of a single module
+	static constexpr const size_t ModuleSampleCount = 32u;
+
+	// number of mismatches printed per check
+	static constexpr const uint64_t PrintedMismatchCount = 8u;
+
+
+	// counts the comparisons and mismatches of one check
+	class Checker
+	{
+	public:
+		explicit Checker(const char* name)
+			: m_name(name)
+			, m_comparisonCount(0u)
+			, m_mismatchCount(0u)
+		{
+		}
+
+		void Expect(bool isMatch, uint32_t value)
+		{
+			++m_comparisonCount;
+			if (isMatch)
+			{
+				return;
+			}
+
+			if (m_mismatchCount < PrintedMismatchCount)
+			{
+				fprintf(stderr, "  %s: mismatch at 0x%08X\n", m_name, value);
+			}
+
+			++m_mismatchCount;
+		}
+
+		bool PrintSummary(void) const
+		{
+			fprintf(stderr, "  %-22s %10llu comparisons %10llu mismatches\n", m_name, static_cast<unsigned long long>(m_comparisonCount), static_cast<unsigned long long>(m_mismatchCount));
+
+			return (m_mismatchCount == 0u);
+		}
+
+	private:
+		const char* m_name;
+		uint64_t m_comparisonCount;
+		uint64_t m_mismatchCount;
+	};
+
+
+	PDB_NO_DISCARD static bool IsProcedure(const PDB::CodeView::DBI::Record* record)
+	{
+		using SymbolRecordKind = PDB::CodeView::DBI::SymbolRecordKind;
+
+		const SymbolRecordKind kind = record->header.kind;
+		return (kind == SymbolRecordKind::S_LPROC32) || (kind == SymbolRecordKind::S_GPROC32) || (kind == SymbolRecordKind::S_LPROC32_ID) ||
+			(kind == SymbolRecordKind::S_GPROC32_ID) || (kind == SymbolRecordKind::S_LPROC32_DPC) || (kind == SymbolRecordKind::S_LPROC32_DPC_ID);
+	}
+
+
+	PDB_NO_DISCARD static bool IsInlineSite(const PDB::CodeView::DBI::Record* record)
+	{
+		return (record->header.kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE) || (record->header.kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE2);
+	}
+
+
+	// appends the given RVA and its direct neighbours, which are the most likely to be off by one
+	static void AddBoundary(std::vector<uint32_t>& rvas, uint32_t rva)
+	{
+		rvas.push_back(rva - 1u);
+		rvas.push_back(rva);
+		rvas.push_back(rva + 1u);
+	}
+
+
+	// checks Lookup(), the batched Lookup() and LookupSorted() against a linear scan over the functions of the index, and the
+	// functions of the index against a linear scan over the procedures of all modules
+	static bool CheckFunctionIndex(const PDB::RawFile& rawFile, const PDB::ImageSectionStream& imageSectionStream, const PDB::ModuleInfoStream& moduleInfoStream,
+		const PDB::CoalescedMSFStream& symbolRecordStream, const PDB::PublicSymbolStream& publicSymbolStream, const PDB::SectionContributionStream& sectionContributionStream, std::mt19937& random)
+	{
+		const PDB::FunctionIndex functionIndex(rawFile, imageSectionStream, moduleInfoStream, symbolRecordStream, publicSymbolStream, sectionContributionStream);
+		const uint32_t functionCount = functionIndex.GetFunctionCount();
+
+		std::vector<uint32_t> rvas = { 0u, 0xFFFFFFFFu };
+		if (functionCount != 0u)
+		{
+			const uint32_t lastRVA = functionIndex.GetRVA(functionCount - 1u) + functionIndex.GetSize(functionCount - 1u);
+			for (size_t i = 0u; i < StreamSampleCount; ++i)
+			{
+				const uint32_t function = random() % functionCount;
+				AddBoundary(rvas, functionIndex.GetRVA(function));
+				AddBoundary(rvas, functionIndex.GetRVA(function) + functionIndex.GetSize(function));
+				rvas.push_back(random() % (lastRVA + 1u));
+			}
+		}
+
+		std::vector<uint32_t> functionIndices(rvas.size());
+		std::vector<uint32_t> sortedFunctionIndices(rvas.size());
+		functionIndex.Lookup(rvas.data(), rvas.size(), functionIndices.data());
+		functionIndex.LookupSorted(rvas.data(), rvas.size(), sortedFunctionIndices.data());
+
+		Checker lookupChecker("functionIndex");
+		for (size_t i = 0u; i < rvas.size(); ++i)
+		{
+			const uint32_t rva = rvas[i];
+
+			uint32_t expected = PDB::FunctionIndex::InvalidFunction;
+			for (uint32_t function = 0u; function < functionCount; ++function)
+			{
+				if ((rva >= functionIndex.GetRVA(function)) && (rva - functionIndex.GetRVA(function) < functionIndex.GetSize(function)))
+				{
+					expected = function;
+				}
+			}
+
+			lookupChecker.Expect((functionIndex.Lookup(rva) == expected) && (functionIndices[i] == expected) && (sortedFunctionIndices[i] == expected), rva);
+		}
+
+		// every procedure with code needs to be found at its start, even if identical code folding merged it with others
+		Checker procedureChecker("functionIndexProcedures");
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasSymbolStream())
+			{
+				continue;
+			}
+
+			const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+			moduleSymbolStream.ForEachSymbol([&imageSectionStream, &functionIndex, &procedureChecker](const PDB::CodeView::DBI::Record* record)
+			{
+				if (!IsProcedure(record) || (record->data.S_GPROC32.codeSize == 0u))
+				{
+					return;
+				}
+
+				const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+				if (rva == 0u)
+				{
+					return;
+				}
+
+				const uint32_t function = functionIndex.Lookup(rva);
+				procedureChecker.Expect((function != PDB::FunctionIndex::InvalidFunction) && (functionIndex.GetRVA(function) == rva), rva);
+			});
+		}
+
+		const bool isLookupValid = lookupChecker.PrintSummary();
+		const bool isProcedureValid = procedureChecker.PrintSummary();
+
+		return isLookupValid && isProcedureValid;
+	}
+
+
+	// checks the serial and parallel section contribution index against a linear scan over all contributions.
+	// the contribution starting last owns an RVA, and among those, the one ending first, or the last one in the stream.
+	static bool CheckSectionContributionIndex(const PDB::RawFile& rawFile, const PDB::ImageSectionStream& imageSectionStream, const PDB::SectionContributionStream& sectionContributionStream,
+		uint32_t threadCount, std::mt19937& random)
+	{
+		const PDB::ThreadExecutor threadExecutor(threadCount);
+		const PDB::SectionContributionIndex contributionIndex(rawFile, imageSectionStream, sectionContributionStream);
+		const PDB::SectionContributionIndex parallelContributionIndex(rawFile, imageSectionStream, sectionContributionStream, threadExecutor.GetExecutor());
+
+		const PDB::ArrayView<PDB::DBI::SectionContribution> contributions = sectionContributionStream.GetContributions();
+		const size_t sectionCount = imageSectionStream.GetImageSections().GetLength();
+
+		std::vector<uint32_t> starts(contributions.GetLength());
+		std::vector<uint32_t> ends(contributions.GetLength());
+		for (size_t i = 0u; i < contributions.GetLength(); ++i)
+		{
+			const PDB::DBI::SectionContribution& contribution = contributions[i];
+			if ((contribution.section == 0u) || (contribution.section > sectionCount) || (contribution.size == 0u))
+			{
+				continue;
+			}
+
+			starts[i] = imageSectionStream.ConvertSectionOffsetToRVA(contribution.section, contribution.offset);
+			ends[i] = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(starts[i]) + contribution.size, 0xFFFFFFFFu));
+		}
+
+		std::vector<uint32_t> rvas = { 0u, 0xFFFFFFFFu };
+		for (size_t i = 0u; (i < StreamSampleCount) && (contributions.GetLength() != 0u); ++i)
+		{
+			const size_t contribution = random() % contributions.GetLength();
+			AddBoundary(rvas, starts[contribution]);
+			AddBoundary(rvas, ends[contribution]);
+		}
+
+		Checker checker("sectionContributions");
+		for (const uint32_t rva : rvas)
+		{
+			size_t owner = contributions.GetLength();
+			for (size_t i = 0u; i < contributions.GetLength(); ++i)
+			{
+				if ((rva < starts[i]) || (rva >= ends[i]))
+				{
+					continue;
+				}
+
+				if ((owner == contributions.GetLength()) || (starts[i] > starts[owner]) || ((starts[i] == starts[owner]) && (ends[i] <= ends[owner])))
+				{
+					owner = i;
+				}
+			}
+
+			const PDB::DBI::SectionContribution* expected = (owner != contributions.GetLength()) ? &contributions[owner] : nullptr;
+			const PDB::DBI::SectionContribution* contribution = contributionIndex.FindContribution(rva);
+			checker.Expect((contribution == expected) && (parallelContributionIndex.FindContribution(rva) == expected), rva);
+		}
+
+		return checker.PrintSummary();
+	}
+
+
+	// checks FindPublicByAddress() against a linear scan over the hash records of all public symbols
+	static bool CheckPublicSymbols(const PDB::ImageSectionStream& imageSectionStream, const PDB::CoalescedMSFStream& symbolRecordStream, const PDB::PublicSymbolStream& publicSymbolStream,
+		std::mt19937& random)
+	{
+		struct Address
+		{
+			uint16_t section;
+			uint32_t offset;
+		};
+
+		std::vector<Address> addresses;
+		for (const PDB::HashRecord& hashRecord : publicSymbolStream.GetRecords())
+		{
+			const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+			if (record && (record->header.kind == PDB::CodeView::DBI::SymbolRecordKind::S_PUB32))
+			{
+				addresses.push_back(Address { record->data.S_PUB32.section, record->data.S_PUB32.offset });
+			}
+		}
+
+		std::vector<Address> queries = { Address { 0u, 0u }, Address { 1u, 0u }, Address { 1u, 0xFFFFFFFFu } };
+		for (size_t i = 0u; (i < StreamSampleCount) && !addresses.empty(); ++i)
+		{
+			const Address& address = addresses[random() % addresses.size()];
+			queries.push_back(Address { address.section, address.offset - 1u });
+			queries.push_back(address);
+			queries.push_back(Address { address.section, address.offset + 1u });
+			queries.push_back(Address { static_cast<uint16_t>(1u + random() % (imageSectionStream.GetImageSections().GetLength() + 1u)), address.offset });
+		}
+
+		Checker checker("publicSymbols");
+		for (const Address& query : queries)
+		{
+			const Address* expected = nullptr;
+			for (const Address& address : addresses)
+			{
+				if ((address.section == query.section) && (address.offset <= query.offset) && (!expected || (address.offset > expected->offset)))
+				{
+					expected = &address;
+				}
+			}
+
+			// symbols can share an address, so only the address of the symbol found can be compared
+			const PDB::CodeView::DBI::Record* record = publicSymbolStream.FindPublicByAddress(symbolRecordStream, query.section, query.offset);
+			const bool isMatch = expected
+				? (record && (record->data.S_PUB32.section == expected->section) && (record->data.S_PUB32.offset == expected->offset))
+				: !record;
+			checker.Expect(isMatch, query.offset);
+		}
+
+		return checker.PrintSummary();
+	}
+
+
+	// checks the line table of a module against a linear scan over all lines of its line stream
+	static void CheckLineTable(const PDB::RawFile& rawFile, const PDB::ImageSectionStream& imageSectionStream, const PDB::ModuleLineStream& moduleLineStream, Checker& checker,
+		std::mt19937& random)
+	{
+		struct Line
+		{
+			uint32_t start;
+			uint32_t end;
+			uint32_t lineNumber;
+			uint32_t filenameOffset;
+		};
+
+		std::vector<Line> lines;
+		moduleLineStream.ForEachSection([&imageSectionStream, &moduleLineStream, &lines](const PDB::CodeView::DBI::DebugSubsectionHeader* section)
+		{
+			if (section->kind != PDB::CodeView::DBI::DebugSubsectionKind::S_LINES)
+			{
+				return;
+			}
+
+			moduleLineStream.ForEachLinesBlock(section, [&imageSectionStream, &moduleLineStream, &lines](const PDB::CodeView::DBI::LinesHeader* linesHeader, const PDB::CodeView::DBI::LinesFileBlockHeader* block)
+			{
+				const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(linesHeader->sectionIndex, linesHeader->sectionOffset);
+				if (rva == 0u)
+				{
+					return;
+				}
+
+				const PDB::CodeView::DBI::Line* blockLines = moduleLineStream.GetLines(block);
+				const uint32_t filenameOffset = moduleLineStream.GetFileChecksumHeader(block->fileChecksumOffset)->filenameOffset;
+				for (uint32_t i = 0u; i < block->numLines; ++i)
+				{
+					// hidden lines cover their code, but don't resolve to a line
+					const uint32_t lineNumber = blockLines[i].linenumStart;
+					const bool isHidden = (lineNumber == 0xFEEFEEu) || (lineNumber == 0xF00F00u);
+					const uint32_t end = (i + 1u < block->numLines) ? blockLines[i + 1u].offset : linesHeader->codeSize;
+					lines.push_back(Line { rva + blockLines[i].offset, rva + end, isHidden ? PDB::ModuleLineTable::InvalidLine : lineNumber, filenameOffset });
+				}
+			});
+		});
+
+		if (lines.empty())
+		{
+			return;
+		}
+
+		const PDB::ModuleLineTable lineTable(rawFile, moduleLineStream, imageSectionStream);
+
+		std::vector<uint32_t> rvas;
+		for (size_t i = 0u; i < ModuleSampleCount; ++i)
+		{
+			const Line& line = lines[random() % lines.size()];
+			AddBoundary(rvas, line.start);
+			AddBoundary(rvas, line.end);
+		}
+
+		std::vector<uint32_t> lineIndices(rvas.size());
+		lineTable.Lookup(rvas.data(), rvas.size(), lineIndices.data());
+
+		for (size_t i = 0u; i < rvas.size(); ++i)
+		{
+			const uint32_t rva = rvas[i];
+
+			// the line starting last owns an RVA, and among those starting at the same RVA, the first one that is not hidden
+			const Line* expected = nullptr;
+			for (const Line& line : lines)
+			{
+				if ((rva < line.start) || (rva >= line.end))
+				{
+					continue;
+				}
+
+				if (!expected || (line.start > expected->start) || ((line.start == expected->start) && (expected->lineNumber == PDB::ModuleLineTable::InvalidLine)))
+				{
+					expected = &line;
+				}
+			}
+
+			const uint32_t lineIndex = lineTable.Lookup(rva);
+			const bool isMatch = (expected && (expected->lineNumber != PDB::ModuleLineTable::InvalidLine))
+				? ((lineIndex != PDB::ModuleLineTable::InvalidLine) && (lineTable.GetLineNumber(lineIndex) == expected->lineNumber) && (lineTable.GetFilenameOffset(lineIndex) == expected->filenameOffset))
+				: (lineIndex == PDB::ModuleLineTable::InvalidLine);
+			checker.Expect(isMatch && (lineIndices[i] == lineIndex), rva);
+		}
+	}
+
+
+	// checks the inline table of a module against a linear scan over the code ranges of all its inline sites
+	static void CheckInlineTable(const PDB::RawFile& rawFile, const PDB::ImageSectionStream& imageSectionStream, const PDB::IPIStream& ipiStream,
+		const PDB::ModuleSymbolStream& moduleSymbolStream, const PDB::ModuleLineStream& moduleLineStream, Checker& checker, std::mt19937& random)
+	{
+		struct Piece
+		{
+			uint32_t start;
+			uint32_t end;
+			uint32_t depth;
+			uint32_t inlinee;
+		};
+
+		// the inline depth of every open scope, which is 0 outside of inline sites
+		std::vector<Piece> pieces;
+		std::vector<uint32_t> scopeDepths;
+		uint32_t procedureRVA = 0u;
+		moduleSymbolStream.ForEachSymbol([&imageSectionStream, &pieces, &scopeDepths, &procedureRVA](const PDB::CodeView::DBI::Record* record)
+		{
+			if (PDB::IsScopeEndRecord(record))
+			{
+				if (!scopeDepths.empty())
+				{
+					scopeDepths.pop_back();
+				}
+
+				return;
+			}
+			else if (!PDB::IsScopeStartRecord(record))
+			{
+				return;
+			}
+
+			const uint32_t parentDepth = scopeDepths.empty() ? 0u : scopeDepths.back();
+			if (IsProcedure(record))
+			{
+				procedureRVA = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+			}
+
+			if (!IsInlineSite(record))
+			{
+				scopeDepths.push_back(parentDepth);
+				return;
+			}
+
+			const uint32_t depth = parentDepth + 1u;
+			const uint32_t inlinee = (record->header.kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE2) ? record->data.S_INLINESITE2.inlinee : record->data.S_INLINESITE.inlinee;
+			scopeDepths.push_back(depth);
+
+			if (procedureRVA == 0u)
+			{
+				return;
+			}
+
+			PDB::ForEachInlineSiteRange(record, 0u, 0u, [&pieces, procedureRVA, depth, inlinee](uint32_t codeOffset, uint32_t codeLength, uint32_t /* lineNumber */, uint32_t /* fileChecksumOffset */)
+			{
+				pieces.push_back(Piece { procedureRVA + codeOffset, procedureRVA + codeOffset + codeLength, depth, inlinee });
+			});
+		});
+
+		const PDB::ModuleInlineTable inlineTable(rawFile, moduleSymbolStream, moduleLineStream, imageSectionStream, ipiStream);
+
+		std::vector<uint32_t> rvas;
+		for (size_t i = 0u; (i < ModuleSampleCount) && !pieces.empty(); ++i)
+		{
+			const Piece& piece = pieces[random() % pieces.size()];
+			AddBoundary(rvas, piece.start);
+			AddBoundary(rvas, piece.end);
+		}
+
+		std::vector<uint32_t> rangeIndices(rvas.size());
+		inlineTable.Lookup(rvas.data(), rvas.size(), rangeIndices.data());
+
+		for (size_t i = 0u; i < rvas.size(); ++i)
+		{
+			const uint32_t rva = rvas[i];
+
+			// the stack is as deep as the innermost inline site covering the RVA
+			uint32_t expectedDepth = 0u;
+			for (const Piece& piece : pieces)
+			{
+				if ((rva >= piece.start) && (rva < piece.end))
+				{
+					expectedDepth = std::max(expectedDepth, piece.depth);
+				}
+			}
+
+			const uint32_t rangeIndex = inlineTable.Lookup(rva);
+			if (expectedDepth == 0u)
+			{
+				checker.Expect((rangeIndex == PDB::ModuleInlineTable::InvalidRange) && (rangeIndices[i] == rangeIndex), rva);
+				continue;
+			}
+
+			if ((rangeIndex == PDB::ModuleInlineTable::InvalidRange) || (rangeIndices[i] != rangeIndex))
+			{
+				checker.Expect(false, rva);
+				continue;
+			}
+
+			// the innermost frame needs to belong to one of the innermost sites covering the RVA
+			const PDB::ArrayView<PDB::ModuleInlineTable::Frame> stack = inlineTable.GetInlineStack(rangeIndex);
+			bool isMatch = false;
+			for (const Piece& piece : pieces)
+			{
+				isMatch |= (rva >= piece.start) && (rva < piece.end) && (piece.depth == expectedDepth) && (stack.GetLength() == expectedDepth) && (stack[expectedDepth - 1u].inlinee == piece.inlinee);
+			}
+
+			checker.Expect(isMatch, rva);
+		}
+	}
+
+
+	// checks that the top-level traversal and the cursor visit the same records as a linear scan over the module symbols.
+	// the filter descends into procedures only, which covers skipping both nested and top-level scopes.
+	static void CheckModuleSymbols(const PDB::RawFile& rawFile, const PDB::ModuleInfoStream::Module& module, const PDB::ModuleSymbolStream& moduleSymbolStream,
+		Checker& cursorChecker, Checker& topLevelChecker)
+	{
+		std::vector<const PDB::CodeView::DBI::Record*> records;
+		moduleSymbolStream.ForEachSymbol([&records](const PDB::CodeView::DBI::Record* record)
+		{
+			records.push_back(record);
+		});
+
+		// the cursor returns copies of the records, which need to be identical to the ones of the stream
+		auto isSameRecord = [](const PDB::CodeView::DBI::Record* record, const PDB::CodeView::DBI::Record* expected)
+		{
+			return (memcmp(record, expected, sizeof(PDB::CodeView::DBI::RecordHeader::size) + expected->header.size) == 0);
+		};
+
+		{
+			PDB::ModuleSymbolCursor cursor(rawFile, module);
+			size_t index = 0u;
+			for (const PDB::CodeView::DBI::Record* record = cursor.Next(); record; record = cursor.Next(), ++index)
+			{
+				cursorChecker.Expect((index < records.size()) && isSameRecord(record, records[index]), cursor.GetOffset());
+			}
+
+			cursorChecker.Expect(index == records.size(), static_cast<uint32_t>(index));
+		}
+
+		for (uint32_t mode = 0u; mode < 2u; ++mode)
+		{
+			auto shouldDescend = [mode](const PDB::CodeView::DBI::Record* record)
+			{
+				return (mode == 1u) && IsProcedure(record);
+			};
+
+			// the records outside of skipped scopes, including the records opening them
+			std::vector<const PDB::CodeView::DBI::Record*> expected;
+			size_t skippedDepth = 0u;
+			for (const PDB::CodeView::DBI::Record* record : records)
+			{
+				if (skippedDepth != 0u)
+				{
+					skippedDepth += PDB::IsScopeStartRecord(record) ? 1u : 0u;
+					skippedDepth -= PDB::IsScopeEndRecord(record) ? 1u : 0u;
+					continue;
+				}
+
+				expected.push_back(record);
+				skippedDepth = (PDB::IsScopeStartRecord(record) && !shouldDescend(record)) ? 1u : 0u;
+			}
+
+			size_t index = 0u;
+			moduleSymbolStream.ForEachSymbol([&topLevelChecker, &expected, &index](const PDB::CodeView::DBI::Record* record)
+			{
+				topLevelChecker.Expect((index < expected.size()) && (record == expected[index]), static_cast<uint32_t>(index));
+				++index;
+			}, shouldDescend);
+			topLevelChecker.Expect(index == expected.size(), static_cast<uint32_t>(index));
+
+			PDB::ModuleSymbolCursor cursor(rawFile, module);
+			index = 0u;
+			cursor.ForEachSymbol([&cursorChecker, &expected, &index, &isSameRecord](const PDB::CodeView::DBI::Record* record)
+			{
+				cursorChecker.Expect((index < expected.size()) && isSameRecord(record, expected[index]), static_cast<uint32_t>(index));
+				++index;
+			}, shouldDescend);
+			cursorChecker.Expect(index == expected.size(), static_cast<uint32_t>(index));
+		}
+	}
+}
+
+
+bool Check::Run(const PDB::BlockSource& source, const PDB::Allocator& allocator, uint32_t threadCount)
+{
+	if (PDB::ValidateFile(source) != PDB::ErrorCode::Success)
+	{
+		return false;
+	}
+
+	const PDB::RawFile rawFile = PDB::CreateRawFile(source, allocator);
+	if (PDB::HasValidDBIStream(rawFile) != PDB::ErrorCode::Success)
+	{
+		return false;
+	}
+
+	const PDB::InfoStream infoStream(rawFile);
+	if (infoStream.UsesDebugFastLink())
+	{
+		return false;
+	}
+
+	// the same seed checks the same RVAs every time
+	std::mt19937 random(1u);
+	bool isValid = true;
+
+	const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawFile);
+	const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawFile);
+	const PDB::CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawFile);
+
+	const bool hasSections = (dbiStream.HasValidImageSectionStream(rawFile) == PDB::ErrorCode::Success);
+	const bool hasPublics = (dbiStream.HasValidPublicSymbolStream(rawFile) == PDB::ErrorCode::Success);
+	const bool hasContributions = (dbiStream.HasValidSectionContributionStream(rawFile) == PDB::ErrorCode::Success);
+	const bool hasIPI = (PDB::HasValidIPIStream(rawFile) == PDB::ErrorCode::Success);
+	const bool hasNames = infoStream.HasNamesStream() && (infoStream.HasValidNamesStream(rawFile) == PDB::ErrorCode::Success);
+
+	if (hasSections)
+	{
+		const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+
+		if (hasPublics)
+		{
+			const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawFile);
+			isValid &= CheckPublicSymbols(imageSectionStream, symbolRecordStream, publicSymbolStream, random);
+
+			if (hasContributions)
+			{
+				const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawFile);
+				isValid &= CheckFunctionIndex(rawFile, imageSectionStream, moduleInfoStream, symbolRecordStream, publicSymbolStream, sectionContributionStream, random);
+			}
+		}
+
+		if (hasContributions)
+		{
+			const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawFile);
+			isValid &= CheckSectionContributionIndex(rawFile, imageSectionStream, sectionContributionStream, threadCount, random);
+		}
+
+		if (hasNames)
+		{
+			const PDB::IPIStream ipiStream = hasIPI ? PDB::CreateIPIStream(rawFile) : PDB::IPIStream();
+
+			Checker lineChecker("lineTables");
+			Checker inlineChecker("inlineTables");
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasLineStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleLineStream moduleLineStream = module.CreateLineStream(rawFile);
+				CheckLineTable(rawFile, imageSectionStream, moduleLineStream, lineChecker, random);
+
+				if (hasIPI && module.HasSymbolStream())
+				{
+					const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+					CheckInlineTable(rawFile, imageSectionStream, ipiStream, moduleSymbolStream, moduleLineStream, inlineChecker, random);
+				}
+			}
+
+			isValid &= lineChecker.PrintSummary();
+			isValid &= inlineChecker.PrintSummary();
+		}
+	}
+
+	{
+		Checker cursorChecker("moduleSymbolsCursor");
+		Checker topLevelChecker("moduleSymbolsTopLevel");
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasSymbolStream())
+			{
+				continue;
+			}
+
+			const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+			CheckModuleSymbols(rawFile, module, moduleSymbolStream, cursorChecker, topLevelChecker);
+		}
+
+		isValid &= cursorChecker.PrintSummary();
+		isValid &= topLevelChecker.PrintSummary();
+	}
+
+	return isValid;
+}
@@ -0,0 +1,17 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "PDB_Allocator.h"
+#include "PDB_BlockSource.h"
+#include <cstdint>
+
+
+namespace Check
+{
+	// Compares the results of every index and traversal the benchmark measures against a plain linear scan over the same streams,
+	// using a deterministic sample of RVAs. Prints the first few mismatches of every check to stderr.
+	// Returns false in case any result differs from its linear scan, or the file cannot be checked.
+	bool Run(const PDB::BlockSource& source, const PDB::Allocator& allocator, uint32_t threadCount);
+}
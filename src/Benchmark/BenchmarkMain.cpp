@@ -0,0 +1,1051 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "BenchmarkCheck.h"
+#include "BenchmarkMappedFile.h"
+#include "BenchmarkMemory.h"
+#include "PDB.h"
+#include "PDB_RawFile.h"
+#include "PDB_BlockSource.h"
+#include "PDB_BlockCache.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_IPIStream.h"
+#include "PDB_FunctionIndex.h"
+#include "PDB_ModuleInlineTable.h"
+#include "PDB_ModuleLineTable.h"
+#include "PDB_ModuleSymbolCursor.h"
+#include "PDB_ModuleWorkQueue.h"
+#include "PDB_SectionContributionIndex.h"
+#include "PDB_SymbolVisitor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+
+namespace
+{
+	enum class Phase : uint32_t
+	{
+		Directory,
+		StreamReads,
+		StreamReadsRunMap,
+		DBI,
+		ModuleInfo,
+		SymbolRecords,
+		Publics,
+		Globals,
+		ModuleSymbols,
+		ModuleSymbolsTopLevel,
+		ModuleProcedures,
+		ModuleSymbolsParallel,
+		ModuleSymbolsCursor,
+		CompileRecords,
+		IPI,
+		SectionOffsets,
+		FunctionIndex,
+		Lookup,
+		LookupSorted,
+		LineTables,
+		LineLookup,
+		InlineTables,
+		InlineLookup,
+
+		Count
+	};
+
+	static const char* const PhaseNames[] =
+	{
+		"directory",
+		"streamReads",
+		"streamReadsRunMap",
+		"dbi",
+		"moduleInfo",
+		"symbolRecords",
+		"publics",
+		"globals",
+		"moduleSymbols",
+		"moduleSymbolsTopLevel",
+		"moduleProcedures",
+		"moduleSymbolsParallel",
+		"moduleSymbolsCursor",
+		"compileRecords",
+		"ipi",
+		"sectionOffsets",
+		"functionIndex",
+		"lookup",
+		"lookupSorted",
+		"lineTables",
+		"lineLookup",
+		"inlineTables",
+		"inlineLookup"
+	};
+
+	static_assert(sizeof(PhaseNames) / sizeof(PhaseNames[0]) == static_cast<size_t>(Phase::Count), "Missing phase name.");
+
+
+	// determines how the benchmark hands the file to the library
+	enum class Source
+	{
+		Mapped,				// memory-mapped data only, disjunct blocks are copied
+		Remapped,			// memory-mapped data along with the file descriptor, disjunct blocks are remapped where supported
+		Read,				// nothing is memory-mapped, all data is read using pread()
+		Cached				// nothing is memory-mapped, all data is read through a block cache that fetches missing pages using pread()
+	};
+
+
+	struct Options
+	{
+		uint32_t iterations;
+		uint32_t warmupIterations;
+		Source source;
+		size_t cacheSize;
+		const char* outputPath;
+		const char* tracePath;
+		uint32_t threadCount;
+		bool check;
+		std::vector<uint32_t> trace;
+		std::vector<const char*> paths;
+	};
+
+
+	// a single measurement of one phase
+	struct Sample
+	{
+		double milliSeconds;
+		CountingAllocator::Counters counters;
+		uint64_t peakResidentSetSize;
+		uint64_t elementCount;
+	};
+
+
+	struct FileResult
+	{
+		std::string path;
+		uint64_t size;
+		bool isValid;
+		std::vector<Sample> samples[static_cast<size_t>(Phase::Count)];
+	};
+
+
+	// measures one phase at a time
+	class PhaseRecorder
+	{
+	public:
+		explicit PhaseRecorder(CountingAllocator& allocator, FileResult& result, bool isRecording)
+			: m_allocator(allocator)
+			, m_result(result)
+			, m_isRecording(isRecording)
+			, m_counters()
+			, m_begin()
+		{
+		}
+
+		void Begin(void)
+		{
+			ResidentSetSize::ResetPeak();
+			m_counters = m_allocator.GetCounters();
+			m_begin = std::chrono::steady_clock::now();
+		}
+
+		void End(Phase phase, uint64_t elementCount)
+		{
+			const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			const std::chrono::duration<double, std::milli> milliSeconds = end - m_begin;
+			const CountingAllocator::Counters counters = m_allocator.GetCounters();
+
+			if (!m_isRecording)
+			{
+				return;
+			}
+
+			const CountingAllocator::Counters delta =
+			{
+				counters.allocationCount - m_counters.allocationCount,
+				counters.allocatedBytes - m_counters.allocatedBytes,
+				counters.copiedBytes - m_counters.copiedBytes
+			};
+
+			m_result.samples[static_cast<size_t>(phase)].push_back(Sample { milliSeconds.count(), delta, ResidentSetSize::ReadPeak(), elementCount });
+		}
+
+	private:
+		CountingAllocator& m_allocator;
+		FileResult& m_result;
+		bool m_isRecording;
+		CountingAllocator::Counters m_counters;
+		std::chrono::steady_clock::time_point m_begin;
+	};
+
+
+	static void ReadFromFile(void* userData, void* destination, size_t size, size_t fileOffset)
+	{
+		const int file = *static_cast<const int*>(userData);
+
+		char* bytes = static_cast<char*>(destination);
+		while (size != 0u)
+		{
+			const ssize_t bytesRead = pread(file, bytes, size, static_cast<off_t>(fileOffset));
+			if (bytesRead <= 0)
+			{
+				// reading past the end of the file, which can only happen for corrupt files
+				memset(bytes, 0, size);
+				return;
+			}
+
+			bytes += bytesRead;
+			size -= static_cast<size_t>(bytesRead);
+			fileOffset += static_cast<size_t>(bytesRead);
+		}
+	}
+
+
+	static PDB::BlockSource CreateBlockSource(Source source, MappedFile::Handle& file)
+	{
+		switch (source)
+		{
+			case Source::Mapped:
+				return PDB::BlockSource(file.baseAddress);
+
+			case Source::Remapped:
+				return PDB::BlockSource(file.baseAddress, file.file);
+
+			case Source::Read:
+				return PDB::BlockSource(&ReadFromFile, &file.file);
+
+			case Source::Cached:
+				// needs a cache, see RunFile()
+				break;
+		}
+
+		return PDB::BlockSource(file.baseAddress);
+	}
+
+
+	// reads an address trace, which is a plain array of 32-bit little-endian RVAs, e.g. recorded by a sampling profiler
+	static bool ReadTrace(const char* path, std::vector<uint32_t>& trace)
+	{
+		FILE* file = fopen(path, "rb");
+		if (!file)
+		{
+			return false;
+		}
+
+		uint32_t buffer[4096u];
+		size_t count = 0u;
+		while ((count = fread(buffer, sizeof(uint32_t), sizeof(buffer) / sizeof(buffer[0]), file)) != 0u)
+		{
+			trace.insert(trace.end(), buffer, buffer + count);
+		}
+
+		const bool isValid = (ferror(file) == 0);
+		fclose(file);
+
+		return isValid && !trace.empty();
+	}
+
+
+	// reads all non-empty streams of the file in chunks of the size of the buffer, either block by block or whole runs of contiguous blocks
+	// at once. comparing files with different layouts, e.g. created using RawPDBGenerator --layout, shows what the run map saves.
+	static uint64_t ReadAllStreams(const PDB::RawFile& rawFile, bool useRunMap, std::vector<uint8_t>& buffer, uint32_t& checksum)
+	{
+		uint64_t byteCount = 0u;
+		for (uint32_t i = 0u; i < rawFile.GetStreamCount(); ++i)
+		{
+			PDB::DirectMSFStream stream = rawFile.CreateMSFStream<PDB::DirectMSFStream>(i);
+
+			// nil streams store a size of 0xFFFFFFFF
+			const uint32_t size = stream.GetSize();
+			if ((size == 0u) || (size == 0xFFFFFFFFu))
+			{
+				continue;
+			}
+
+			if (useRunMap)
+			{
+				stream.BuildContiguousRunMap();
+			}
+
+			for (uint32_t offset = 0u; offset < size; /* nothing */)
+			{
+				const uint32_t chunkSize = static_cast<uint32_t>(std::min<size_t>(size - offset, buffer.size()));
+				stream.ReadAtOffset(buffer.data(), chunkSize, offset);
+				checksum += buffer[0];
+
+				offset += chunkSize;
+			}
+
+			byteCount += size;
+		}
+
+		return byteCount;
+	}
+
+
+	// runs all phases once, in the order a typical symbolizer would
+	static bool RunIteration(const PDB::BlockSource& source, const std::vector<uint32_t>& trace, uint32_t threadCount, CountingAllocator& allocator, PhaseRecorder& recorder)
+	{
+		recorder.Begin();
+		if (PDB::ValidateFile(source) != PDB::ErrorCode::Success)
+		{
+			return false;
+		}
+
+		const PDB::RawFile rawFile = PDB::CreateRawFile(source, allocator.GetAllocator());
+		recorder.End(Phase::Directory, rawFile.GetStreamCount());
+
+		// touch every byte of every stream, once block by block and once using the run map
+		uint32_t checksum = 0u;
+		{
+			std::vector<uint8_t> buffer(1024u * 1024u);
+
+			recorder.Begin();
+			const uint64_t byteCount = ReadAllStreams(rawFile, false, buffer, checksum);
+			recorder.End(Phase::StreamReads, byteCount);
+
+			recorder.Begin();
+			const uint64_t runMapByteCount = ReadAllStreams(rawFile, true, buffer, checksum);
+			recorder.End(Phase::StreamReadsRunMap, runMapByteCount);
+		}
+
+		if (PDB::HasValidDBIStream(rawFile) != PDB::ErrorCode::Success)
+		{
+			return false;
+		}
+
+		const PDB::InfoStream infoStream(rawFile);
+		if (infoStream.UsesDebugFastLink())
+		{
+			return false;
+		}
+
+		recorder.Begin();
+		const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawFile);
+		const bool hasPublics = (dbiStream.HasValidPublicSymbolStream(rawFile) == PDB::ErrorCode::Success);
+		const bool hasGlobals = (dbiStream.HasValidGlobalSymbolStream(rawFile) == PDB::ErrorCode::Success);
+		recorder.End(Phase::DBI, 1u);
+
+		recorder.Begin();
+		const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawFile);
+		recorder.End(Phase::ModuleInfo, moduleInfoStream.GetModules().GetLength());
+
+		recorder.Begin();
+		const PDB::CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawFile);
+		recorder.End(Phase::SymbolRecords, symbolRecordStream.GetSize());
+
+		// touch every record, otherwise only the hash records would be faulted in
+		if (hasPublics)
+		{
+			recorder.Begin();
+			const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawFile);
+			const PDB::ArrayView<PDB::HashRecord> hashRecords = publicSymbolStream.GetRecords();
+			for (const PDB::HashRecord& hashRecord : hashRecords)
+			{
+				const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+				checksum += static_cast<uint32_t>(record->header.kind);
+			}
+			recorder.End(Phase::Publics, hashRecords.GetLength());
+		}
+
+		if (hasGlobals)
+		{
+			recorder.Begin();
+			const PDB::GlobalSymbolStream globalSymbolStream = dbiStream.CreateGlobalSymbolStream(rawFile);
+			const PDB::ArrayView<PDB::HashRecord> hashRecords = globalSymbolStream.GetRecords();
+			for (const PDB::HashRecord& hashRecord : hashRecords)
+			{
+				const PDB::CodeView::DBI::Record* record = globalSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+				checksum += static_cast<uint32_t>(record->header.kind);
+			}
+			recorder.End(Phase::Globals, hashRecords.GetLength());
+		}
+
+		{
+			recorder.Begin();
+			uint64_t recordCount = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+				moduleSymbolStream.ForEachSymbol([&recordCount, &checksum](const PDB::CodeView::DBI::Record* record)
+				{
+					checksum += static_cast<uint32_t>(record->header.kind);
+					++recordCount;
+				});
+			}
+			recorder.End(Phase::ModuleSymbols, recordCount);
+		}
+
+		// only the top-level records of every module, jumping over the contents of all procedures and other scopes
+		{
+			recorder.Begin();
+			uint64_t recordCount = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+				moduleSymbolStream.ForEachSymbol([&recordCount, &checksum](const PDB::CodeView::DBI::Record* record)
+				{
+					checksum += static_cast<uint32_t>(record->header.kind);
+					++recordCount;
+				},
+				[](const PDB::CodeView::DBI::Record* /* scope */)
+				{
+					return false;
+				});
+			}
+			recorder.End(Phase::ModuleSymbolsTopLevel, recordCount);
+		}
+
+		// only the procedures and thunks of every module, filtered by kind at compile time
+		{
+			using SymbolRecordKind = PDB::CodeView::DBI::SymbolRecordKind;
+
+			recorder.Begin();
+			uint64_t procedureCount = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+				PDB::ForEachSymbolOfKind<SymbolRecordKind::S_THUNK32, SymbolRecordKind::S_LPROC32, SymbolRecordKind::S_GPROC32, SymbolRecordKind::S_LPROC32_ID, SymbolRecordKind::S_GPROC32_ID>(moduleSymbolStream,
+					[&procedureCount, &checksum](const auto& view)
+				{
+					checksum += view.GetData().offset;
+					++procedureCount;
+				});
+			}
+			recorder.End(Phase::ModuleProcedures, procedureCount);
+		}
+
+		// the same traversal, distributed across all threads. every worker counts into its own accumulator.
+		{
+			struct Accumulator
+			{
+				uint64_t recordCount;
+				uint32_t checksum;
+			};
+
+			const PDB::ThreadExecutor threadExecutor(threadCount);
+			std::vector<Accumulator> accumulators(threadCount, Accumulator { 0u, 0u });
+
+			recorder.Begin();
+			PDB::ForEachModuleSymbolParallel(rawFile, moduleInfoStream, threadExecutor.GetExecutor(), accumulators.data(), threadCount,
+				[](Accumulator& accumulator, uint32_t /* moduleIndex */, const PDB::CodeView::DBI::Record* record)
+				{
+					accumulator.checksum += static_cast<uint32_t>(record->header.kind);
+					++accumulator.recordCount;
+				},
+				[](Accumulator& destination, const Accumulator& source)
+				{
+					destination.checksum += source.checksum;
+					destination.recordCount += source.recordCount;
+				});
+			recorder.End(Phase::ModuleSymbolsParallel, accumulators[0].recordCount);
+
+			checksum += accumulators[0].checksum;
+		}
+
+		// the same traversal once more, streaming the records of each module instead of coalescing its symbols
+		{
+			recorder.Begin();
+			uint64_t recordCount = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				PDB::ModuleSymbolCursor cursor(rawFile, module);
+				cursor.ForEachSymbol([&recordCount, &checksum](const PDB::CodeView::DBI::Record* record)
+				{
+					checksum += static_cast<uint32_t>(record->header.kind);
+					++recordCount;
+				});
+			}
+			recorder.End(Phase::ModuleSymbolsCursor, recordCount);
+		}
+
+		// find the S_COMPILE3 record of every module, which is usually one of the first records
+		{
+			recorder.Begin();
+			uint64_t compileRecordCount = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				PDB::ModuleSymbolCursor cursor(rawFile, module);
+				const PDB::CodeView::DBI::Record* record = cursor.FindRecord(PDB::CodeView::DBI::SymbolRecordKind::S_COMPILE3);
+				if (record)
+				{
+					checksum += record->data.S_COMPILE3.versionBackendBuild;
+					++compileRecordCount;
+				}
+			}
+			recorder.End(Phase::CompileRecords, compileRecordCount);
+		}
+
+		if (PDB::HasValidIPIStream(rawFile) == PDB::ErrorCode::Success)
+		{
+			recorder.Begin();
+			const PDB::IPIStream ipiStream = PDB::CreateIPIStream(rawFile);
+			recorder.End(Phase::IPI, ipiStream.GetTypeRecords().GetLength());
+		}
+
+		// convert the addresses of all public symbols into RVAs in one batch
+		const bool hasSections = (dbiStream.HasValidImageSectionStream(rawFile) == PDB::ErrorCode::Success);
+		if (hasPublics && hasSections)
+		{
+			const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+			const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawFile);
+			const PDB::ArrayView<PDB::HashRecord> hashRecords = publicSymbolStream.GetRecords();
+
+			std::vector<uint16_t> sections;
+			std::vector<uint32_t> offsets;
+			sections.reserve(hashRecords.GetLength());
+			offsets.reserve(hashRecords.GetLength());
+			for (const PDB::HashRecord& hashRecord : hashRecords)
+			{
+				const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+				if (record)
+				{
+					sections.push_back(record->data.S_PUB32.section);
+					offsets.push_back(record->data.S_PUB32.offset);
+				}
+			}
+
+			std::vector<uint32_t> rvas(sections.size());
+
+			recorder.Begin();
+			imageSectionStream.ConvertSectionOffsetsToRVAs(sections.data(), offsets.data(), sections.size(), rvas.data());
+			recorder.End(Phase::SectionOffsets, sections.size());
+
+			if (!rvas.empty())
+			{
+				checksum += rvas.back();
+			}
+		}
+
+		// replay the address trace against the function index
+		const bool hasContributions = (dbiStream.HasValidSectionContributionStream(rawFile) == PDB::ErrorCode::Success);
+		if (!trace.empty() && hasPublics && hasSections && hasContributions)
+		{
+			recorder.Begin();
+			const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+			const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawFile);
+			const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawFile);
+			const PDB::FunctionIndex functionIndex(rawFile, imageSectionStream, moduleInfoStream, symbolRecordStream, publicSymbolStream, sectionContributionStream);
+			recorder.End(Phase::FunctionIndex, functionIndex.GetFunctionCount());
+
+			std::vector<uint32_t> functionIndices(trace.size());
+
+			recorder.Begin();
+			functionIndex.Lookup(trace.data(), trace.size(), functionIndices.data());
+			recorder.End(Phase::Lookup, trace.size());
+			checksum += functionIndices.back();
+
+			recorder.Begin();
+			functionIndex.LookupSorted(trace.data(), trace.size(), functionIndices.data());
+			recorder.End(Phase::LookupSorted, trace.size());
+			checksum += functionIndices.back();
+		}
+
+		// build the line tables of all modules, and resolve the address trace into source lines
+		if (hasSections && infoStream.HasNamesStream() && (infoStream.HasValidNamesStream(rawFile) == PDB::ErrorCode::Success))
+		{
+			const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+			const PDB::ArrayView<PDB::ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
+
+			recorder.Begin();
+			std::vector<PDB::ModuleLineTable> lineTables(modules.GetLength());
+			uint64_t lineCount = 0u;
+			for (size_t i = 0u; i < modules.GetLength(); ++i)
+			{
+				if (!modules[i].HasLineStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleLineStream moduleLineStream = modules[i].CreateLineStream(rawFile);
+				lineTables[i] = PDB::ModuleLineTable(rawFile, moduleLineStream, imageSectionStream);
+				lineCount += lineTables[i].GetLineCount();
+			}
+			recorder.End(Phase::LineTables, lineCount);
+
+			// inline tables additionally need the module symbols, and the IPI stream for the names of inlined functions
+			const bool hasIPI = (PDB::HasValidIPIStream(rawFile) == PDB::ErrorCode::Success);
+			std::vector<PDB::ModuleInlineTable> inlineTables(hasIPI ? modules.GetLength() : 0u);
+			if (hasIPI)
+			{
+				const PDB::IPIStream ipiStream = PDB::CreateIPIStream(rawFile);
+
+				recorder.Begin();
+				uint64_t rangeCount = 0u;
+				for (size_t i = 0u; i < modules.GetLength(); ++i)
+				{
+					if (!modules[i].HasLineStream())
+					{
+						continue;
+					}
+
+					const PDB::ModuleSymbolStream moduleSymbolStream = modules[i].CreateSymbolStream(rawFile);
+					const PDB::ModuleLineStream moduleLineStream = modules[i].CreateLineStream(rawFile);
+					inlineTables[i] = PDB::ModuleInlineTable(rawFile, moduleSymbolStream, moduleLineStream, imageSectionStream, ipiStream);
+					rangeCount += inlineTables[i].GetRangeCount();
+				}
+				recorder.End(Phase::InlineTables, rangeCount);
+			}
+
+			if (!trace.empty() && hasContributions)
+			{
+				// group the RVAs by the module owning them, so that each line table is searched with one batch
+				const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawFile);
+				const PDB::SectionContributionIndex contributionIndex(rawFile, imageSectionStream, sectionContributionStream);
+
+				std::vector<uint32_t> moduleOffsets(modules.GetLength() + 1u, 0u);
+				std::vector<uint32_t> owners(trace.size());
+				for (size_t i = 0u; i < trace.size(); ++i)
+				{
+					const PDB::DBI::SectionContribution* contribution = contributionIndex.FindContribution(trace[i]);
+					owners[i] = (contribution && (contribution->moduleIndex < modules.GetLength())) ? contribution->moduleIndex : UINT32_MAX;
+					if (owners[i] != UINT32_MAX)
+					{
+						++moduleOffsets[owners[i] + 1u];
+					}
+				}
+
+				for (size_t i = 1u; i < moduleOffsets.size(); ++i)
+				{
+					moduleOffsets[i] += moduleOffsets[i - 1u];
+				}
+
+				std::vector<uint32_t> groupedRVAs(moduleOffsets.back());
+				std::vector<uint32_t> nextOffsets(moduleOffsets.begin(), moduleOffsets.end() - 1);
+				for (size_t i = 0u; i < trace.size(); ++i)
+				{
+					if (owners[i] != UINT32_MAX)
+					{
+						groupedRVAs[nextOffsets[owners[i]]++] = trace[i];
+					}
+				}
+
+				std::vector<uint32_t> lineIndices(groupedRVAs.size());
+
+				recorder.Begin();
+				for (size_t i = 0u; i < lineTables.size(); ++i)
+				{
+					const uint32_t first = moduleOffsets[i];
+					lineTables[i].Lookup(groupedRVAs.data() + first, moduleOffsets[i + 1u] - first, lineIndices.data() + first);
+				}
+				recorder.End(Phase::LineLookup, groupedRVAs.size());
+
+				if (!lineIndices.empty())
+				{
+					checksum += lineIndices.back();
+				}
+
+				if (!inlineTables.empty())
+				{
+					std::vector<uint32_t> rangeIndices(groupedRVAs.size());
+
+					recorder.Begin();
+					for (size_t i = 0u; i < inlineTables.size(); ++i)
+					{
+						const uint32_t first = moduleOffsets[i];
+						inlineTables[i].Lookup(groupedRVAs.data() + first, moduleOffsets[i + 1u] - first, rangeIndices.data() + first);
+					}
+					recorder.End(Phase::InlineLookup, groupedRVAs.size());
+
+					if (!rangeIndices.empty())
+					{
+						checksum += rangeIndices.back();
+					}
+				}
+			}
+		}
+
+		// make sure the compiler cannot get rid of touching the records
+		volatile uint32_t sink = checksum;
+		(void)sink;
+
+		return true;
+	}
+
+
+	static FileResult RunFile(const char* path, const Options& options, CountingAllocator& allocator)
+	{
+		FileResult result {};
+		result.path = path;
+
+		MappedFile::Handle file = MappedFile::Open(path);
+		if (!file.baseAddress)
+		{
+			fprintf(stderr, "Cannot memory-map file %s\n", path);
+
+			return result;
+		}
+
+		result.size = file.size;
+		result.isValid = true;
+
+		// the cache lives as long as the file, so only the warmup iterations fetch pages from disk, unless the cache is too small
+		std::unique_ptr<PDB::BlockCache> cache;
+		std::unique_ptr<PDB::CachedBlockSource> cachedSource;
+		if (options.source == Source::Cached)
+		{
+			cache.reset(new PDB::BlockCache(options.cacheSize));
+			cachedSource.reset(new PDB::CachedBlockSource(*cache, file.file));
+		}
+
+		const PDB::BlockSource source = cachedSource ? cachedSource->GetBlockSource() : CreateBlockSource(options.source, file);
+		if (options.check)
+		{
+			fprintf(stderr, "%s\n", path);
+			result.isValid = Check::Run(source, allocator.GetAllocator(), options.threadCount);
+			if (!result.isValid)
+			{
+				fprintf(stderr, "File %s failed the checks, is not a valid PDB, or was linked using /DEBUG:FASTLINK\n", path);
+			}
+		}
+
+		for (uint32_t i = 0u; !options.check && (i < options.warmupIterations + options.iterations); ++i)
+		{
+			PhaseRecorder recorder(allocator, result, i >= options.warmupIterations);
+			if (!RunIteration(source, options.trace, options.threadCount, allocator, recorder))
+			{
+				fprintf(stderr, "File %s is not a valid PDB, or was linked using /DEBUG:FASTLINK\n", path);
+				result.isValid = false;
+
+				break;
+			}
+		}
+
+		cachedSource.reset();
+		cache.reset();
+		MappedFile::Close(file);
+
+		return result;
+	}
+
+
+	// nearest-rank percentile of sorted values
+	static double Percentile(const std::vector<double>& sortedValues, double percentile)
+	{
+		const size_t count = sortedValues.size();
+		size_t rank = static_cast<size_t>((percentile / 100.0) * static_cast<double>(count) + 0.999999);
+		rank = (rank == 0u) ? 1u : rank;
+
+		return sortedValues[std::min(rank, count) - 1u];
+	}
+
+
+	static double Median(const std::vector<double>& sortedValues)
+	{
+		const size_t count = sortedValues.size();
+		if (count % 2u == 0u)
+		{
+			return (sortedValues[count / 2u - 1u] + sortedValues[count / 2u]) * 0.5;
+		}
+
+		return sortedValues[count / 2u];
+	}
+
+
+	static void WriteJsonString(FILE* file, const char* string)
+	{
+		fputc('"', file);
+		for (const char* c = string; *c != '\0'; ++c)
+		{
+			const unsigned char character = static_cast<unsigned char>(*c);
+			if ((character == '"') || (character == '\\'))
+			{
+				fprintf(file, "\\%c", character);
+			}
+			else if (character < 0x20u)
+			{
+				fprintf(file, "\\u%04x", character);
+			}
+			else
+			{
+				fputc(character, file);
+			}
+		}
+		fputc('"', file);
+	}
+
+
+	static void WriteJson(FILE* file, const Options& options, const std::vector<FileResult>& results, bool canResetPeak)
+	{
+		static const char* const SourceNames[] = { "mapped", "remapped", "read", "cached" };
+
+		fprintf(file, "{\n");
+		fprintf(file, "  \"iterations\": %u,\n", options.iterations);
+		fprintf(file, "  \"warmupIterations\": %u,\n", options.warmupIterations);
+		fprintf(file, "  \"source\": \"%s\",\n", SourceNames[static_cast<size_t>(options.source)]);
+		fprintf(file, "  \"threads\": %u,\n", options.threadCount);
+		fprintf(file, "  \"perPhasePeakRss\": %s,\n", canResetPeak ? "true" : "false");
+		fprintf(file, "  \"traceLength\": %zu,\n", options.trace.size());
+		fprintf(file, "  \"files\": [\n");
+
+		for (size_t i = 0u; i < results.size(); ++i)
+		{
+			const FileResult& result = results[i];
+
+			fprintf(file, "    {\n");
+			fprintf(file, "      \"path\": ");
+			WriteJsonString(file, result.path.c_str());
+			fprintf(file, ",\n");
+			fprintf(file, "      \"size\": %llu,\n", static_cast<unsigned long long>(result.size));
+			fprintf(file, "      \"valid\": %s,\n", result.isValid ? "true" : "false");
+			fprintf(file, "      \"phases\": [");
+
+			bool isFirstPhase = true;
+			for (size_t phase = 0u; phase < static_cast<size_t>(Phase::Count); ++phase)
+			{
+				const std::vector<Sample>& samples = result.samples[phase];
+				if (!result.isValid || samples.empty())
+				{
+					continue;
+				}
+
+				std::vector<double> times;
+				uint64_t peakResidentSetSize = 0u;
+				for (const Sample& sample : samples)
+				{
+					times.push_back(sample.milliSeconds);
+					peakResidentSetSize = std::max(peakResidentSetSize, sample.peakResidentSetSize);
+				}
+				std::sort(times.begin(), times.end());
+
+				// allocations are deterministic, so any sample will do
+				const Sample& last = samples.back();
+
+				fprintf(file, "%s\n        {\n", isFirstPhase ? "" : ",");
+				fprintf(file, "          \"name\": \"%s\",\n", PhaseNames[phase]);
+				fprintf(file, "          \"samples\": %zu,\n", samples.size());
+				fprintf(file, "          \"medianMs\": %.6f,\n", Median(times));
+				fprintf(file, "          \"p99Ms\": %.6f,\n", Percentile(times, 99.0));
+				fprintf(file, "          \"minMs\": %.6f,\n", times.front());
+				fprintf(file, "          \"maxMs\": %.6f,\n", times.back());
+				fprintf(file, "          \"elements\": %llu,\n", static_cast<unsigned long long>(last.elementCount));
+				fprintf(file, "          \"allocations\": %llu,\n", static_cast<unsigned long long>(last.counters.allocationCount));
+				fprintf(file, "          \"bytesAllocated\": %llu,\n", static_cast<unsigned long long>(last.counters.allocatedBytes));
+				fprintf(file, "          \"bytesCopied\": %llu,\n", static_cast<unsigned long long>(last.counters.copiedBytes));
+				fprintf(file, "          \"peakRssBytes\": %llu\n", static_cast<unsigned long long>(peakResidentSetSize));
+				fprintf(file, "        }");
+
+				isFirstPhase = false;
+			}
+
+			fprintf(file, "\n      ]\n");
+			fprintf(file, "    }%s\n", (i + 1u < results.size()) ? "," : "");
+		}
+
+		fprintf(file, "  ]\n");
+		fprintf(file, "}\n");
+	}
+
+
+	static void PrintSummary(const std::vector<FileResult>& results)
+	{
+		for (const FileResult& result : results)
+		{
+			fprintf(stderr, "%s\n", result.path.c_str());
+			for (size_t phase = 0u; phase < static_cast<size_t>(Phase::Count); ++phase)
+			{
+				const std::vector<Sample>& samples = result.samples[phase];
+				if (!result.isValid || samples.empty())
+				{
+					continue;
+				}
+
+				std::vector<double> times;
+				for (const Sample& sample : samples)
+				{
+					times.push_back(sample.milliSeconds);
+				}
+				std::sort(times.begin(), times.end());
+
+				fprintf(stderr, "  %-14s median %10.3fms  p99 %10.3fms  copied %12llu bytes\n", PhaseNames[phase], Median(times), Percentile(times, 99.0),
+					static_cast<unsigned long long>(samples.back().counters.copiedBytes));
+			}
+		}
+	}
+
+
+	static void PrintUsage(void)
+	{
+		fprintf(stderr,
+			"Usage: RawPDBBenchmark [options] <file.pdb>...\n"
+			"  --iterations <n>     number of measured iterations per file (default: 10)\n"
+			"  --warmup <n>         number of unmeasured iterations per file (default: 1)\n"
+			"  --source <source>    mapped, remapped, read or cached (default: mapped)\n"
+			"  --cache-size <mb>    capacity of the block cache used by --source cached in MiB (default: 256)\n"
+			"  --output <path>      write JSON results to the given file instead of stdout\n"
+			"  --trace <path>       replay the RVAs stored in the given address trace against a function index\n"
+			"  --threads <n>        number of threads used by parallel phases (default: number of hardware threads)\n"
+			"  --check              compare all indices against linear scans instead of measuring, and fail on any mismatch\n");
+	}
+
+
+	static bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		options.iterations = 10u;
+		options.warmupIterations = 1u;
+		options.source = Source::Mapped;
+		options.cacheSize = 256u * 1024u * 1024u;
+		options.outputPath = nullptr;
+		options.tracePath = nullptr;
+		options.threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		options.check = false;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* argument = argv[i];
+			const bool hasValue = (i + 1 < argc);
+
+			if ((strcmp(argument, "--iterations") == 0) && hasValue)
+			{
+				options.iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if ((strcmp(argument, "--warmup") == 0) && hasValue)
+			{
+				options.warmupIterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if ((strcmp(argument, "--source") == 0) && hasValue)
+			{
+				const char* source = argv[++i];
+				if (strcmp(source, "mapped") == 0)
+				{
+					options.source = Source::Mapped;
+				}
+				else if (strcmp(source, "remapped") == 0)
+				{
+					options.source = Source::Remapped;
+				}
+				else if (strcmp(source, "read") == 0)
+				{
+					options.source = Source::Read;
+				}
+				else if (strcmp(source, "cached") == 0)
+				{
+					options.source = Source::Cached;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if ((strcmp(argument, "--cache-size") == 0) && hasValue)
+			{
+				options.cacheSize = static_cast<size_t>(strtoull(argv[++i], nullptr, 10)) * 1024u * 1024u;
+			}
+			else if ((strcmp(argument, "--output") == 0) && hasValue)
+			{
+				options.outputPath = argv[++i];
+			}
+			else if ((strcmp(argument, "--trace") == 0) && hasValue)
+			{
+				options.tracePath = argv[++i];
+			}
+			else if ((strcmp(argument, "--threads") == 0) && hasValue)
+			{
+				options.threadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			}
+			else if (strcmp(argument, "--check") == 0)
+			{
+				options.check = true;
+			}
+			else if (argument[0] == '-')
+			{
+				return false;
+			}
+			else
+			{
+				options.paths.push_back(argument);
+			}
+		}
+
+		return (options.iterations != 0u) && (options.threadCount != 0u) && !options.paths.empty();
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+
+		return 1;
+	}
+
+	if (options.tracePath && !ReadTrace(options.tracePath, options.trace))
+	{
+		fprintf(stderr, "Cannot read address trace %s\n", options.tracePath);
+
+		return 2;
+	}
+
+	const bool canResetPeak = ResidentSetSize::ResetPeak();
+
+	CountingAllocator allocator;
+	std::vector<FileResult> results;
+	bool allValid = true;
+	for (const char* path : options.paths)
+	{
+		results.push_back(RunFile(path, options, allocator));
+		allValid &= results.back().isValid;
+	}
+
+	if (options.check)
+	{
+		return allValid ? 0 : 4;
+	}
+
+	FILE* output = stdout;
+	if (options.outputPath)
+	{
+		output = fopen(options.outputPath, "w");
+		if (!output)
+		{
+			fprintf(stderr, "Cannot open output file %s\n", options.outputPath);
+
+			return 2;
+		}
+	}
+
+	WriteJson(output, options, results, canResetPeak);
+	PrintSummary(results);
+
+	if (output != stdout)
+	{
+		fclose(output);
+	}
+
+	return allValid ? 0 : 3;
+}
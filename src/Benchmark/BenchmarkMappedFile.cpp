@@ -0,0 +1,48 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "BenchmarkMappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+MappedFile::Handle MappedFile::Open(const char* path)
+{
+	const int file = open(path, O_RDONLY);
+	if (file == -1)
+	{
+		return Handle { -1, nullptr, 0u };
+	}
+
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) == -1) || (fileStat.st_size == 0))
+	{
+		close(file);
+
+		return Handle { -1, nullptr, 0u };
+	}
+
+	const size_t size = static_cast<size_t>(fileStat.st_size);
+	void* baseAddress = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	if (baseAddress == MAP_FAILED)
+	{
+		close(file);
+
+		return Handle { -1, nullptr, 0u };
+	}
+
+	return Handle { file, baseAddress, size };
+}
+
+
+void MappedFile::Close(Handle& handle)
+{
+	munmap(handle.baseAddress, handle.size);
+	close(handle.file);
+
+	handle.file = -1;
+	handle.baseAddress = nullptr;
+	handle.size = 0u;
+}
@@ -0,0 +1,20 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstddef>
+
+
+namespace MappedFile
+{
+	struct Handle
+	{
+		int file;
+		void* baseAddress;
+		size_t size;
+	};
+
+	Handle Open(const char* path);
+	void Close(Handle& handle);
+}
@@ -0,0 +1,94 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "BenchmarkMemory.h"
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <sys/resource.h>
+
+
+CountingAllocator::CountingAllocator(void)
+	: m_allocationCount(0u)
+	, m_allocatedBytes(0u)
+	, m_copiedBytes(0u)
+{
+}
+
+
+PDB::Allocator CountingAllocator::GetAllocator(void)
+{
+	return PDB::Allocator { &CountingAllocator::Allocate, &CountingAllocator::Free, this, &CountingAllocator::Copied };
+}
+
+
+CountingAllocator::Counters CountingAllocator::GetCounters(void) const
+{
+	return Counters { m_allocationCount.load(std::memory_order_relaxed), m_allocatedBytes.load(std::memory_order_relaxed), m_copiedBytes.load(std::memory_order_relaxed) };
+}
+
+
+void* CountingAllocator::Allocate(void* userData, size_t size, size_t /* alignment */)
+{
+	CountingAllocator* allocator = static_cast<CountingAllocator*>(userData);
+	allocator->m_allocationCount.fetch_add(1u, std::memory_order_relaxed);
+	allocator->m_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	return ::operator new(size);
+}
+
+
+void CountingAllocator::Free(void* /* userData */, void* memory)
+{
+	::operator delete(memory);
+}
+
+
+void CountingAllocator::Copied(void* userData, size_t size)
+{
+	CountingAllocator* allocator = static_cast<CountingAllocator*>(userData);
+	allocator->m_copiedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+
+bool ResidentSetSize::ResetPeak(void)
+{
+	// writing 5 to clear_refs resets the peak RSS (VmHWM) of the process, supported since Linux 4.0
+	FILE* file = fopen("/proc/self/clear_refs", "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	const bool success = (fputs("5", file) >= 0);
+
+	return (fclose(file) == 0) && success;
+}
+
+
+uint64_t ResidentSetSize::ReadPeak(void)
+{
+	FILE* file = fopen("/proc/self/status", "r");
+	if (file)
+	{
+		char line[256];
+		while (fgets(line, sizeof(line), file))
+		{
+			unsigned long long kiloBytes = 0u;
+			if (sscanf(line, "VmHWM: %llu kB", &kiloBytes) == 1)
+			{
+				fclose(file);
+
+				return kiloBytes * 1024u;
+			}
+		}
+
+		fclose(file);
+	}
+
+	// fall back to the peak over the whole lifetime of the process
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+}
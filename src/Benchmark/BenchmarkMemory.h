@@ -0,0 +1,49 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "PDB_Allocator.h"
+#include <atomic>
+#include <cstdint>
+
+
+// an allocator that counts all allocations made by the library, as well as all bytes the library reports to have copied into them,
+// e.g. when coalescing disjunct blocks.
+class CountingAllocator
+{
+public:
+	struct Counters
+	{
+		uint64_t allocationCount;
+		uint64_t allocatedBytes;
+		uint64_t copiedBytes;
+	};
+
+	CountingAllocator(void);
+
+	PDB::Allocator GetAllocator(void);
+	Counters GetCounters(void) const;
+
+private:
+	static void* Allocate(void* userData, size_t size, size_t alignment);
+	static void Free(void* userData, void* memory);
+	static void Copied(void* userData, size_t size);
+
+	std::atomic<uint64_t> m_allocationCount;
+	std::atomic<uint64_t> m_allocatedBytes;
+	std::atomic<uint64_t> m_copiedBytes;
+
+	PDB_DISABLE_COPY_MOVE(CountingAllocator);
+};
+
+
+namespace ResidentSetSize
+{
+	// Resets the peak resident set size of the process to its current resident set size.
+	// Returns false if the kernel does not support resetting it, in which case the peak covers the whole lifetime of the process.
+	bool ResetPeak(void);
+
+	// Returns the peak resident set size of the process in bytes.
+	uint64_t ReadPeak(void);
+}
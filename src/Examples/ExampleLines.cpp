@@ -0,0 +1,145 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "ExampleTimedScope.h"
+#include "PDB_RawFile.h"
+#include "PDB_DBIStream.h"
+#include "PDB_InfoStream.h"
+#include "PDB_IPIStream.h"
+#include "PDB_ModuleInlineTable.h"
+#include "PDB_ModuleLineTable.h"
+
+
+void ExampleLines(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream)
+{
+	TimedScope total("\nRunning example \"Lines\"");
+
+	// the file names of all lines are stored in the "/names" stream
+	if (!infoStream.HasNamesStream() || (infoStream.HasValidNamesStream(rawPdbFile) != PDB::ErrorCode::Success))
+	{
+		printf("PDB does not contain line information\n");
+		return;
+	}
+
+	TimedScope namesScope("Reading names stream");
+	const PDB::NamesStream namesStream = infoStream.CreateNamesStream(rawPdbFile);
+	namesScope.Done();
+
+
+	// prepare the image section stream first. it is needed for converting section + offset into an RVA
+	TimedScope sectionScope("Reading image section stream");
+	const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawPdbFile);
+	sectionScope.Done();
+
+
+	TimedScope moduleScope("Reading module info stream");
+	const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawPdbFile);
+	moduleScope.Done();
+
+
+	// build one line table per module. a profiler would usually build these lazily, for the modules it actually needs.
+	// the tables can then be used to resolve the RVAs of samples into source lines.
+	std::vector<PDB::ModuleLineTable> lineTables;
+	{
+		TimedScope scope("Building line tables");
+
+		size_t lineCount = 0u;
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasLineStream())
+			{
+				continue;
+			}
+
+			const PDB::ModuleLineStream moduleLineStream = module.CreateLineStream(rawPdbFile);
+			lineTables.emplace_back(rawPdbFile, moduleLineStream, imageSectionStream);
+			lineCount += lineTables.back().GetLineCount();
+		}
+
+		scope.Done(lineCount);
+	}
+
+	// output the first line of the first few modules
+	const size_t count = std::min<size_t>(lineTables.size(), 10u);
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const PDB::ModuleLineTable& lineTable = lineTables[i];
+		if (lineTable.GetLineCount() == 0u)
+		{
+			continue;
+		}
+
+		const uint32_t rva = lineTable.GetRVA(0u);
+		const uint32_t lineIndex = lineTable.Lookup(rva);
+		if (lineIndex != PDB::ModuleLineTable::InvalidLine)
+		{
+			printf("RVA 0x%X: %s(%u)\n", rva, namesStream.GetFilename(lineTable.GetFilenameOffset(lineIndex)), lineTable.GetLineNumber(lineIndex));
+		}
+	}
+
+	// functions inlined by the compiler are described by S_INLINESITE records in the module symbol streams.
+	// their names are stored in the IPI stream, which is optional.
+	if (PDB::HasValidIPIStream(rawPdbFile) != PDB::ErrorCode::Success)
+	{
+		printf("PDB does not contain inline site information\n");
+		total.Done(lineTables.size());
+		return;
+	}
+
+	TimedScope ipiScope("Reading IPI stream");
+	const PDB::IPIStream ipiStream = PDB::CreateIPIStream(rawPdbFile);
+	ipiScope.Done();
+
+	std::vector<PDB::ModuleInlineTable> inlineTables;
+	{
+		TimedScope scope("Building inline tables");
+
+		size_t rangeCount = 0u;
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasLineStream())
+			{
+				continue;
+			}
+
+			const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawPdbFile);
+			const PDB::ModuleLineStream moduleLineStream = module.CreateLineStream(rawPdbFile);
+			inlineTables.emplace_back(rawPdbFile, moduleSymbolStream, moduleLineStream, imageSectionStream, ipiStream);
+			rangeCount += inlineTables.back().GetRangeCount();
+		}
+
+		scope.Done(rangeCount);
+	}
+
+	// output the inline stack of the first inlined range of the first few modules, innermost function first
+	size_t printedCount = 0u;
+	for (size_t i = 0u; (i < inlineTables.size()) && (printedCount < 10u); ++i)
+	{
+		const PDB::ModuleInlineTable& inlineTable = inlineTables[i];
+		if (inlineTable.GetRangeCount() == 0u)
+		{
+			continue;
+		}
+
+		const uint32_t rva = inlineTable.GetRVA(0u);
+		const uint32_t rangeIndex = inlineTable.Lookup(rva);
+		if (rangeIndex == PDB::ModuleInlineTable::InvalidRange)
+		{
+			continue;
+		}
+
+		printf("RVA 0x%X:\n", rva);
+
+		const PDB::ArrayView<PDB::ModuleInlineTable::Frame> stack = inlineTable.GetInlineStack(rangeIndex);
+		for (size_t frame = stack.GetLength(); frame > 0u; --frame)
+		{
+			const PDB::ModuleInlineTable::Frame& inlineFrame = stack[frame - 1u];
+			printf("  inlined %s at %s(%u)\n", inlineFrame.name ? inlineFrame.name : "<unknown>", namesStream.GetFilename(inlineFrame.filenameOffset), inlineFrame.lineNumber);
+		}
+
+		++printedCount;
+	}
+
+	total.Done(lineTables.size());
+}
@@ -75,6 +75,7 @@ namespace
 extern void ExampleSymbols(const PDB::RawFile&, const PDB::DBIStream&);
 extern void ExampleContributions(const PDB::RawFile&, const PDB::DBIStream&);
 extern void ExampleFunctionSymbols(const PDB::RawFile&, const PDB::DBIStream&);
+extern void ExampleLines(const PDB::RawFile&, const PDB::DBIStream&, const PDB::InfoStream&);
 
 
 int main(void)
@@ -133,6 +134,7 @@ int main(void)
 	ExampleContributions(rawPdbFile, dbiStream);
 	ExampleSymbols(rawPdbFile, dbiStream);
 	ExampleFunctionSymbols(rawPdbFile, dbiStream);
+	ExampleLines(rawPdbFile, dbiStream, infoStream);
 
 	MemoryMappedFile::Close(pdbFile);
 
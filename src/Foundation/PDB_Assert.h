@@ -10,10 +10,29 @@
 PDB_PUSH_WARNING_CLANG
 PDB_DISABLE_WARNING_CLANG("-Wgnu-zero-variadic-macro-arguments")
 
-#ifdef _DEBUG
-#	define PDB_ASSERT(_condition, _msg, ...)			(_condition) ? (void)true : (PDB_LOG_ERROR(_msg, ##__VA_ARGS__), __debugbreak())
+#if PDB_COMPILER_MSVC || PDB_PLATFORM_WINDOWS
+#	define PDB_DEBUG_BREAK()							__debugbreak()
 #else
+#	define PDB_DEBUG_BREAK()							__builtin_trap()
+#endif
+
+#ifdef _DEBUG
+#	define PDB_ASSERT(_condition, _msg, ...)			(_condition) ? (void)true : (PDB_LOG_ERROR(_msg, ##__VA_ARGS__), PDB_DEBUG_BREAK())
+#elif PDB_COMPILER_MSVC || PDB_PLATFORM_WINDOWS
 #	define PDB_ASSERT(_condition, _msg, ...)			__noop((void)(_condition), (void)(_msg), ##__VA_ARGS__)
+#else
+	// the arguments are never evaluated, but still count as being used
+#	define PDB_ASSERT(_condition, _msg, ...)			(void)sizeof(PDB::Detail::IgnoreArguments((_condition), (_msg), ##__VA_ARGS__))
+
+namespace PDB
+{
+	namespace Detail
+	{
+		// never defined, only used in unevaluated contexts
+		template <typename... Args>
+		char IgnoreArguments(const Args&...) PDB_NO_EXCEPT;
+	}
+}
 #endif
 
 PDB_POP_WARNING_CLANG
@@ -6,7 +6,9 @@
 #include "PDB_Assert.h"
 #include "PDB_DisableWarningsPush.h"
 #include <type_traits>
-#include <intrin.h>
+#if PDB_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 #include "PDB_DisableWarningsPop.h"
 
 
@@ -46,10 +48,14 @@ namespace PDB
 		{
 			PDB_ASSERT(value != 0u, "Invalid value.");
 
+#if PDB_COMPILER_MSVC
 			unsigned long result = 0u;
 			_BitScanForward(&result, value);
 
 			return result;
+#else
+			return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
 		}
 	}
 }
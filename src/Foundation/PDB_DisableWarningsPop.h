@@ -8,4 +8,6 @@
 #	pragma warning(pop)
 #elif PDB_COMPILER_CLANG
 #	pragma clang diagnostic pop
+#elif PDB_COMPILER_GCC
+#	pragma GCC diagnostic pop
 #endif
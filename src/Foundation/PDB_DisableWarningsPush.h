@@ -9,4 +9,9 @@
 #elif PDB_COMPILER_CLANG
 #	pragma clang diagnostic push
 #	pragma clang diagnostic ignored "-Weverything"
+#elif PDB_COMPILER_GCC
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wall"
+#	pragma GCC diagnostic ignored "-Wextra"
+#	pragma GCC diagnostic ignored "-Wpedantic"
 #endif
@@ -8,13 +8,45 @@
 #if defined(__clang__)
 #	define PDB_COMPILER_MSVC				0
 #	define PDB_COMPILER_CLANG				1
+#	define PDB_COMPILER_GCC					0
 #elif defined(_MSC_VER)
 #	define PDB_COMPILER_MSVC				1
 #	define PDB_COMPILER_CLANG				0
+#	define PDB_COMPILER_GCC					0
+#elif defined(__GNUC__)
+#	define PDB_COMPILER_MSVC				0
+#	define PDB_COMPILER_CLANG				0
+#	define PDB_COMPILER_GCC					1
 #else
 #	error("Unknown compiler.");
 #endif
 
+// determine the operating system we're compiling for
+#if defined(_WIN32)
+#	define PDB_PLATFORM_WINDOWS				1
+#	define PDB_PLATFORM_LINUX				0
+#elif defined(__linux__)
+#	define PDB_PLATFORM_WINDOWS				0
+#	define PDB_PLATFORM_LINUX				1
+#else
+#	define PDB_PLATFORM_WINDOWS				0
+#	define PDB_PLATFORM_LINUX				0
+#endif
+
+// determine whether SSE2 instructions are available
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#	define PDB_SSE2							1
+#else
+#	define PDB_SSE2							0
+#endif
+
+// determine whether functions using AVX2 instructions can be compiled, which are only called if the CPU supports them
+#if defined(_M_X64) || defined(__x86_64__)
+#	define PDB_AVX2							1
+#else
+#	define PDB_AVX2							0
+#endif
+
 // check whether C++17 is available
 #if __cplusplus >= 201703L
 #	define PDB_CPP_17						1
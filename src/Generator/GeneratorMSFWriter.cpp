@@ -0,0 +1,309 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "GeneratorMSFWriter.h"
+#include "GeneratorRandom.h"
+#include "PDB_Types.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+namespace
+{
+	// a list of blocks that is placed in the file as a whole: a stream, the stream directory, or the indices of the directory blocks
+	struct Unit
+	{
+		const uint8_t* data;
+		size_t size;
+		uint32_t firstBlock;		// index of the unit's first block in the list of all blocks of all units
+		uint32_t blockCount;
+	};
+
+
+	static bool IsFreeBlockMapBlock(uint32_t blockIndex, uint32_t blockSize)
+	{
+		// the two free block maps are stored in blocks 1 and 2 of every interval of blockSize blocks
+		// https://llvm.org/docs/PDB/MsfFile.html#the-free-block-map
+		const uint32_t indexInInterval = blockIndex & (blockSize - 1u);
+
+		return (indexInInterval == 1u) || (indexInInterval == 2u);
+	}
+
+
+	static uint32_t GetNextDataBlock(uint32_t blockIndex, uint32_t blockSize)
+	{
+		do
+		{
+			++blockIndex;
+		}
+		while (IsFreeBlockMapBlock(blockIndex, blockSize));
+
+		return blockIndex;
+	}
+
+
+	static std::vector<uint32_t> PlaceBlocks(const std::vector<Unit>& units, uint32_t totalBlockCount, const MSFWriter::Options& options)
+	{
+		// returns the order in which the blocks of all units are stored in the file
+		std::vector<uint32_t> order;
+		order.reserve(totalBlockCount);
+
+		switch (options.layout)
+		{
+			case MSFWriter::Layout::Contiguous:
+			{
+				for (uint32_t i = 0u; i < totalBlockCount; ++i)
+				{
+					order.push_back(i);
+				}
+			}
+			break;
+
+			case MSFWriter::Layout::Interleaved:
+			{
+				uint32_t maxBlockCount = 0u;
+				for (const Unit& unit : units)
+				{
+					maxBlockCount = std::max(maxBlockCount, unit.blockCount);
+				}
+
+				for (uint32_t round = 0u; round < maxBlockCount; ++round)
+				{
+					for (const Unit& unit : units)
+					{
+						if (round < unit.blockCount)
+						{
+							order.push_back(unit.firstBlock + round);
+						}
+					}
+				}
+			}
+			break;
+
+			case MSFWriter::Layout::Random:
+			{
+				struct Run
+				{
+					uint32_t firstBlock;
+					uint32_t blockCount;
+				};
+
+				std::vector<Run> runs;
+				for (const Unit& unit : units)
+				{
+					for (uint32_t i = 0u; i < unit.blockCount; i += options.runLength)
+					{
+						runs.push_back(Run { unit.firstBlock + i, std::min(options.runLength, unit.blockCount - i) });
+					}
+				}
+
+				// Fisher-Yates shuffle
+				Random random(options.seed);
+				for (size_t i = runs.size(); i > 1u; --i)
+				{
+					const uint32_t j = random.NextBelow(static_cast<uint32_t>(i));
+					std::swap(runs[i - 1u], runs[j]);
+				}
+
+				for (const Run& run : runs)
+				{
+					for (uint32_t i = 0u; i < run.blockCount; ++i)
+					{
+						order.push_back(run.firstBlock + i);
+					}
+				}
+			}
+			break;
+		}
+
+		return order;
+	}
+
+
+	static void AppendUnit(std::vector<Unit>& units, uint32_t& totalBlockCount, const uint8_t* data, size_t size, uint32_t blockSize)
+	{
+		const uint32_t blockCount = static_cast<uint32_t>((size + blockSize - 1u) / blockSize);
+		units.push_back(Unit { data, size, totalBlockCount, blockCount });
+		totalBlockCount += blockCount;
+	}
+
+
+	static void AppendBlockIndices(std::vector<uint8_t>& buffer, const Unit& unit, const std::vector<uint32_t>& fileBlockIndices)
+	{
+		const size_t offset = buffer.size();
+		buffer.resize(offset + unit.blockCount * sizeof(uint32_t));
+		memcpy(buffer.data() + offset, fileBlockIndices.data() + unit.firstBlock, unit.blockCount * sizeof(uint32_t));
+	}
+}
+
+
+bool MSFWriter::Write(const char* path, const std::vector<std::vector<uint8_t>>& streams, const Options& options, Statistics& statistics)
+{
+	const uint32_t blockSize = options.blockSize;
+	const uint32_t streamCount = static_cast<uint32_t>(streams.size());
+
+	// stream sizes and the directory size are stored as 32-bit values
+	const uint64_t maxSize = static_cast<uint64_t>(UINT32_MAX) - blockSize;
+
+	std::vector<Unit> units;
+	units.reserve(streamCount + 2u);
+
+	uint32_t totalBlockCount = 0u;
+	uint64_t directorySize = sizeof(uint32_t) + sizeof(uint32_t) * static_cast<uint64_t>(streamCount);
+	for (const std::vector<uint8_t>& stream : streams)
+	{
+		if (stream.size() > maxSize)
+		{
+			return false;
+		}
+
+		AppendUnit(units, totalBlockCount, stream.data(), stream.size(), blockSize);
+		directorySize += sizeof(uint32_t) * static_cast<uint64_t>(units.back().blockCount);
+	}
+
+	if (directorySize > maxSize)
+	{
+		return false;
+	}
+
+	// the directory and the directory indices are built once all blocks have been placed, but their sizes are already known
+	std::vector<uint8_t> directory;
+	std::vector<uint8_t> directoryIndices;
+
+	const size_t directoryUnit = units.size();
+	AppendUnit(units, totalBlockCount, nullptr, static_cast<size_t>(directorySize), blockSize);
+
+	const size_t directoryIndicesUnit = units.size();
+	AppendUnit(units, totalBlockCount, nullptr, units[directoryUnit].blockCount * sizeof(uint32_t), blockSize);
+
+	// the indices of all blocks holding directory indices must fit into the super block
+	const uint32_t maxDirectoryIndicesBlockCount = static_cast<uint32_t>((blockSize - sizeof(PDB::SuperBlock)) / sizeof(uint32_t));
+	if (units[directoryIndicesUnit].blockCount > maxDirectoryIndicesBlockCount)
+	{
+		return false;
+	}
+
+	// assign file blocks to all blocks in the order given by the layout, skipping the super block and free block maps
+	const std::vector<uint32_t> order = PlaceBlocks(units, totalBlockCount, options);
+
+	std::vector<uint32_t> fileBlockIndices(totalBlockCount);
+
+	uint32_t fileBlockIndex = 0u;
+	for (uint32_t block : order)
+	{
+		fileBlockIndex = GetNextDataBlock(fileBlockIndex, blockSize);
+		fileBlockIndices[block] = fileBlockIndex;
+	}
+
+	// the interval holding the last block must also hold its free block maps
+	uint32_t blockCount = fileBlockIndex + 1u;
+	if ((fileBlockIndex & (blockSize - 1u)) == 0u)
+	{
+		blockCount += 2u;
+	}
+
+	// build the directory, followed by the indices of the directory blocks
+	// https://llvm.org/docs/PDB/MsfFile.html#the-stream-directory
+	directory.reserve(static_cast<size_t>(directorySize));
+	directory.resize(sizeof(uint32_t) + sizeof(uint32_t) * streamCount);
+	memcpy(directory.data(), &streamCount, sizeof(uint32_t));
+	for (uint32_t i = 0u; i < streamCount; ++i)
+	{
+		const uint32_t streamSize = static_cast<uint32_t>(streams[i].size());
+		memcpy(directory.data() + sizeof(uint32_t) + sizeof(uint32_t) * i, &streamSize, sizeof(uint32_t));
+	}
+
+	for (uint32_t i = 0u; i < streamCount; ++i)
+	{
+		AppendBlockIndices(directory, units[i], fileBlockIndices);
+	}
+
+	AppendBlockIndices(directoryIndices, units[directoryUnit], fileBlockIndices);
+
+	units[directoryUnit].data = directory.data();
+	units[directoryIndicesUnit].data = directoryIndices.data();
+
+	// remember which unit each block belongs to
+	std::vector<uint32_t> unitOfBlock(totalBlockCount);
+	for (uint32_t i = 0u; i < static_cast<uint32_t>(units.size()); ++i)
+	{
+		for (uint32_t j = 0u; j < units[i].blockCount; ++j)
+		{
+			unitOfBlock[units[i].firstBlock + j] = i;
+		}
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> buffer(blockSize);
+	size_t nextBlock = 0u;
+	bool success = true;
+	for (uint32_t i = 0u; (i < blockCount) && success; ++i)
+	{
+		memset(buffer.data(), 0, blockSize);
+
+		if (i == 0u)
+		{
+			PDB::SuperBlock superBlock = {};
+			memcpy(superBlock.fileMagic, PDB::SuperBlock::MAGIC, sizeof(PDB::SuperBlock::MAGIC));
+			superBlock.blockSize = blockSize;
+			superBlock.freeBlockMapIndex = 1u;
+			superBlock.blockCount = blockCount;
+			superBlock.directorySize = static_cast<uint32_t>(directorySize);
+			memcpy(buffer.data(), &superBlock, sizeof(PDB::SuperBlock));
+
+			const Unit& unit = units[directoryIndicesUnit];
+			memcpy(buffer.data() + sizeof(PDB::SuperBlock), fileBlockIndices.data() + unit.firstBlock, unit.blockCount * sizeof(uint32_t));
+		}
+		else if (IsFreeBlockMapBlock(i, blockSize))
+		{
+			// the free block map is a bit vector spread across the free block map blocks of all intervals, a set bit denotes a free block.
+			// all blocks in the file are in use, only the bits past the end of the file are set.
+			const uint64_t firstBit = static_cast<uint64_t>(i / blockSize) * blockSize * 8u;
+			for (uint32_t bit = 0u; bit < blockSize * 8u; ++bit)
+			{
+				if (firstBit + bit >= blockCount)
+				{
+					buffer[bit / 8u] |= static_cast<uint8_t>(1u << (bit % 8u));
+				}
+			}
+		}
+		else
+		{
+			const uint32_t block = order[nextBlock++];
+			const Unit& unit = units[unitOfBlock[block]];
+			const size_t offset = static_cast<size_t>(block - unit.firstBlock) * blockSize;
+			memcpy(buffer.data(), unit.data + offset, std::min<size_t>(blockSize, unit.size - offset));
+		}
+
+		success = (fwrite(buffer.data(), blockSize, 1u, file) == 1u);
+	}
+
+	success &= (fclose(file) == 0);
+
+	// count the runs of contiguous blocks of each stream
+	uint32_t runCount = 0u;
+	for (uint32_t i = 0u; i < streamCount; ++i)
+	{
+		const Unit& unit = units[i];
+		for (uint32_t j = 0u; j < unit.blockCount; ++j)
+		{
+			if ((j == 0u) || (fileBlockIndices[unit.firstBlock + j] != fileBlockIndices[unit.firstBlock + j - 1u] + 1u))
+			{
+				++runCount;
+			}
+		}
+	}
+
+	statistics.blockCount = blockCount;
+	statistics.streamBlockCount = units[directoryUnit].firstBlock;
+	statistics.runCount = runCount;
+	statistics.fileSize = static_cast<uint64_t>(blockCount) * blockSize;
+
+	return success;
+}
@@ -0,0 +1,40 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace MSFWriter
+{
+	// determines how the blocks of all streams are placed in the file.
+	// the stream directory and the blocks holding the directory's block indices are placed the same way as all other streams.
+	enum class Layout : uint32_t
+	{
+		Contiguous,			// all blocks of a stream are stored next to each other, stream after stream
+		Interleaved,		// the blocks of all streams are stored round-robin, as if all streams had been appended to in lockstep
+		Random				// runs of blocks of all streams are shuffled across the whole file
+	};
+
+	struct Options
+	{
+		uint32_t blockSize;
+		Layout layout;
+		uint32_t runLength;		// number of contiguous blocks per run for Layout::Random
+		uint64_t seed;
+	};
+
+	struct Statistics
+	{
+		uint32_t blockCount;			// number of blocks in the file, including the super block and the free block maps
+		uint32_t streamBlockCount;		// number of blocks holding stream data
+		uint32_t runCount;				// number of runs of contiguous blocks holding stream data
+		uint64_t fileSize;
+	};
+
+	// writes the given streams into an MSF file. stream 0 is the old stream directory, and should be empty.
+	// returns false if the file cannot be written, or if the streams don't fit into an MSF file with the given block size.
+	bool Write(const char* path, const std::vector<std::vector<uint8_t>>& streams, const Options& options, Statistics& statistics);
+}
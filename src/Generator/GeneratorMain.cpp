@@ -0,0 +1,238 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "GeneratorMSFWriter.h"
+#include "GeneratorStreams.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace
+{
+	// function offsets are stored as 32-bit values, which limits the size of the .text section
+	static constexpr const uint64_t MaxFunctionCount = 16u * 1024u * 1024u;
+
+	struct Options
+	{
+		Streams::Configuration streams;
+		MSFWriter::Options msf;
+		const char* outputPath;
+		const char* tracePath;
+	};
+
+
+	static void PrintUsage(void)
+	{
+		fprintf(stderr,
+			"Usage: RawPDBGenerator [options] <output.pdb>\n"
+			"  --block-size <n>     MSF block size, a power of two between 512 and 65536 (default: 4096)\n"
+			"  --modules <n>        number of modules, including the linker module (default: 1000)\n"
+			"  --functions <n>      number of functions (default: 16 per module)\n"
+			"  --publics <n>        number of public symbols (default: functions + functions/4)\n"
+			"  --globals <n>        number of global symbols (default: functions + functions/4)\n"
+			"  --ipi <n>            number of IPI records (default: 5 per module)\n"
+			"  --thunks <n>         number of incremental linking thunks (default: 0)\n"
+			"  --trace <path>       additionally write an address trace to the given file, for replaying with RawPDBBenchmark\n"
+			"  --trace-length <n>   number of RVAs in the address trace (default: 1000000)\n"
+			"  --layout <layout>    contiguous, interleaved or random (default: contiguous)\n"
+			"  --run-length <n>     number of contiguous blocks per run for the random layout (default: 1)\n"
+			"  --seed <n>           seed for function sizes and the random layout (default: 1)\n");
+	}
+
+
+	static bool ParseNumber(const char* string, uint64_t minValue, uint64_t maxValue, uint64_t& value)
+	{
+		char* end = nullptr;
+		const unsigned long long number = strtoull(string, &end, 10);
+		if ((end == string) || (*end != '\0') || (number < minValue) || (number > maxValue))
+		{
+			return false;
+		}
+
+		value = number;
+
+		return true;
+	}
+
+
+	static bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		uint64_t blockSize = 4096u;
+		uint64_t moduleCount = 1000u;
+		uint64_t functionCount = UINT64_MAX;
+		uint64_t publicCount = UINT64_MAX;
+		uint64_t globalCount = UINT64_MAX;
+		uint64_t ipiRecordCount = UINT64_MAX;
+		uint64_t thunkCount = 0u;
+		uint64_t traceLength = 1000000u;
+		uint64_t runLength = 1u;
+		uint64_t seed = 1u;
+
+		options.msf.layout = MSFWriter::Layout::Contiguous;
+		options.outputPath = nullptr;
+		options.tracePath = nullptr;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* argument = argv[i];
+			const bool hasValue = (i + 1 < argc);
+
+			bool isValid = true;
+			if ((strcmp(argument, "--block-size") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 512u, 65536u, blockSize) && ((blockSize & (blockSize - 1u)) == 0u);
+			}
+			else if ((strcmp(argument, "--modules") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 2u, UINT32_MAX, moduleCount);
+			}
+			else if ((strcmp(argument, "--functions") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, MaxFunctionCount, functionCount);
+			}
+			else if ((strcmp(argument, "--publics") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, UINT32_MAX, publicCount);
+			}
+			else if ((strcmp(argument, "--globals") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, UINT32_MAX, globalCount);
+			}
+			else if ((strcmp(argument, "--ipi") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, UINT32_MAX - 0x1000u, ipiRecordCount);
+			}
+			else if ((strcmp(argument, "--thunks") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, MaxFunctionCount, thunkCount);
+			}
+			else if ((strcmp(argument, "--trace") == 0) && hasValue)
+			{
+				options.tracePath = argv[++i];
+			}
+			else if ((strcmp(argument, "--trace-length") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 1u, UINT32_MAX, traceLength);
+			}
+			else if ((strcmp(argument, "--layout") == 0) && hasValue)
+			{
+				const char* layout = argv[++i];
+				if (strcmp(layout, "contiguous") == 0)
+				{
+					options.msf.layout = MSFWriter::Layout::Contiguous;
+				}
+				else if (strcmp(layout, "interleaved") == 0)
+				{
+					options.msf.layout = MSFWriter::Layout::Interleaved;
+				}
+				else if (strcmp(layout, "random") == 0)
+				{
+					options.msf.layout = MSFWriter::Layout::Random;
+				}
+				else
+				{
+					isValid = false;
+				}
+			}
+			else if ((strcmp(argument, "--run-length") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 1u, UINT32_MAX, runLength);
+			}
+			else if ((strcmp(argument, "--seed") == 0) && hasValue)
+			{
+				isValid = ParseNumber(argv[++i], 0u, UINT64_MAX, seed);
+			}
+			else if ((argument[0] == '-') || options.outputPath)
+			{
+				isValid = false;
+			}
+			else
+			{
+				options.outputPath = argument;
+			}
+
+			if (!isValid)
+			{
+				return false;
+			}
+		}
+
+		if (functionCount == UINT64_MAX)
+		{
+			functionCount = moduleCount * 16u;
+		}
+
+		if ((functionCount > MaxFunctionCount) || ((thunkCount != 0u) && (functionCount == 0u)))
+		{
+			return false;
+		}
+
+		options.streams.moduleCount = static_cast<uint32_t>(moduleCount);
+		options.streams.functionCount = static_cast<uint32_t>(functionCount);
+		options.streams.publicCount = static_cast<uint32_t>((publicCount == UINT64_MAX) ? functionCount + functionCount / 4u : publicCount);
+		options.streams.globalCount = static_cast<uint32_t>((globalCount == UINT64_MAX) ? functionCount + functionCount / 4u : globalCount);
+		options.streams.ipiRecordCount = static_cast<uint32_t>((ipiRecordCount == UINT64_MAX) ? moduleCount * 5u : ipiRecordCount);
+		options.streams.thunkCount = static_cast<uint32_t>(thunkCount);
+		options.streams.traceLength = options.tracePath ? static_cast<uint32_t>(traceLength) : 0u;
+		options.streams.seed = seed;
+
+		options.msf.blockSize = static_cast<uint32_t>(blockSize);
+		options.msf.runLength = static_cast<uint32_t>(runLength);
+		options.msf.seed = seed;
+
+		return (options.outputPath != nullptr);
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+
+		return 1;
+	}
+
+	Streams::Statistics streamStatistics;
+	std::vector<uint32_t> trace;
+	const std::vector<std::vector<uint8_t>> streams = Streams::Build(options.streams, streamStatistics, trace);
+
+	MSFWriter::Statistics msfStatistics;
+	if (!MSFWriter::Write(options.outputPath, streams, options.msf, msfStatistics))
+	{
+		fprintf(stderr, "Cannot write %s, the file cannot be created or the streams exceed the limits of the MSF format\n", options.outputPath);
+
+		return 2;
+	}
+
+	if (options.tracePath)
+	{
+		FILE* traceFile = fopen(options.tracePath, "wb");
+		const bool isWritten = traceFile && (fwrite(trace.data(), sizeof(uint32_t), trace.size(), traceFile) == trace.size());
+		if (traceFile)
+		{
+			fclose(traceFile);
+		}
+
+		if (!isWritten)
+		{
+			fprintf(stderr, "Cannot write address trace %s\n", options.tracePath);
+
+			return 2;
+		}
+
+		printf("%s: %zu RVAs\n", options.tracePath, trace.size());
+	}
+
+	printf("%s: %llu bytes, %u blocks of %u bytes, %u streams stored in %u blocks and %u runs\n", options.outputPath,
+		static_cast<unsigned long long>(msfStatistics.fileSize), msfStatistics.blockCount, options.msf.blockSize, static_cast<unsigned int>(streams.size()), msfStatistics.streamBlockCount, msfStatistics.runCount);
+	printf("  %u modules (%u with symbol streams, %u module symbols, %u lines, %u inline sites), %u functions, %u thunks, %u data symbols\n",
+		options.streams.moduleCount, streamStatistics.moduleSymbolStreamCount, streamStatistics.moduleSymbolRecordCount, streamStatistics.lineCount, streamStatistics.inlineSiteCount, options.streams.functionCount, options.streams.thunkCount, streamStatistics.dataCount);
+	printf("  %u public symbols, %u global symbols (%llu bytes of symbol records), %u IPI records\n",
+		options.streams.publicCount, options.streams.globalCount, static_cast<unsigned long long>(streamStatistics.symbolRecordStreamSize), options.streams.ipiRecordCount);
+
+	return 0;
+}
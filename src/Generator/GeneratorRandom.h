@@ -0,0 +1,36 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstdint>
+
+
+// a small, deterministic pseudo-random number generator (SplitMix64).
+// the generator must produce bit-identical files for the same seed on every platform, so we don't use <random>, whose distributions are implementation-defined.
+class Random
+{
+public:
+	explicit Random(uint64_t seed)
+		: m_state(seed)
+	{
+	}
+
+	uint64_t Next(void)
+	{
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+
+		return z ^ (z >> 31u);
+	}
+
+	// returns a number in the range [0, bound)
+	uint32_t NextBelow(uint32_t bound)
+	{
+		return static_cast<uint32_t>(((Next() >> 32u) * bound) >> 32u);
+	}
+
+private:
+	uint64_t m_state;
+};
@@ -0,0 +1,1120 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "GeneratorStreams.h"
+#include "GeneratorRandom.h"
+#include "PDB_Types.h"
+#include "PDB_DBITypes.h"
+#include "PDB_IPITypes.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+
+namespace
+{
+	using Buffer = std::vector<uint8_t>;
+	using SymbolRecordKind = PDB::CodeView::DBI::SymbolRecordKind;
+	using TypeRecordKind = PDB::CodeView::IPI::TypeRecordKind;
+
+	// streams at fixed indices
+	static constexpr const uint16_t InfoStreamIndex = 1u;
+	static constexpr const uint16_t TPIStreamIndex = 2u;
+	static constexpr const uint16_t DBIStreamIndex = 3u;
+	static constexpr const uint16_t IPIStreamIndex = 4u;
+
+	// streams whose indices are stored in the DBI stream
+	static constexpr const uint16_t SectionHeaderStreamIndex = 5u;
+	static constexpr const uint16_t GlobalStreamIndex = 6u;
+	static constexpr const uint16_t PublicStreamIndex = 7u;
+	static constexpr const uint16_t SymbolRecordStreamIndex = 8u;
+	static constexpr const uint16_t FirstModuleSymbolStreamIndex = 9u;
+
+	static constexpr const uint16_t InvalidStreamIndex = 0xFFFFu;
+
+	// one-based section indices of the sections in the image
+	static constexpr const uint16_t TextSection = 1u;
+	static constexpr const uint16_t RDataSection = 2u;
+	static constexpr const uint16_t DataSection = 3u;
+	static constexpr const uint32_t SectionCount = 3u;
+
+	static constexpr const uint32_t SectionAlignment = 0x1000u;
+	static constexpr const uint32_t DataSymbolSize = 8u;
+
+	// incremental linking thunks are 5-byte relative jumps, stored in a table at the end of the .text section
+	static constexpr const uint32_t ThunkSize = 5u;
+	static constexpr const uint32_t ThunkTableAlignment = 16u;
+
+	// number of buckets of the GSI hash tables, IPHR_HASH in gsi.h
+	static constexpr const uint32_t HashBucketCount = 4096u;
+
+	// offsets to the first hash record of each bucket are stored as if hash records were 12 bytes in size.
+	// this is the size of the in-memory HR structure in 32-bit builds of mspdb.
+	static constexpr const uint32_t HashRecordOffsetSize = 12u;
+
+	static constexpr const uint32_t FirstTypeIndex = 0x1000u;
+	static constexpr const uint32_t ModuleSymbolStreamSignature = 4u;		// CV_SIGNATURE_C13
+
+
+	struct Function
+	{
+		uint32_t offset;				// offset into the .text section
+		uint32_t size;
+		uint32_t module;
+		uint32_t indexInModule;
+		uint32_t recordOffset;			// offset of the S_GPROC32 record in the module symbol stream, UINT32_MAX if the module has no symbol stream
+	};
+
+	struct Module
+	{
+		uint32_t firstFunction;
+		uint32_t functionCount;
+		uint16_t streamIndex;
+		uint32_t symbolSize;			// size of the symbols in the module symbol stream, including the signature
+		uint32_t c13Size;				// size of the C13 line information following the symbols
+	};
+
+	struct HashEntry
+	{
+		uint32_t bucket;
+		uint32_t recordOffset;
+	};
+
+	struct PublicAddress
+	{
+		uint16_t section;
+		uint32_t offset;
+		uint32_t recordOffset;
+	};
+
+
+	template <typename T>
+	static void Append(Buffer& buffer, const T& value)
+	{
+		const size_t offset = buffer.size();
+		buffer.resize(offset + sizeof(T));
+		memcpy(buffer.data() + offset, &value, sizeof(T));
+	}
+
+
+	template <typename T>
+	static void Patch(Buffer& buffer, size_t offset, const T& value)
+	{
+		memcpy(buffer.data() + offset, &value, sizeof(T));
+	}
+
+
+	static void AppendString(Buffer& buffer, const char* string)
+	{
+		buffer.insert(buffer.end(), string, string + strlen(string) + 1u);
+	}
+
+
+	static void AppendCompressed(Buffer& buffer, uint32_t value)
+	{
+		// binary annotations store unsigned integers in 1, 2 or 4 bytes, big-endian
+		if (value < 0x80u)
+		{
+			Append<uint8_t>(buffer, static_cast<uint8_t>(value));
+		}
+		else if (value < 0x4000u)
+		{
+			Append<uint8_t>(buffer, static_cast<uint8_t>(0x80u | (value >> 8u)));
+			Append<uint8_t>(buffer, static_cast<uint8_t>(value));
+		}
+		else
+		{
+			Append<uint8_t>(buffer, static_cast<uint8_t>(0xC0u | (value >> 24u)));
+			Append<uint8_t>(buffer, static_cast<uint8_t>(value >> 16u));
+			Append<uint8_t>(buffer, static_cast<uint8_t>(value >> 8u));
+			Append<uint8_t>(buffer, static_cast<uint8_t>(value));
+		}
+	}
+
+
+	static void AlignTo4(Buffer& buffer)
+	{
+		buffer.resize((buffer.size() + 3u) & ~static_cast<size_t>(3u));
+	}
+
+
+	template <typename Kind>
+	static size_t BeginRecord(Buffer& buffer, Kind kind)
+	{
+		// the size is patched once the record is complete
+		const size_t offset = buffer.size();
+		Append<uint16_t>(buffer, 0u);
+		Append<Kind>(buffer, kind);
+
+		return offset;
+	}
+
+
+	static void EndSymbolRecord(Buffer& buffer, size_t recordOffset)
+	{
+		// symbol records are padded with zeroes to a multiple of 4 bytes.
+		// the stored size includes the size of the 'kind' field and the padding, but not the size of the 'size' field itself.
+		AlignTo4(buffer);
+		Patch<uint16_t>(buffer, recordOffset, static_cast<uint16_t>(buffer.size() - recordOffset - sizeof(uint16_t)));
+	}
+
+
+	static void EndTypeRecord(Buffer& buffer, size_t recordOffset)
+	{
+		// type records are padded with LF_PAD0 + n bytes, with n being the number of bytes left until the next record
+		while ((buffer.size() & 3u) != 0u)
+		{
+			buffer.push_back(static_cast<uint8_t>(0xF0u + (4u - (buffer.size() & 3u))));
+		}
+
+		Patch<uint16_t>(buffer, recordOffset, static_cast<uint16_t>(buffer.size() - recordOffset - sizeof(uint16_t)));
+	}
+
+
+	static uint32_t HashString(const char* string)
+	{
+		// LHashPbCb, the hash function used by the GSI hash tables
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/misc.h#L15
+		const size_t length = strlen(string);
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(string);
+
+		uint32_t hash = 0u;
+		for (size_t i = 0u; i < length / 4u; ++i)
+		{
+			uint32_t value;
+			memcpy(&value, bytes + i * 4u, sizeof(uint32_t));
+			hash ^= value;
+		}
+
+		const uint8_t* remainder = bytes + (length & ~static_cast<size_t>(3u));
+		if (length & 2u)
+		{
+			uint16_t value;
+			memcpy(&value, remainder, sizeof(uint16_t));
+			hash ^= value;
+			remainder += 2u;
+		}
+
+		if (length & 1u)
+		{
+			hash ^= *remainder;
+		}
+
+		hash |= 0x20202020u;
+		hash ^= (hash >> 11u);
+		hash ^= (hash >> 16u);
+
+		return hash % HashBucketCount;
+	}
+
+
+	static void AppendHashTable(Buffer& buffer, std::vector<HashEntry>& entries)
+	{
+		// the hash table consists of a header, the hash records sorted by bucket, a bitmap of non-empty buckets, and the offsets of non-empty buckets.
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/dbi/gsi.cpp
+		std::stable_sort(entries.begin(), entries.end(), [](const HashEntry& lhs, const HashEntry& rhs)
+		{
+			return lhs.bucket < rhs.bucket;
+		});
+
+		std::vector<uint32_t> bitmap((HashBucketCount + 32u) / 32u, 0u);
+		std::vector<uint32_t> bucketOffsets;
+		for (size_t i = 0u; i < entries.size(); ++i)
+		{
+			const uint32_t bucket = entries[i].bucket;
+			if ((i == 0u) || (bucket != entries[i - 1u].bucket))
+			{
+				bitmap[bucket / 32u] |= 1u << (bucket % 32u);
+				bucketOffsets.push_back(static_cast<uint32_t>(i) * HashRecordOffsetSize);
+			}
+		}
+
+		PDB::HashTableHeader header = {};
+		header.signature = PDB::HashTableHeader::Signature;
+		header.version = PDB::HashTableHeader::Version;
+		header.size = static_cast<uint32_t>(entries.size() * sizeof(PDB::HashRecord));
+		header.bucketCount = static_cast<uint32_t>((bitmap.size() + bucketOffsets.size()) * sizeof(uint32_t));
+		Append(buffer, header);
+
+		for (const HashEntry& entry : entries)
+		{
+			// hash record offsets start at 1, not at 0
+			Append(buffer, PDB::HashRecord { entry.recordOffset + 1u, 1u });
+		}
+
+		for (uint32_t word : bitmap)
+		{
+			Append(buffer, word);
+		}
+
+		for (uint32_t offset : bucketOffsets)
+		{
+			Append(buffer, offset);
+		}
+	}
+
+
+	static void AppendCompileRecord(Buffer& buffer, PDB::CodeView::DBI::CompileSymbolFlags flags)
+	{
+		const size_t record = BeginRecord(buffer, SymbolRecordKind::S_COMPILE3);
+		Append(buffer, flags);
+		Append(buffer, PDB::CodeView::DBI::CPUType::X64);
+
+		// frontend and backend versions
+		static const uint16_t Versions[8u] = { 19u, 29u, 30133u, 0u, 19u, 29u, 30133u, 0u };
+		for (uint16_t version : Versions)
+		{
+			Append(buffer, version);
+		}
+
+		AppendString(buffer, "RawPDB Generator");
+		EndSymbolRecord(buffer, record);
+	}
+
+
+	// every odd function of a compiland has another function inlined into it, and every eighth function has two nested inlinees.
+	// inlinees refer to the LF_FUNC_ID records of the IPI stream, which are every fifth record.
+	static bool HasInlineSite(uint32_t indexInModule, uint32_t functionIdCount)
+	{
+		return (functionIdCount != 0u) && ((indexInModule % 2u) == 1u);
+	}
+
+
+	static bool HasNestedInlineSite(uint32_t indexInModule, uint32_t functionIdCount)
+	{
+		return (functionIdCount != 0u) && ((indexInModule % 8u) == 7u);
+	}
+
+
+	static uint32_t GetFunctionId(uint32_t function, uint32_t functionIdCount)
+	{
+		return FirstTypeIndex + (function % functionIdCount) * 5u + 4u;
+	}
+
+
+	static uint32_t GetInlineeLineNumber(uint32_t functionId)
+	{
+		return 1000u + (functionId - FirstTypeIndex) / 5u;
+	}
+
+
+	static uint32_t AppendInlineSite(Buffer& buffer, uint32_t parent, uint32_t inlinee, uint32_t codeOffset, uint32_t codeLength, uint32_t lineDeltaOffset)
+	{
+		using namespace PDB::CodeView::DBI;
+
+		const size_t site = BeginRecord(buffer, SymbolRecordKind::S_INLINESITE);
+		Append<uint32_t>(buffer, parent);
+		Append<uint32_t>(buffer, 0u);						// end, patched by the caller
+		Append<uint32_t>(buffer, inlinee);
+
+		// the first lineDeltaOffset bytes are attributed to the inlinee's first line, the rest to the line after it
+		AppendCompressed(buffer, static_cast<uint32_t>(BinaryAnnotationOpcode::ChangeCodeOffset));
+		AppendCompressed(buffer, codeOffset);
+		if ((lineDeltaOffset != 0u) && (lineDeltaOffset < codeLength))
+		{
+			AppendCompressed(buffer, static_cast<uint32_t>(BinaryAnnotationOpcode::ChangeCodeOffsetAndLineOffset));
+			AppendCompressed(buffer, lineDeltaOffset | (2u << 4u));		// line delta +1, with the sign stored in the lowest bit
+			codeLength -= lineDeltaOffset;
+		}
+
+		AppendCompressed(buffer, static_cast<uint32_t>(BinaryAnnotationOpcode::ChangeCodeLength));
+		AppendCompressed(buffer, codeLength);
+		EndSymbolRecord(buffer, site);
+
+		return static_cast<uint32_t>(site);
+	}
+
+
+	static void EndInlineSite(Buffer& buffer, uint32_t site)
+	{
+		Patch<uint32_t>(buffer, site + 2u * sizeof(uint16_t) + sizeof(uint32_t), static_cast<uint32_t>(buffer.size()));
+		EndSymbolRecord(buffer, BeginRecord(buffer, SymbolRecordKind::S_INLINESITE_END));
+	}
+
+
+	static Buffer BuildModuleSymbolStream(uint32_t moduleIndex, bool isLinkerModule, const Module& module, std::vector<Function>& functions, uint32_t thunkTableOffset, uint32_t thunkCount, uint32_t functionIdCount, uint32_t& recordCount, uint32_t& inlineSiteCount)
+	{
+		// https://llvm.org/docs/PDB/ModiStream.html
+		Buffer buffer;
+		Append(buffer, ModuleSymbolStreamSignature);
+
+		char name[128];
+		if (isLinkerModule)
+		{
+			snprintf(name, sizeof(name), "* Linker *");
+		}
+		else
+		{
+			snprintf(name, sizeof(name), "C:\\build\\obj\\module%u.obj", moduleIndex);
+		}
+
+		{
+			const size_t record = BeginRecord(buffer, SymbolRecordKind::S_OBJNAME);
+			Append<uint32_t>(buffer, 0u);
+			AppendString(buffer, name);
+			EndSymbolRecord(buffer, record);
+		}
+
+		// the source language is stored in the lowest 8 bits, CV_CFL_CXX for compilands and CV_CFL_LINK for the linker
+		AppendCompileRecord(buffer, static_cast<PDB::CodeView::DBI::CompileSymbolFlags>(isLinkerModule ? 0x07u : 0x01u));
+		recordCount += 2u;
+
+		// the linker module describes each incremental linking thunk using a S_TRAMPOLINE record
+		if (isLinkerModule)
+		{
+			for (uint32_t i = 0u; i < thunkCount; ++i)
+			{
+				const size_t record = BeginRecord(buffer, SymbolRecordKind::S_TRAMPOLINE);
+				Append(buffer, PDB::CodeView::DBI::TrampolineType::Incremental);
+				Append<uint16_t>(buffer, static_cast<uint16_t>(ThunkSize));
+				Append<uint32_t>(buffer, thunkTableOffset + i * ThunkSize);
+				Append<uint32_t>(buffer, functions[i % functions.size()].offset);
+				Append<uint16_t>(buffer, TextSection);
+				Append<uint16_t>(buffer, TextSection);
+				EndSymbolRecord(buffer, record);
+			}
+
+			recordCount += thunkCount;
+		}
+
+		for (uint32_t i = 0u; i < module.functionCount; ++i)
+		{
+			Function& function = functions[module.firstFunction + i];
+			snprintf(name, sizeof(name), "Module%u::Function%u", moduleIndex, i);
+
+			const size_t procedure = BeginRecord(buffer, SymbolRecordKind::S_GPROC32);
+			const size_t procedureEnd = buffer.size() + sizeof(uint32_t);
+			Append<uint32_t>(buffer, 0u);						// parent
+			Append<uint32_t>(buffer, 0u);						// end, patched below
+			Append<uint32_t>(buffer, 0u);						// next
+			Append<uint32_t>(buffer, function.size);			// code size
+			Append<uint32_t>(buffer, 0u);						// debug start
+			Append<uint32_t>(buffer, function.size);			// debug end
+			Append<uint32_t>(buffer, 0u);						// type index
+			Append<uint32_t>(buffer, function.offset);
+			Append<uint16_t>(buffer, TextSection);
+			Append(buffer, PDB::CodeView::DBI::ProcedureFlags::None);
+			AppendString(buffer, name);
+			EndSymbolRecord(buffer, procedure);
+
+			// every fourth function has a nested block scope
+			if ((i % 4u) == 3u)
+			{
+				const size_t block = BeginRecord(buffer, SymbolRecordKind::S_BLOCK32);
+				const size_t blockEnd = buffer.size() + sizeof(uint32_t);
+				Append<uint32_t>(buffer, static_cast<uint32_t>(procedure));	// parent
+				Append<uint32_t>(buffer, 0u);								// end, patched below
+				Append<uint32_t>(buffer, function.size / 2u);				// code size
+				Append<uint32_t>(buffer, function.offset);
+				Append<uint16_t>(buffer, TextSection);
+				AppendString(buffer, "");
+				EndSymbolRecord(buffer, block);
+
+				Patch<uint32_t>(buffer, blockEnd, static_cast<uint32_t>(buffer.size()));
+				EndSymbolRecord(buffer, BeginRecord(buffer, SymbolRecordKind::S_END));
+				recordCount += 2u;
+			}
+
+			// the inlined code occupies the second quarter of the function, a nested inlinee the third eighth
+			if (HasInlineSite(i, functionIdCount))
+			{
+				const uint32_t quarter = function.size / 4u;
+				const uint32_t site = AppendInlineSite(buffer, static_cast<uint32_t>(procedure), GetFunctionId(module.firstFunction + i + 1u, functionIdCount), quarter, quarter, std::min(quarter / 2u, 15u));
+				if (HasNestedInlineSite(i, functionIdCount))
+				{
+					const uint32_t nestedSite = AppendInlineSite(buffer, site, GetFunctionId(module.firstFunction + i + 2u, functionIdCount), quarter + quarter / 2u, quarter / 4u, 0u);
+					EndInlineSite(buffer, nestedSite);
+					recordCount += 2u;
+					++inlineSiteCount;
+				}
+
+				EndInlineSite(buffer, site);
+				recordCount += 2u;
+				++inlineSiteCount;
+			}
+
+			Patch<uint32_t>(buffer, procedureEnd, static_cast<uint32_t>(buffer.size()));
+			EndSymbolRecord(buffer, BeginRecord(buffer, SymbolRecordKind::S_END));
+			recordCount += 2u;
+
+			function.recordOffset = static_cast<uint32_t>(procedure);
+		}
+
+		return buffer;
+	}
+
+
+	static Buffer BuildModuleLineInfo(const Module& module, const std::vector<Function>& functions, uint32_t filenameOffset, uint32_t functionIdCount, uint32_t& lineCount)
+	{
+		// https://llvm.org/docs/PDB/ModiStream.html#the-c13-line-information-substream
+		using namespace PDB::CodeView::DBI;
+		Buffer buffer;
+
+		// all functions of a compiland stem from its only source file, stored at offset 0 of the file checksums
+		Append(buffer, DebugSubsectionHeader { DebugSubsectionKind::S_FILECHECKSUMS, 8u });
+		Append<uint32_t>(buffer, filenameOffset);
+		Append<uint8_t>(buffer, 0u);							// checksum size
+		Append(buffer, ChecksumKind::None);
+		AlignTo4(buffer);
+
+		// one subsection per function, with one line every 16 bytes
+		for (uint32_t i = 0u; i < module.functionCount; ++i)
+		{
+			const Function& function = functions[module.firstFunction + i];
+			const uint32_t functionLineCount = function.size / 16u;
+
+			const uint32_t blockSize = static_cast<uint32_t>(sizeof(LinesFileBlockHeader) + functionLineCount * sizeof(Line));
+			Append(buffer, DebugSubsectionHeader { DebugSubsectionKind::S_LINES, static_cast<uint32_t>(sizeof(LinesHeader)) + blockSize });
+			Append(buffer, LinesHeader { function.offset, TextSection, LinesFlags::None, function.size });
+			Append(buffer, LinesFileBlockHeader { 0u, functionLineCount, blockSize });
+
+			for (uint32_t j = 0u; j < functionLineCount; ++j)
+			{
+				Line line = {};
+				line.offset = j * 16u;
+				line.linenumStart = 1u + i * 20u + j;
+				line.isStatement = 1u;
+				Append(buffer, line);
+			}
+
+			lineCount += functionLineCount;
+		}
+
+		// the source lines of all functions inlined into the compiland, which stem from the same file
+		std::vector<uint32_t> inlinees;
+		for (uint32_t i = 0u; i < module.functionCount; ++i)
+		{
+			if (HasInlineSite(i, functionIdCount))
+			{
+				inlinees.push_back(GetFunctionId(module.firstFunction + i + 1u, functionIdCount));
+			}
+
+			if (HasNestedInlineSite(i, functionIdCount))
+			{
+				inlinees.push_back(GetFunctionId(module.firstFunction + i + 2u, functionIdCount));
+			}
+		}
+
+		std::sort(inlinees.begin(), inlinees.end());
+		inlinees.erase(std::unique(inlinees.begin(), inlinees.end()), inlinees.end());
+		if (!inlinees.empty())
+		{
+			const uint32_t size = static_cast<uint32_t>(sizeof(InlineeSourceLineSignature) + inlinees.size() * sizeof(InlineeSourceLine));
+			Append(buffer, DebugSubsectionHeader { DebugSubsectionKind::S_INLINEELINES, size });
+			Append(buffer, InlineeSourceLineSignature::Normal);
+			for (const uint32_t inlinee : inlinees)
+			{
+				Append(buffer, InlineeSourceLine { inlinee, 0u, GetInlineeLineNumber(inlinee) });
+			}
+		}
+
+		return buffer;
+	}
+
+
+	static Buffer BuildNamesStream(const std::vector<std::pair<uint32_t, uint32_t>>& names, const Buffer& stringTable)
+	{
+		// https://llvm.org/docs/PDB/StringTable.html
+		Buffer buffer;
+		Append(buffer, PDB::NamesHeader { PDB::NamesHeader::Signature, 1u, static_cast<uint32_t>(stringTable.size()) });
+		buffer.insert(buffer.end(), stringTable.begin(), stringTable.end());
+
+		// the hash table maps the hash of each string to its offset, using linear probing
+		const uint32_t bucketCount = static_cast<uint32_t>(names.size()) * 2u + 1u;
+		std::vector<uint32_t> buckets(bucketCount, 0u);
+		for (const std::pair<uint32_t, uint32_t>& name : names)
+		{
+			uint32_t bucket = name.first % bucketCount;
+			while (buckets[bucket] != 0u)
+			{
+				bucket = (bucket + 1u) % bucketCount;
+			}
+
+			buckets[bucket] = name.second;
+		}
+
+		Append<uint32_t>(buffer, bucketCount);
+		for (const uint32_t bucket : buckets)
+		{
+			Append<uint32_t>(buffer, bucket);
+		}
+
+		Append<uint32_t>(buffer, static_cast<uint32_t>(names.size()));
+
+		return buffer;
+	}
+
+
+	static Buffer BuildInfoStream(Random& random, uint32_t namesStreamIndex)
+	{
+		// https://llvm.org/docs/PDB/PdbStream.html
+		Buffer buffer;
+
+		PDB::Header header = {};
+		header.version = PDB::Header::Version::VC70;
+		header.signature = static_cast<uint32_t>(random.Next());
+		header.age = 1u;
+		const uint64_t guid[2u] = { random.Next(), random.Next() };
+		memcpy(&header.guid, guid, sizeof(PDB::GUID));
+		Append(buffer, header);
+
+		// the named stream map only knows the "/names" stream, which occupies the only bucket of the hash table
+		Buffer stringTable;
+		AppendString(stringTable, "/names");
+		Append<uint32_t>(buffer, static_cast<uint32_t>(stringTable.size()));
+		buffer.insert(buffer.end(), stringTable.begin(), stringTable.end());
+		Append(buffer, PDB::SerializedHashTable::Header { 1u, 1u });
+		Append<uint32_t>(buffer, 1u);			// present bit vector
+		Append<uint32_t>(buffer, 1u);
+		Append<uint32_t>(buffer, 0u);			// deleted bit vector
+		Append(buffer, PDB::NamedStreamMap::HashTableEntry { 0u, namesStreamIndex });
+
+		Append(buffer, PDB::FeatureCode::VC140);
+
+		return buffer;
+	}
+
+
+	static Buffer BuildTypeStreamHeader(uint32_t recordCount, uint32_t recordBytes)
+	{
+		// https://llvm.org/docs/PDB/TpiStream.html#tpi-header
+		PDB::IPI::StreamHeader header = {};
+		header.version = PDB::IPI::StreamHeader::Version::V80;
+		header.headerSize = sizeof(PDB::IPI::StreamHeader);
+		header.typeIndexBegin = FirstTypeIndex;
+		header.typeIndexEnd = FirstTypeIndex + recordCount;
+		header.typeRecordBytes = recordBytes;
+		header.hashStreamIndex = InvalidStreamIndex;
+		header.hashAuxStreamIndex = InvalidStreamIndex;
+		header.hashKeySize = sizeof(uint32_t);
+		header.hashBucketCount = 0x3FFFFu;
+
+		Buffer buffer;
+		Append(buffer, header);
+
+		return buffer;
+	}
+
+
+	static Buffer BuildIPIStream(uint32_t recordCount)
+	{
+		// records cycle through the kinds of records usually found in an IPI stream, each cycle referring to records in the same cycle
+		Buffer records;
+		char name[128];
+		for (uint32_t i = 0u; i < recordCount; ++i)
+		{
+			const uint32_t previousTypeIndex = FirstTypeIndex + i - 1u;
+			switch (i % 5u)
+			{
+				case 0u:
+				{
+					snprintf(name, sizeof(name), "C:\\src\\module%u", i / 5u);
+					const size_t record = BeginRecord(records, TypeRecordKind::LF_STRING_ID);
+					Append<uint32_t>(records, 0u);
+					AppendString(records, name);
+					EndTypeRecord(records, record);
+				}
+				break;
+
+				case 1u:
+				{
+					const size_t record = BeginRecord(records, TypeRecordKind::LF_SUBSTR_LIST);
+					Append<uint32_t>(records, 1u);
+					Append<uint32_t>(records, previousTypeIndex);
+					EndTypeRecord(records, record);
+				}
+				break;
+
+				case 2u:
+				{
+					const size_t record = BeginRecord(records, TypeRecordKind::LF_STRING_ID);
+					Append<uint32_t>(records, previousTypeIndex);
+					AppendString(records, " -c -Zi -O2 -DNDEBUG -MD -GS -std:c++17");
+					EndTypeRecord(records, record);
+				}
+				break;
+
+				case 3u:
+				{
+					// current directory, build tool, source file, PDB and command-line
+					const uint32_t directory = FirstTypeIndex + i - 3u;
+					const size_t record = BeginRecord(records, TypeRecordKind::LF_BUILDINFO);
+					Append<uint16_t>(records, 5u);
+					Append<uint32_t>(records, directory);
+					Append<uint32_t>(records, 0u);
+					Append<uint32_t>(records, directory);
+					Append<uint32_t>(records, 0u);
+					Append<uint32_t>(records, previousTypeIndex);
+					EndTypeRecord(records, record);
+				}
+				break;
+
+				case 4u:
+				{
+					// parent scope, function type and name
+					snprintf(name, sizeof(name), "Function%u", i / 5u);
+					const size_t record = BeginRecord(records, TypeRecordKind::LF_FUNC_ID);
+					Append<uint32_t>(records, 0u);
+					Append<uint32_t>(records, 0u);
+					AppendString(records, name);
+					EndTypeRecord(records, record);
+				}
+				break;
+			}
+		}
+
+		Buffer buffer = BuildTypeStreamHeader(recordCount, static_cast<uint32_t>(records.size()));
+		buffer.insert(buffer.end(), records.begin(), records.end());
+
+		return buffer;
+	}
+
+
+	static Buffer BuildSectionHeaderStream(const uint32_t (&sectionSizes)[SectionCount], uint32_t (&virtualAddresses)[SectionCount])
+	{
+		static const char* const Names[SectionCount] = { ".text", ".rdata", ".data" };
+		static const uint32_t Characteristics[SectionCount] = { 0x60000020u, 0x40000040u, 0xC0000040u };
+
+		Buffer buffer;
+		uint32_t virtualAddress = SectionAlignment;
+		uint32_t pointerToRawData = 0x400u;
+		for (uint32_t i = 0u; i < SectionCount; ++i)
+		{
+			PDB::IMAGE_SECTION_HEADER header = {};
+			memcpy(header.Name, Names[i], strlen(Names[i]));
+			header.Misc.VirtualSize = sectionSizes[i];
+			header.VirtualAddress = virtualAddress;
+			virtualAddresses[i] = virtualAddress;
+			header.SizeOfRawData = (sectionSizes[i] + 0x1FFu) & ~0x1FFu;
+			header.PointerToRawData = pointerToRawData;
+			header.Characteristics = Characteristics[i];
+			Append(buffer, header);
+
+			virtualAddress += (sectionSizes[i] + SectionAlignment - 1u) & ~(SectionAlignment - 1u);
+			pointerToRawData += header.SizeOfRawData;
+		}
+
+		return buffer;
+	}
+}
+
+
+std::vector<std::vector<uint8_t>> Streams::Build(const Configuration& configuration, Statistics& statistics, std::vector<uint32_t>& trace)
+{
+	Random random(configuration.seed);
+
+	// the linker module is stored last, all other modules are compilands
+	const uint32_t moduleCount = configuration.moduleCount;
+	const uint32_t linkerModule = moduleCount - 1u;
+	const uint32_t compilandCount = moduleCount - 1u;
+
+	// distribute functions evenly across compilands, with random sizes between 16 and 256 bytes
+	std::vector<Module> modules(moduleCount);
+	std::vector<Function> functions;
+	functions.reserve(configuration.functionCount);
+
+	uint32_t textSize = 0u;
+	for (uint32_t i = 0u; i < moduleCount; ++i)
+	{
+		const uint32_t firstFunction = (i == linkerModule) ? configuration.functionCount : static_cast<uint32_t>(static_cast<uint64_t>(configuration.functionCount) * i / compilandCount);
+		const uint32_t endFunction = (i == linkerModule) ? configuration.functionCount : static_cast<uint32_t>(static_cast<uint64_t>(configuration.functionCount) * (i + 1u) / compilandCount);
+
+		// the linker module always gets a symbol stream, compilands only as long as there are stream indices left
+		const uint32_t streamIndex = (i == linkerModule) ? FirstModuleSymbolStreamIndex : FirstModuleSymbolStreamIndex + 1u + i;
+		modules[i] = Module { firstFunction, endFunction - firstFunction, (streamIndex < InvalidStreamIndex) ? static_cast<uint16_t>(streamIndex) : InvalidStreamIndex, 0u, 0u };
+
+		for (uint32_t j = firstFunction; j < endFunction; ++j)
+		{
+			const uint32_t size = 16u * (1u + random.NextBelow(16u));
+			functions.push_back(Function { textSize, size, i, j - firstFunction, UINT32_MAX });
+			textSize += size;
+		}
+	}
+
+	// the thunk table follows all functions, each thunk jumps to one of the functions
+	const uint32_t thunkCount = functions.empty() ? 0u : configuration.thunkCount;
+	const uint32_t thunkTableOffset = (textSize + ThunkTableAlignment - 1u) & ~(ThunkTableAlignment - 1u);
+	if (thunkCount != 0u)
+	{
+		textSize = thunkTableOffset + thunkCount * ThunkSize;
+	}
+
+	// module symbol streams, ordered by stream index
+	statistics.moduleSymbolStreamCount = 0u;
+	statistics.moduleSymbolRecordCount = 0u;
+	statistics.inlineSiteCount = 0u;
+
+	const uint32_t functionIdCount = configuration.ipiRecordCount / 5u;
+
+	std::vector<Buffer> streams(FirstModuleSymbolStreamIndex);
+	streams.push_back(BuildModuleSymbolStream(linkerModule, true, modules[linkerModule], functions, thunkTableOffset, thunkCount, 0u, statistics.moduleSymbolRecordCount, statistics.inlineSiteCount));
+	for (uint32_t i = 0u; i < compilandCount; ++i)
+	{
+		if (modules[i].streamIndex != InvalidStreamIndex)
+		{
+			streams.push_back(BuildModuleSymbolStream(i, false, modules[i], functions, 0u, 0u, functionIdCount, statistics.moduleSymbolRecordCount, statistics.inlineSiteCount));
+		}
+	}
+
+	statistics.moduleSymbolStreamCount = static_cast<uint32_t>(streams.size()) - FirstModuleSymbolStreamIndex;
+
+	// the symbols of compilands are followed by C13 line information, referring to the file names stored in the "/names" stream.
+	// hashes of the file names are irrelevant for reading, so the generator simply uses the offsets.
+	statistics.lineCount = 0u;
+
+	Buffer namesStringTable;
+	std::vector<std::pair<uint32_t, uint32_t>> names;
+	AppendString(namesStringTable, "");
+
+	char filename[128];
+	for (uint32_t i = 0u; i < moduleCount; ++i)
+	{
+		Module& module = modules[i];
+		if (module.streamIndex == InvalidStreamIndex)
+		{
+			continue;
+		}
+
+		Buffer& stream = streams[module.streamIndex];
+		module.symbolSize = static_cast<uint32_t>(stream.size());
+		if (i == linkerModule)
+		{
+			continue;
+		}
+
+		const uint32_t filenameOffset = static_cast<uint32_t>(namesStringTable.size());
+		snprintf(filename, sizeof(filename), "C:\\src\\module%u.cpp", i);
+		AppendString(namesStringTable, filename);
+		names.emplace_back(filenameOffset, filenameOffset);
+
+		const Buffer lineInfo = BuildModuleLineInfo(module, functions, filenameOffset, functionIdCount, statistics.lineCount);
+		stream.insert(stream.end(), lineInfo.begin(), lineInfo.end());
+		module.c13Size = static_cast<uint32_t>(lineInfo.size());
+	}
+
+	// module symbol streams end with the (empty) global references
+	for (size_t i = FirstModuleSymbolStreamIndex; i < streams.size(); ++i)
+	{
+		Append<uint32_t>(streams[i], 0u);
+	}
+
+	// the "/names" stream follows the module symbol streams
+	const uint32_t namesStreamIndex = static_cast<uint32_t>(streams.size());
+	streams.push_back(BuildNamesStream(names, namesStringTable));
+
+	// S_PUB32 records refer to functions first, and data second.
+	// the global symbol stream refers to functions that have a symbol stream first, and data second.
+	const uint32_t functionCount = configuration.functionCount;
+	const uint32_t publicFunctionCount = std::min(configuration.publicCount, functionCount);
+
+	uint32_t referencedFunctionCount = 0u;
+	for (const Function& function : functions)
+	{
+		referencedFunctionCount += (function.recordOffset != UINT32_MAX) ? 1u : 0u;
+	}
+
+	const uint32_t globalFunctionCount = std::min(configuration.globalCount, referencedFunctionCount);
+	const uint32_t dataCount = std::max(configuration.publicCount - publicFunctionCount, configuration.globalCount - globalFunctionCount);
+	statistics.dataCount = dataCount;
+
+	// the symbol record stream holds the global symbols, followed by the public symbols
+	Buffer symbolRecords;
+	std::vector<HashEntry> globalEntries;
+	std::vector<HashEntry> publicEntries;
+	std::vector<PublicAddress> publicAddresses;
+	globalEntries.reserve(configuration.globalCount);
+	publicEntries.reserve(configuration.publicCount);
+	publicAddresses.reserve(configuration.publicCount);
+
+	char name[128];
+	uint32_t globalFunction = 0u;
+	for (uint32_t i = 0u; (i < functionCount) && (globalFunction < globalFunctionCount); ++i)
+	{
+		const Function& function = functions[i];
+		if (function.recordOffset == UINT32_MAX)
+		{
+			continue;
+		}
+
+		snprintf(name, sizeof(name), "Module%u::Function%u", function.module, function.indexInModule);
+		const uint32_t recordOffset = static_cast<uint32_t>(symbolRecords.size());
+
+		// S_PROCREF: checksum of the name, offset of the procedure in the module symbol stream, one-based module index, and name
+		const size_t record = BeginRecord(symbolRecords, SymbolRecordKind::S_PROCREF);
+		Append<uint32_t>(symbolRecords, 0u);
+		Append<uint32_t>(symbolRecords, function.recordOffset);
+		Append<uint16_t>(symbolRecords, static_cast<uint16_t>(function.module + 1u));
+		AppendString(symbolRecords, name);
+		EndSymbolRecord(symbolRecords, record);
+
+		globalEntries.push_back(HashEntry { HashString(name), recordOffset });
+		++globalFunction;
+	}
+
+	for (uint32_t i = 0u; i < configuration.globalCount - globalFunctionCount; ++i)
+	{
+		snprintf(name, sizeof(name), "g_data%u", i);
+		const uint32_t recordOffset = static_cast<uint32_t>(symbolRecords.size());
+
+		const size_t record = BeginRecord(symbolRecords, SymbolRecordKind::S_GDATA32);
+		Append<uint32_t>(symbolRecords, 0x74u);			// T_INT4
+		Append<uint32_t>(symbolRecords, i * DataSymbolSize);
+		Append<uint16_t>(symbolRecords, DataSection);
+		AppendString(symbolRecords, name);
+		EndSymbolRecord(symbolRecords, record);
+
+		globalEntries.push_back(HashEntry { HashString(name), recordOffset });
+	}
+
+	for (uint32_t i = 0u; i < configuration.publicCount; ++i)
+	{
+		const bool isFunction = (i < publicFunctionCount);
+		const uint32_t offset = isFunction ? functions[i].offset : (i - publicFunctionCount) * DataSymbolSize;
+		const uint16_t section = isFunction ? TextSection : DataSection;
+		if (isFunction)
+		{
+			snprintf(name, sizeof(name), "?Function%u@Module%u@@YAXXZ", functions[i].indexInModule, functions[i].module);
+		}
+		else
+		{
+			snprintf(name, sizeof(name), "?g_data%u@@3HA", i - publicFunctionCount);
+		}
+
+		const uint32_t recordOffset = static_cast<uint32_t>(symbolRecords.size());
+
+		const size_t record = BeginRecord(symbolRecords, SymbolRecordKind::S_PUB32);
+		Append(symbolRecords, isFunction ? (PDB::CodeView::DBI::PublicSymbolFlags::Code | PDB::CodeView::DBI::PublicSymbolFlags::Function) : PDB::CodeView::DBI::PublicSymbolFlags::None);
+		Append<uint32_t>(symbolRecords, offset);
+		Append<uint16_t>(symbolRecords, section);
+		AppendString(symbolRecords, name);
+		EndSymbolRecord(symbolRecords, record);
+
+		publicEntries.push_back(HashEntry { HashString(name), recordOffset });
+		publicAddresses.push_back(PublicAddress { section, offset, recordOffset });
+	}
+
+	statistics.symbolRecordStreamSize = symbolRecords.size();
+
+	// the global symbol stream only consists of the hash table
+	Buffer globalStream;
+	AppendHashTable(globalStream, globalEntries);
+
+	// image sections
+	const uint32_t rdataSize = SectionAlignment;
+	const uint32_t sectionSizes[SectionCount] = { std::max(textSize, 1u), rdataSize, std::max(dataCount * DataSymbolSize, 1u) };
+	uint32_t sectionAddresses[SectionCount] = {};
+	Buffer sectionHeaderStream = BuildSectionHeaderStream(sectionSizes, sectionAddresses);
+
+	// the public symbol stream consists of a header, the hash table, the address map, the thunk map, and the section map.
+	// the address map stores the offsets of all S_PUB32 records, sorted by address.
+	// the thunk map stores the RVA of the target of each thunk, and the section map stores the RVA of each section.
+	Buffer publicHashTable;
+	AppendHashTable(publicHashTable, publicEntries);
+
+	std::stable_sort(publicAddresses.begin(), publicAddresses.end(), [](const PublicAddress& lhs, const PublicAddress& rhs)
+	{
+		return (lhs.section < rhs.section) || ((lhs.section == rhs.section) && (lhs.offset < rhs.offset));
+	});
+
+	PDB::PublicStreamHeader publicHeader = {};
+	publicHeader.symHash = static_cast<uint32_t>(publicHashTable.size());
+	publicHeader.addrMap = static_cast<uint32_t>(publicAddresses.size() * sizeof(uint32_t));
+	publicHeader.thunkCount = thunkCount;
+	publicHeader.sizeOfThunk = ThunkSize;
+	publicHeader.isectThunkTable = TextSection;
+	publicHeader.offsetThunkTable = thunkTableOffset;
+	publicHeader.sectionCount = static_cast<uint16_t>(SectionCount);
+
+	Buffer publicStream;
+	Append(publicStream, publicHeader);
+	publicStream.insert(publicStream.end(), publicHashTable.begin(), publicHashTable.end());
+	for (const PublicAddress& address : publicAddresses)
+	{
+		Append(publicStream, address.recordOffset);
+	}
+
+	for (uint32_t i = 0u; i < thunkCount; ++i)
+	{
+		Append<uint32_t>(publicStream, sectionAddresses[TextSection - 1u] + functions[i % functions.size()].offset);
+	}
+
+	for (uint32_t i = 0u; i < SectionCount; ++i)
+	{
+		Append(publicStream, PDB::PublicStreamSectionMapEntry { sectionAddresses[i], static_cast<uint16_t>(i + 1u), 0u });
+	}
+
+	// DBI stream
+	// https://llvm.org/docs/PDB/DbiStream.html
+	Buffer moduleInfos;
+	Buffer sectionContributions;
+	Append(sectionContributions, PDB::DBI::SectionContribution::Version::Ver60);
+	for (uint32_t i = 0u; i < moduleCount; ++i)
+	{
+		const Module& module = modules[i];
+		const bool isLinkerModule = (i == linkerModule);
+
+		PDB::DBI::SectionContribution contribution = {};
+		if (isLinkerModule)
+		{
+			contribution.section = RDataSection;
+			contribution.offset = 0u;
+			contribution.size = rdataSize;
+			contribution.characteristics = 0x40000040u;
+		}
+		else
+		{
+			const Function* first = module.functionCount ? &functions[module.firstFunction] : nullptr;
+			const Function* last = module.functionCount ? &functions[module.firstFunction + module.functionCount - 1u] : nullptr;
+			contribution.section = TextSection;
+			contribution.offset = first ? first->offset : textSize;
+			contribution.size = first ? (last->offset + last->size - first->offset) : 0u;
+			contribution.characteristics = 0x60000020u;
+		}
+		contribution.moduleIndex = static_cast<uint16_t>(i);
+		Append(sectionContributions, contribution);
+
+		PDB::DBI::ModuleInfo info = {};
+		info.sectionContribution = contribution;
+		info.moduleSymbolStreamIndex = module.streamIndex;
+		info.symbolSize = module.symbolSize;
+		info.c13Size = module.c13Size;
+		info.sourceFileCount = isLinkerModule ? 0u : 1u;
+		Append(moduleInfos, info);
+
+		if (isLinkerModule)
+		{
+			AppendString(moduleInfos, "* Linker *");
+			AppendString(moduleInfos, "");
+		}
+		else
+		{
+			snprintf(name, sizeof(name), "C:\\build\\obj\\module%u.obj", i);
+			AppendString(moduleInfos, name);
+			AppendString(moduleInfos, name);
+		}
+
+		AlignTo4(moduleInfos);
+	}
+
+	// section map, one entry per section followed by an entry for absolute symbols
+	// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+	Buffer sectionMap;
+	Append<uint16_t>(sectionMap, static_cast<uint16_t>(SectionCount + 1u));
+	Append<uint16_t>(sectionMap, static_cast<uint16_t>(SectionCount + 1u));
+	for (uint32_t i = 0u; i <= SectionCount; ++i)
+	{
+		static const uint16_t Flags[SectionCount + 1u] = { 0x010Du, 0x0109u, 0x010Bu, 0x0208u };
+
+		Append<uint16_t>(sectionMap, Flags[i]);
+		Append<uint16_t>(sectionMap, 0u);								// overlay
+		Append<uint16_t>(sectionMap, 0u);								// group
+		Append<uint16_t>(sectionMap, static_cast<uint16_t>(i + 1u));	// frame
+		Append<uint16_t>(sectionMap, 0xFFFFu);							// section name
+		Append<uint16_t>(sectionMap, 0xFFFFu);							// class name
+		Append<uint32_t>(sectionMap, 0u);								// offset
+		Append<uint32_t>(sectionMap, (i < SectionCount) ? sectionSizes[i] : UINT32_MAX);
+	}
+
+	// source info, one source file per compiland.
+	// like in real PDBs, module indices and counts are truncated to 16 bits.
+	Buffer sourceInfo;
+	{
+		const uint32_t sourceModuleCount = std::min(moduleCount, 0xFFFFu);
+		Append<uint16_t>(sourceInfo, static_cast<uint16_t>(sourceModuleCount));
+		Append<uint16_t>(sourceInfo, static_cast<uint16_t>(std::min(sourceModuleCount, compilandCount)));
+
+		for (uint32_t i = 0u; i < sourceModuleCount; ++i)
+		{
+			Append<uint16_t>(sourceInfo, static_cast<uint16_t>(std::min(i, compilandCount)));
+		}
+
+		for (uint32_t i = 0u; i < sourceModuleCount; ++i)
+		{
+			Append<uint16_t>(sourceInfo, (i == linkerModule) ? 0u : 1u);
+		}
+
+		Buffer stringTable;
+		for (uint32_t i = 0u; i < sourceModuleCount; ++i)
+		{
+			if (i != linkerModule)
+			{
+				Append<uint32_t>(sourceInfo, static_cast<uint32_t>(stringTable.size()));
+				snprintf(name, sizeof(name), "C:\\src\\module%u.cpp", i);
+				AppendString(stringTable, name);
+			}
+		}
+
+		sourceInfo.insert(sourceInfo.end(), stringTable.begin(), stringTable.end());
+		AlignTo4(sourceInfo);
+	}
+
+	// optional debug header, only the section header stream is present
+	PDB::DBI::DebugHeader debugHeader;
+	memset(&debugHeader, 0xFF, sizeof(debugHeader));
+	debugHeader.sectionHeaderStreamIndex = SectionHeaderStreamIndex;
+
+	PDB::DBI::StreamHeader dbiHeader = {};
+	dbiHeader.signature = PDB::DBI::StreamHeader::Signature;
+	dbiHeader.version = PDB::DBI::StreamHeader::Version::V70;
+	dbiHeader.age = 1u;
+	dbiHeader.globalStreamIndex = GlobalStreamIndex;
+	dbiHeader.toolchain = 0x8E1Du;				// new version format, 14.29
+	dbiHeader.publicStreamIndex = PublicStreamIndex;
+	dbiHeader.symbolRecordStreamIndex = SymbolRecordStreamIndex;
+	dbiHeader.moduleInfoSize = static_cast<uint32_t>(moduleInfos.size());
+	dbiHeader.sectionContributionSize = static_cast<uint32_t>(sectionContributions.size());
+	dbiHeader.sectionMapSize = static_cast<uint32_t>(sectionMap.size());
+	dbiHeader.sourceInfoSize = static_cast<uint32_t>(sourceInfo.size());
+	dbiHeader.optionalDebugHeaderSize = sizeof(PDB::DBI::DebugHeader);
+	dbiHeader.machine = 0x8664u;				// IMAGE_FILE_MACHINE_AMD64
+
+	Buffer dbiStream;
+	Append(dbiStream, dbiHeader);
+	dbiStream.insert(dbiStream.end(), moduleInfos.begin(), moduleInfos.end());
+	dbiStream.insert(dbiStream.end(), sectionContributions.begin(), sectionContributions.end());
+	dbiStream.insert(dbiStream.end(), sectionMap.begin(), sectionMap.end());
+	dbiStream.insert(dbiStream.end(), sourceInfo.begin(), sourceInfo.end());
+	Append(dbiStream, debugHeader);
+
+	streams[InfoStreamIndex] = BuildInfoStream(random, namesStreamIndex);
+	streams[TPIStreamIndex] = BuildTypeStreamHeader(0u, 0u);
+	streams[DBIStreamIndex] = std::move(dbiStream);
+	streams[IPIStreamIndex] = BuildIPIStream(configuration.ipiRecordCount);
+	streams[SectionHeaderStreamIndex] = std::move(sectionHeaderStream);
+	streams[GlobalStreamIndex] = std::move(globalStream);
+	streams[PublicStreamIndex] = std::move(publicStream);
+	streams[SymbolRecordStreamIndex] = std::move(symbolRecords);
+
+	// the address trace uses its own random number generator, so that it doesn't change the contents of the streams.
+	// 90% of all samples hit one of the hot functions, 1% hit a thunk or miss all functions, the rest hit any function.
+	trace.clear();
+	if (!functions.empty())
+	{
+		Random traceRandom(configuration.seed ^ 0x5452414345ull);
+		const uint32_t textAddress = sectionAddresses[TextSection - 1u];
+		const uint32_t hotFunctionCount = std::max(static_cast<uint32_t>(functions.size() / 100u), 1u);
+
+		std::vector<uint32_t> hotFunctions(hotFunctionCount);
+		for (uint32_t& hotFunction : hotFunctions)
+		{
+			hotFunction = traceRandom.NextBelow(static_cast<uint32_t>(functions.size()));
+		}
+
+		trace.reserve(configuration.traceLength);
+		for (uint32_t i = 0u; i < configuration.traceLength; ++i)
+		{
+			const uint32_t kind = traceRandom.NextBelow(100u);
+			if (kind == 0u)
+			{
+				trace.push_back(textAddress + traceRandom.NextBelow(textSize + SectionAlignment));
+				continue;
+			}
+
+			const Function& function = (kind < 91u) ? functions[hotFunctions[traceRandom.NextBelow(hotFunctionCount)]] : functions[traceRandom.NextBelow(static_cast<uint32_t>(functions.size()))];
+			trace.push_back(textAddress + function.offset + traceRandom.NextBelow(function.size));
+		}
+	}
+
+	return streams;
+}
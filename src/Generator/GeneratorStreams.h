@@ -0,0 +1,38 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace Streams
+{
+	struct Configuration
+	{
+		uint32_t moduleCount;			// number of modules, including the "* Linker *" module
+		uint32_t functionCount;			// number of functions, distributed evenly across all modules except the linker module
+		uint32_t publicCount;			// number of S_PUB32 records, referring to functions first and data second
+		uint32_t globalCount;			// number of records in the global symbol stream, S_PROCREF for functions first and S_GDATA32 second
+		uint32_t ipiRecordCount;		// number of records in the IPI stream
+		uint32_t thunkCount;			// number of incremental linking thunks, stored at the end of the .text section
+		uint32_t traceLength;			// number of RVAs in the address trace
+		uint64_t seed;
+	};
+
+	struct Statistics
+	{
+		uint32_t moduleSymbolStreamCount;
+		uint32_t moduleSymbolRecordCount;
+		uint32_t lineCount;
+		uint32_t inlineSiteCount;
+		uint32_t dataCount;
+		uint64_t symbolRecordStreamSize;
+	};
+
+	// builds the contents of all streams of a PDB file, in stream index order.
+	// modules that cannot be assigned a 16-bit stream index are written without a symbol stream.
+	// additionally builds an address trace as recorded by a sampling profiler, mostly hitting a small set of hot functions.
+	std::vector<std::vector<uint8_t>> Build(const Configuration& configuration, Statistics& statistics, std::vector<uint32_t>& trace);
+}
@@ -6,18 +6,127 @@
 #include "PDB_Types.h"
 #include "PDB_Util.h"
 #include "PDB_RawFile.h"
+#include "PDB_BlockSource.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_DBITypes.h"
 #include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_Memory.h"
 #include "Foundation/PDB_DisableWarningsPush.h"
 #include <cstring>
 #include "Foundation/PDB_DisableWarningsPop.h"
 
 
+namespace
+{
+	// the PDB info stream always resides at index 1, the DBI stream at index 3
+	static constexpr const uint32_t InfoStreamIndex = 1u;
+	static constexpr const uint32_t DBIStreamIndex = 3u;
+
+	// the stream directory marks deleted streams using this size
+	static constexpr const uint32_t NilStreamSize = 0xFFFFFFFFu;
+
+	// streams with at most this many blocks are probed without allocating memory
+	static constexpr const uint32_t MaxInlineBlockCount = 16u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t ReadUInt32(const PDB::BlockSource& source, size_t fileOffset) PDB_NO_EXCEPT
+	{
+		uint32_t value = 0u;
+		source.Read(&value, sizeof(uint32_t), fileOffset);
+
+		return value;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t ReadDirectoryUInt32(const PDB::BlockSource& source, const PDB::SuperBlock& superBlock, uint32_t directoryOffset) PDB_NO_EXCEPT
+	{
+		// the directory is never coalesced. instead, each value is looked up in two steps:
+		// the SuperBlock stores the indices of blocks holding the indices of directory blocks, which in turn hold the directory.
+		// all values are 4-byte aligned, so they never straddle a block boundary.
+		const uint32_t blockSize = superBlock.blockSize;
+		const uint32_t directoryBlock = directoryOffset / blockSize;
+
+		const uint32_t directoryIndexOffset = directoryBlock * sizeof(uint32_t);
+		const uint32_t directoryIndicesBlockIndex = ReadUInt32(source, sizeof(PDB::SuperBlock) + (directoryIndexOffset / blockSize) * sizeof(uint32_t));
+		const uint32_t directoryBlockIndex = ReadUInt32(source, PDB::ConvertBlockIndexToFileOffset(directoryIndicesBlockIndex, blockSize) + directoryIndexOffset % blockSize);
+
+		return ReadUInt32(source, PDB::ConvertBlockIndexToFileOffset(directoryBlockIndex, blockSize) + directoryOffset % blockSize);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void ReadStreamBlockIndices(const PDB::BlockSource& source, const PDB::SuperBlock& superBlock, uint32_t streamCount, uint32_t streamIndex, uint32_t* blockIndices, uint32_t blockCount) PDB_NO_EXCEPT
+	{
+		// https://llvm.org/docs/PDB/MsfFile.html#the-stream-directory
+		// the block indices of a stream follow the block indices of all streams before it
+		uint32_t directoryOffset = sizeof(uint32_t) + sizeof(uint32_t) * streamCount;
+		for (uint32_t i = 0u; i < streamIndex; ++i)
+		{
+			const uint32_t streamSize = ReadDirectoryUInt32(source, superBlock, sizeof(uint32_t) + sizeof(uint32_t) * i);
+			directoryOffset += PDB::ConvertSizeToBlockCount(streamSize, superBlock.blockSize) * sizeof(uint32_t);
+		}
+
+		for (uint32_t i = 0u; i < blockCount; ++i)
+		{
+			blockIndices[i] = ReadDirectoryUInt32(source, superBlock, directoryOffset + sizeof(uint32_t) * i);
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool ReadFastLinkFlag(const PDB::DirectMSFStream& stream) PDB_NO_EXCEPT
+	{
+		// the info stream starts with the header, followed by the named stream map, followed by the feature codes.
+		// this mirrors the parsing done by InfoStream, but only reads the few values needed for skipping to the feature codes.
+		// https://llvm.org/docs/PDB/PdbStream.html#named-stream-map
+		size_t streamOffset = sizeof(PDB::Header);
+		streamOffset += sizeof(PDB::NamedStreamMap) + stream.ReadAtOffset<uint32_t>(streamOffset);
+
+		const PDB::SerializedHashTable::Header hashTableHeader = stream.ReadAtOffset<PDB::SerializedHashTable::Header>(streamOffset);
+		streamOffset += sizeof(PDB::SerializedHashTable::Header);
+
+		streamOffset += sizeof(PDB::SerializedHashTable::BitVector) + sizeof(uint32_t) * stream.ReadAtOffset<uint32_t>(streamOffset);
+		streamOffset += sizeof(PDB::SerializedHashTable::BitVector) + sizeof(uint32_t) * stream.ReadAtOffset<uint32_t>(streamOffset);
+		streamOffset += sizeof(PDB::NamedStreamMap::HashTableEntry) * hashTableHeader.size;
+
+		// read feature codes by consuming remaining bytes
+		// https://llvm.org/docs/PDB/PdbStream.html#pdb-feature-codes
+		for (/* nothing */; streamOffset + sizeof(PDB::FeatureCode) <= stream.GetSize(); streamOffset += sizeof(PDB::FeatureCode))
+		{
+			if (stream.ReadAtOffset<PDB::FeatureCode>(streamOffset) == PDB::FeatureCode::MinimalDebugInfo)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::ErrorCode PDB::ValidateFile(const void* data) PDB_NO_EXCEPT
+{
+	return ValidateFile(BlockSource(data));
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::ValidateFile(const BlockSource& source) PDB_NO_EXCEPT
 {
 	// validate the super block
-	const SuperBlock* superBlock = Pointer::Offset<const SuperBlock*>(data, 0u);
+	SuperBlock header;
+	source.Read(&header, sizeof(SuperBlock), 0u);
+
+	const SuperBlock* superBlock = &header;
 	{
 		// validate header magic
 		if (std::memcmp(superBlock->fileMagic, SuperBlock::MAGIC, sizeof(SuperBlock::MAGIC) != 0))
@@ -37,9 +146,119 @@ PDB_NO_DISCARD PDB::ErrorCode PDB::ValidateFile(const void* data) PDB_NO_EXCEPT
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::ProbeFile(const void* data, ProbeInfo* info) PDB_NO_EXCEPT
+{
+	return ProbeFile(BlockSource(data), info);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::ProbeFile(const BlockSource& source, ProbeInfo* info) PDB_NO_EXCEPT
+{
+	const ErrorCode validationError = ValidateFile(source);
+	if (validationError != ErrorCode::Success)
+	{
+		return validationError;
+	}
+
+	SuperBlock superBlock;
+	source.Read(&superBlock, sizeof(SuperBlock), 0u);
+
+	const uint32_t streamCount = ReadDirectoryUInt32(source, superBlock, 0u);
+	if (streamCount <= InfoStreamIndex)
+	{
+		return ErrorCode::InvalidStreamIndex;
+	}
+
+	// read the info stream header and feature codes
+	{
+		const uint32_t streamSize = ReadDirectoryUInt32(source, superBlock, sizeof(uint32_t) + sizeof(uint32_t) * InfoStreamIndex);
+		if ((streamSize == NilStreamSize) || (streamSize < sizeof(Header)))
+		{
+			return ErrorCode::InvalidStreamIndex;
+		}
+
+		const uint32_t blockCount = ConvertSizeToBlockCount(streamSize, superBlock.blockSize);
+
+		uint32_t inlineBlockIndices[MaxInlineBlockCount];
+		uint32_t* blockIndices = (blockCount <= MaxInlineBlockCount) ? inlineBlockIndices : PDB_NEW_ARRAY(uint32_t, blockCount);
+		ReadStreamBlockIndices(source, superBlock, streamCount, InfoStreamIndex, blockIndices, blockCount);
+
+		const DirectMSFStream stream(source, superBlock.blockSize, blockIndices, streamSize);
+		const Header header = stream.ReadAtOffset<Header>(0u);
+
+		info->guid = header.guid;
+		info->signature = header.signature;
+		info->age = header.age;
+		info->version = header.version;
+		info->usesDebugFastLink = ReadFastLinkFlag(stream);
+
+		if (blockIndices != inlineBlockIndices)
+		{
+			PDB_DELETE_ARRAY(blockIndices);
+		}
+	}
+
+	// read the DBI stream header, which always fits into the first block
+	info->hasDBIStream = false;
+	info->dbiAge = 0u;
+	info->machine = 0u;
+
+	if (streamCount > DBIStreamIndex)
+	{
+		const uint32_t streamSize = ReadDirectoryUInt32(source, superBlock, sizeof(uint32_t) + sizeof(uint32_t) * DBIStreamIndex);
+		if ((streamSize != NilStreamSize) && (streamSize >= sizeof(DBI::StreamHeader)))
+		{
+			uint32_t blockIndex = 0u;
+			ReadStreamBlockIndices(source, superBlock, streamCount, DBIStreamIndex, &blockIndex, 1u);
+
+			DBI::StreamHeader header;
+			source.Read(&header, sizeof(DBI::StreamHeader), ConvertBlockIndexToFileOffset(blockIndex, superBlock.blockSize));
+			if (header.signature != DBI::StreamHeader::Signature)
+			{
+				return ErrorCode::InvalidSignature;
+			}
+
+			info->hasDBIStream = true;
+			info->dbiAge = header.age;
+			info->machine = header.machine;
+		}
+	}
+
+	return ErrorCode::Success;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::RawFile PDB::CreateRawFile(const void* data) PDB_NO_EXCEPT
 {
 	return RawFile(data);
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::RawFile PDB::CreateRawFile(const void* data, int fileDescriptor) PDB_NO_EXCEPT
+{
+	return RawFile(data, fileDescriptor);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::RawFile PDB::CreateRawFile(const BlockSource& source) PDB_NO_EXCEPT
+{
+	return RawFile(source);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::RawFile PDB::CreateRawFile(const BlockSource& source, const Allocator& allocator) PDB_NO_EXCEPT
+{
+	return RawFile(source, allocator);
+}
@@ -5,17 +5,55 @@
 
 #include "Foundation/PDB_Macros.h"
 #include "PDB_ErrorCodes.h"
+#include "PDB_Types.h"
 
 
 // https://llvm.org/docs/PDB/index.html
 namespace PDB
 {
 	class RawFile;
+	class BlockSource;
+	struct Allocator;
+
+
+	// identity of a PDB file, as read by ProbeFile().
+	struct ProbeInfo
+	{
+		GUID guid;
+		uint32_t signature;
+		uint32_t age;
+		Header::Version version;
+		bool usesDebugFastLink;
+
+		// only valid if the file has a DBI stream
+		bool hasDBIStream;
+		uint32_t dbiAge;
+		uint16_t machine;
+	};
 
 
 	// Validates whether a PDB file is valid.
 	PDB_NO_DISCARD ErrorCode ValidateFile(const void* data) PDB_NO_EXCEPT;
 
+	// Validates whether a PDB file read through the given block source is valid.
+	PDB_NO_DISCARD ErrorCode ValidateFile(const BlockSource& source) PDB_NO_EXCEPT;
+
+	// Validates a PDB file and reads its identity without creating a raw file.
+	// Only the parts of the stream directory describing the info and DBI streams are read, along with the headers of those streams.
+	// This touches a handful of pages per file, which makes it suitable for indexing large symbol stores.
+	PDB_NO_DISCARD ErrorCode ProbeFile(const void* data, ProbeInfo* info) PDB_NO_EXCEPT;
+	PDB_NO_DISCARD ErrorCode ProbeFile(const BlockSource& source, ProbeInfo* info) PDB_NO_EXCEPT;
+
 	// Creates a raw PDB file that must have been validated.
 	PDB_NO_DISCARD RawFile CreateRawFile(const void* data) PDB_NO_EXCEPT;
+
+	// Creates a raw PDB file that must have been validated, along with the file descriptor of the memory-mapped file.
+	// On Linux, this allows coalesced streams to remap disjunct blocks into contiguous memory instead of copying them.
+	PDB_NO_DISCARD RawFile CreateRawFile(const void* data, int fileDescriptor) PDB_NO_EXCEPT;
+
+	// Creates a raw PDB file that must have been validated, reading all its data through the given block source.
+	PDB_NO_DISCARD RawFile CreateRawFile(const BlockSource& source) PDB_NO_EXCEPT;
+
+	// Creates a raw PDB file that must have been validated, routing all allocations of the file and its streams through the given allocator.
+	PDB_NO_DISCARD RawFile CreateRawFile(const BlockSource& source, const Allocator& allocator) PDB_NO_EXCEPT;
 }
@@ -0,0 +1,200 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_Allocator.h"
+#include "PDB_Types.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_Assert.h"
+#include "Foundation/PDB_PointerUtil.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static void* AllocateDefault(void* /* userData */, size_t size, size_t alignment) PDB_NO_EXCEPT
+	{
+		// memory returned by operator new[] is suitably aligned for any fundamental type
+		PDB_ASSERT(alignment <= alignof(std::max_align_t), "Alignment %zu is not supported by the default allocator.", alignment);
+		(void)alignment;
+
+		return PDB_NEW_ARRAY(PDB::Byte, size);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void FreeDefault(void* /* userData */, void* memory) PDB_NO_EXCEPT
+	{
+		PDB::Byte* array = static_cast<PDB::Byte*>(memory);
+		PDB_DELETE_ARRAY(array);
+	}
+
+
+	static const PDB::Allocator DefaultAllocator = { &AllocateDefault, &FreeDefault, nullptr, nullptr };
+}
+
+
+// the chunk header directly precedes the chunk's memory, and is padded so that the memory is suitably aligned for any type
+struct alignas(std::max_align_t) PDB::ArenaAllocator::Chunk
+{
+	Chunk* previous;
+	size_t size;
+	size_t offset;
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::Allocator& PDB::GetDefaultAllocator(void) PDB_NO_EXCEPT
+{
+	return DefaultAllocator;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ArenaAllocator::ArenaAllocator(size_t chunkSize) PDB_NO_EXCEPT
+	: m_chunks(nullptr)
+	, m_chunkSize(chunkSize)
+	, m_allocationCount(0u)
+	, m_allocatedBytes(0u)
+	, m_reservedBytes(0u)
+	, m_mutex()
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ArenaAllocator::~ArenaAllocator(void) PDB_NO_EXCEPT
+{
+	Reset();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::Allocator PDB::ArenaAllocator::GetAllocator(void) const PDB_NO_EXCEPT
+{
+	return Allocator { &ArenaAllocator::Allocate, &ArenaAllocator::Free, const_cast<ArenaAllocator*>(this), nullptr };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ArenaAllocator::Reset(void) PDB_NO_EXCEPT
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	while (m_chunks)
+	{
+		Chunk* previous = m_chunks->previous;
+
+		Byte* memory = reinterpret_cast<Byte*>(m_chunks);
+		PDB_DELETE_ARRAY(memory);
+
+		m_chunks = previous;
+	}
+
+	m_allocationCount = 0u;
+	m_allocatedBytes = 0u;
+	m_reservedBytes = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::ArenaAllocator::GetAllocationCount(void) const PDB_NO_EXCEPT
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_allocationCount;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::ArenaAllocator::GetAllocatedBytes(void) const PDB_NO_EXCEPT
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_allocatedBytes;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::ArenaAllocator::GetReservedBytes(void) const PDB_NO_EXCEPT
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_reservedBytes;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void* PDB::ArenaAllocator::Allocate(void* userData, size_t size, size_t alignment) PDB_NO_EXCEPT
+{
+	ArenaAllocator* arena = static_cast<ArenaAllocator*>(userData);
+
+	return arena->Allocate(size, alignment);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ArenaAllocator::Free(void* /* userData */, void* /* memory */) PDB_NO_EXCEPT
+{
+	// individual allocations are never freed, the memory is released when the arena is reset
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void* PDB::ArenaAllocator::Allocate(size_t size, size_t alignment) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(alignment <= alignof(std::max_align_t), "Alignment %zu is not supported by the arena.", alignment);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	++m_allocationCount;
+	m_allocatedBytes += size;
+
+	// try to bump the pointer in the current chunk first
+	if (m_chunks)
+	{
+		const size_t offset = (m_chunks->offset + (alignment - 1u)) & ~(alignment - 1u);
+		if (offset + size <= m_chunks->size)
+		{
+			m_chunks->offset = offset + size;
+
+			return Pointer::Offset<Byte*>(m_chunks + 1, offset);
+		}
+	}
+
+	// allocate a new chunk. allocations larger than the chunk size get a chunk of their own.
+	const size_t chunkSize = (size > m_chunkSize) ? size : m_chunkSize;
+	Byte* memory = PDB_NEW_ARRAY(Byte, sizeof(Chunk) + chunkSize);
+	m_reservedBytes += sizeof(Chunk) + chunkSize;
+
+	Chunk* chunk = reinterpret_cast<Chunk*>(memory);
+	chunk->size = chunkSize;
+	chunk->offset = size;
+
+	if (m_chunks && (size > m_chunkSize))
+	{
+		// keep bumping the pointer of the current chunk, the dedicated chunk will never be used for any other allocation
+		chunk->previous = m_chunks->previous;
+		m_chunks->previous = chunk;
+	}
+	else
+	{
+		chunk->previous = m_chunks;
+		m_chunks = chunk;
+	}
+
+	return chunk + 1;
+}
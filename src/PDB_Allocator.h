@@ -0,0 +1,124 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <type_traits>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace PDB
+{
+	// routes the memory allocations of a raw file and all streams created from it.
+	// the allocator is copied into every object that allocates memory, so the functions and user data need to outlive all of them.
+	struct Allocator
+	{
+		// Allocates a block of memory with the given size and alignment. Must be thread-safe.
+		typedef void* (*AllocateFunction)(void* userData, size_t size, size_t alignment);
+
+		// Frees a block of memory that was allocated by the same allocator. Must be thread-safe.
+		typedef void (*FreeFunction)(void* userData, void* memory);
+
+		// Is told about data copied into memory allocated by the same allocator, e.g. when coalescing disjunct blocks. Must be thread-safe.
+		typedef void (*CopyFunction)(void* userData, size_t size);
+
+		AllocateFunction allocate;
+		FreeFunction free;
+		void* userData;
+
+		// optional, can be nullptr
+		CopyFunction copied;
+	};
+
+
+	// Returns the allocator used by default, which allocates using PDB_NEW_ARRAY.
+	PDB_NO_DISCARD const Allocator& GetDefaultAllocator(void) PDB_NO_EXCEPT;
+
+
+	// Allocates and default-constructs an array using the given allocator.
+	template <typename T>
+	PDB_NO_DISCARD inline T* AllocateArray(const Allocator& allocator, size_t length) PDB_NO_EXCEPT
+	{
+		static_assert(std::is_trivially_destructible<T>::value == true, "Arrays are freed without calling destructors.");
+
+		T* array = static_cast<T*>(allocator.allocate(allocator.userData, sizeof(T) * length, alignof(T)));
+		for (size_t i = 0u; i < length; ++i)
+		{
+			new (array + i) T;
+		}
+
+		return array;
+	}
+
+
+	// Tells the given allocator that the given number of bytes were copied into memory allocated by it, if it wants to know.
+	inline void ReportCopy(const Allocator& allocator, size_t size) PDB_NO_EXCEPT
+	{
+		if (allocator.copied)
+		{
+			allocator.copied(allocator.userData, size);
+		}
+	}
+
+
+	// Frees an array that was allocated using AllocateArray.
+	template <typename T>
+	inline void FreeArray(const Allocator& allocator, T* array) PDB_NO_EXCEPT
+	{
+		if (array)
+		{
+			allocator.free(allocator.userData, const_cast<typename std::remove_const<T>::type*>(array));
+		}
+	}
+
+
+	// a bump-pointer allocator that hands out memory from large chunks.
+	// freeing individual allocations does nothing, all memory is released at once when the arena is reset or destroyed.
+	// all raw files, streams and other objects using the arena must have been destroyed by then.
+	// thread-safe, allocations are serialized using a lock.
+	class PDB_NO_DISCARD ArenaAllocator
+	{
+	public:
+		explicit ArenaAllocator(size_t chunkSize = 1024u * 1024u) PDB_NO_EXCEPT;
+		~ArenaAllocator(void) PDB_NO_EXCEPT;
+
+		// Returns an allocator that refers to this arena.
+		PDB_NO_DISCARD Allocator GetAllocator(void) const PDB_NO_EXCEPT;
+
+		// Releases all memory allocated from the arena, and resets all statistics.
+		void Reset(void) PDB_NO_EXCEPT;
+
+		// Returns the number of allocations made.
+		PDB_NO_DISCARD size_t GetAllocationCount(void) const PDB_NO_EXCEPT;
+
+		// Returns the number of bytes handed out by all allocations made.
+		PDB_NO_DISCARD size_t GetAllocatedBytes(void) const PDB_NO_EXCEPT;
+
+		// Returns the number of bytes reserved by the arena's chunks, including unused space and padding.
+		PDB_NO_DISCARD size_t GetReservedBytes(void) const PDB_NO_EXCEPT;
+
+	private:
+		struct Chunk;
+
+		static void* Allocate(void* userData, size_t size, size_t alignment) PDB_NO_EXCEPT;
+		static void Free(void* userData, void* memory) PDB_NO_EXCEPT;
+
+		void* Allocate(size_t size, size_t alignment) PDB_NO_EXCEPT;
+
+		Chunk* m_chunks;
+		size_t m_chunkSize;
+		size_t m_allocationCount;
+		size_t m_allocatedBytes;
+		size_t m_reservedBytes;
+
+		mutable std::mutex m_mutex;
+
+		PDB_DISABLE_COPY_MOVE(ArenaAllocator);
+	};
+}
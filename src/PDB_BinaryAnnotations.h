@@ -0,0 +1,210 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_DBITypes.h"
+#include "PDB_Util.h"
+
+
+namespace PDB
+{
+	// a decoded binary annotation of an inline site
+	struct BinaryAnnotation
+	{
+		CodeView::DBI::BinaryAnnotationOpcode opcode;
+
+		// for ChangeCodeOffsetAndLineOffset, the first operand holds the code offset delta, and the second the signed line delta.
+		// for ChangeCodeLengthAndCodeOffset, the first operand holds the code length, and the second the code offset delta.
+		// all other opcodes only use the first operand.
+		uint32_t operand1;
+		uint32_t operand2;
+	};
+
+
+	// Decompresses an operand of a binary annotation, advancing the data pointer. Returns false in case the data is malformed.
+	// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4816
+	PDB_NO_DISCARD inline bool DecompressAnnotationOperand(const uint8_t*& data, const uint8_t* end, uint32_t& operand) PDB_NO_EXCEPT
+	{
+		if (data >= end)
+		{
+			return false;
+		}
+
+		// the number of leading set bits of the first byte denotes the size of the operand, which can be 1, 2 or 4 bytes
+		const uint8_t first = data[0];
+		if ((first & 0x80u) == 0x00u)
+		{
+			operand = first;
+			data += 1u;
+			return true;
+		}
+		else if (((first & 0xC0u) == 0x80u) && (end - data >= 2))
+		{
+			operand = (static_cast<uint32_t>(first & 0x3Fu) << 8u) | data[1];
+			data += 2u;
+			return true;
+		}
+		else if (((first & 0xE0u) == 0xC0u) && (end - data >= 4))
+		{
+			operand = (static_cast<uint32_t>(first & 0x1Fu) << 24u) | (static_cast<uint32_t>(data[1]) << 16u) | (static_cast<uint32_t>(data[2]) << 8u) | data[3];
+			data += 4u;
+			return true;
+		}
+
+		return false;
+	}
+
+	// Decodes a signed operand, which stores the sign in the lowest bit.
+	// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4868
+	PDB_NO_DISCARD inline int32_t DecodeSignedAnnotationOperand(uint32_t operand) PDB_NO_EXCEPT
+	{
+		const int32_t magnitude = static_cast<int32_t>(operand >> 1u);
+		return (operand & 1u) ? -magnitude : magnitude;
+	}
+
+	// Returns the binary annotations of an S_INLINESITE or S_INLINESITE2 record, and stores their size.
+	PDB_NO_DISCARD inline const uint8_t* GetBinaryAnnotations(const CodeView::DBI::Record* record, size_t& size) PDB_NO_EXCEPT
+	{
+		const uint32_t recordSize = GetCodeViewRecordSize(record);
+		const uint8_t* annotations = (record->header.kind == CodeView::DBI::SymbolRecordKind::S_INLINESITE2) ? record->data.S_INLINESITE2.binaryAnnotations : record->data.S_INLINESITE.binaryAnnotations;
+		const size_t offset = static_cast<size_t>(annotations - reinterpret_cast<const uint8_t*>(&record->data));
+
+		size = (recordSize > offset) ? recordSize - offset : 0u;
+		return annotations;
+	}
+
+	// Iterates all binary annotations of an S_INLINESITE or S_INLINESITE2 record.
+	// Stops at the padding following the annotations, or at the first malformed annotation.
+	template <typename F>
+	void ForEachBinaryAnnotation(const CodeView::DBI::Record* record, F&& functor) PDB_NO_EXCEPT
+	{
+		size_t size = 0u;
+		const uint8_t* data = GetBinaryAnnotations(record, size);
+		const uint8_t* end = data + size;
+
+		while (data < end)
+		{
+			uint32_t opcode = 0u;
+			if (!DecompressAnnotationOperand(data, end, opcode) || (opcode == PDB_AS_UNDERLYING(CodeView::DBI::BinaryAnnotationOpcode::Invalid)))
+			{
+				break;
+			}
+
+			BinaryAnnotation annotation = { static_cast<CodeView::DBI::BinaryAnnotationOpcode>(opcode), 0u, 0u };
+			if (!DecompressAnnotationOperand(data, end, annotation.operand1))
+			{
+				break;
+			}
+
+			if (annotation.opcode == CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeOffsetAndLineOffset)
+			{
+				// both deltas are packed into one operand
+				annotation.operand2 = annotation.operand1 >> 4u;
+				annotation.operand1 &= 0xFu;
+			}
+			else if (annotation.opcode == CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeLengthAndCodeOffset)
+			{
+				if (!DecompressAnnotationOperand(data, end, annotation.operand2))
+				{
+					break;
+				}
+			}
+
+			functor(annotation);
+		}
+	}
+
+	// Decodes the code ranges of an S_INLINESITE or S_INLINESITE2 record, calling the functor with
+	// the code offset, code length, line number and file checksum offset of each range.
+	// Code offsets are relative to the start of the enclosing procedure, even for nested inline sites.
+	// The line number and file checksum offset the inlinee starts at are stored in the DEBUG_S_INLINEELINES subsection of the module.
+	template <typename F>
+	void ForEachInlineSiteRange(const CodeView::DBI::Record* record, uint32_t lineNumber, uint32_t fileChecksumOffset, F&& functor) PDB_NO_EXCEPT
+	{
+		// every change of the code offset starts a new range, which is ended by the next change of the code offset, or by an explicit length.
+		// changes to the line number or file apply to the next range.
+		uint32_t codeOffset = 0u;
+		uint32_t rangeLineNumber = 0u;
+		uint32_t rangeFileChecksumOffset = 0u;
+		bool isRangeOpen = false;
+
+		auto startRange = [&](uint32_t newCodeOffset)
+		{
+			if (isRangeOpen && (newCodeOffset > codeOffset))
+			{
+				functor(codeOffset, newCodeOffset - codeOffset, rangeLineNumber, rangeFileChecksumOffset);
+			}
+
+			codeOffset = newCodeOffset;
+			rangeLineNumber = lineNumber;
+			rangeFileChecksumOffset = fileChecksumOffset;
+			isRangeOpen = true;
+		};
+
+		auto endRange = [&](uint32_t codeLength)
+		{
+			if (isRangeOpen && (codeLength != 0u))
+			{
+				functor(codeOffset, codeLength, rangeLineNumber, rangeFileChecksumOffset);
+			}
+
+			codeOffset += codeLength;
+			isRangeOpen = false;
+		};
+
+		ForEachBinaryAnnotation(record, [&](const BinaryAnnotation& annotation)
+		{
+			switch (annotation.opcode)
+			{
+				case CodeView::DBI::BinaryAnnotationOpcode::CodeOffset:
+					startRange(annotation.operand1);
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeOffset:
+					startRange(codeOffset + annotation.operand1);
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeOffsetAndLineOffset:
+					lineNumber += static_cast<uint32_t>(DecodeSignedAnnotationOperand(annotation.operand2));
+					startRange(codeOffset + annotation.operand1);
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeLength:
+					endRange(annotation.operand1);
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeLengthAndCodeOffset:
+					startRange(codeOffset + annotation.operand2);
+					endRange(annotation.operand1);
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeFile:
+					fileChecksumOffset = annotation.operand1;
+					break;
+
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeLineOffset:
+					lineNumber += static_cast<uint32_t>(DecodeSignedAnnotationOperand(annotation.operand1));
+					break;
+
+				// columns, statement ranges and code offset bases are not needed for finding the code ranges
+				case CodeView::DBI::BinaryAnnotationOpcode::Invalid:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeCodeOffsetBase:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeLineEndDelta:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeRangeKind:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeColumnStart:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeColumnEndDelta:
+				case CodeView::DBI::BinaryAnnotationOpcode::ChangeColumnEnd:
+				default:
+					break;
+			}
+		});
+
+		// a range that is still open has no known length, and is therefore ignored
+	}
+}
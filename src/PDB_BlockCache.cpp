@@ -0,0 +1,505 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_BlockCache.h"
+#include "PDB_Types.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#if PDB_PLATFORM_LINUX
+#	include <cerrno>
+#	include <unistd.h>
+#endif
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace
+{
+	static constexpr const uint32_t InvalidSlot = 0xFFFFFFFFu;
+	static constexpr const uint64_t InvalidKey = 0xFFFFFFFFFFFFFFFFull;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint64_t MakeKey(uint32_t fileId, uint32_t pageIndex) PDB_NO_EXCEPT
+	{
+		return (static_cast<uint64_t>(fileId) << 32u) | pageIndex;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint64_t HashKey(uint64_t key) PDB_NO_EXCEPT
+	{
+		// the finalizer of MurmurHash3, good enough to distribute sequential page indices across shards and buckets
+		key ^= key >> 33u;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33u;
+		key *= 0xc4ceb9fe1a85ec53ull;
+		key ^= key >> 33u;
+
+		return key;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t RoundUpToPowerOfTwo(uint32_t value) PDB_NO_EXCEPT
+	{
+		uint32_t result = 1u;
+		while (result < value)
+		{
+			result <<= 1u;
+		}
+
+		return result;
+	}
+
+
+#if PDB_PLATFORM_LINUX
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void ReadFromFileDescriptor(void* userData, void* destination, size_t size, size_t fileOffset) PDB_NO_EXCEPT
+	{
+		// the file descriptor is stored in the user data pointer itself
+		const int fileDescriptor = static_cast<int>(reinterpret_cast<intptr_t>(userData));
+
+		size_t bytesRead = 0u;
+		while (bytesRead < size)
+		{
+			const ssize_t result = pread(fileDescriptor, PDB::Pointer::Offset<void*>(destination, bytesRead), size - bytesRead, static_cast<off_t>(fileOffset + bytesRead));
+			if (result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (result <= 0)
+			{
+				break;
+			}
+
+			bytesRead += static_cast<size_t>(result);
+		}
+
+		// reading the last page of a file can end prematurely, never hand out uninitialized memory
+		if (bytesRead < size)
+		{
+			std::memset(PDB::Pointer::Offset<void*>(destination, bytesRead), 0, size - bytesRead);
+		}
+	}
+#endif
+}
+
+
+// each shard holds a fixed number of page slots.
+// slots are linked into a doubly-linked LRU list (most-recently used at the head), and into singly-linked hash chains for lookup.
+// a slot whose page is being fetched is marked as loading. it is already part of the hash chains, but is never recycled or evicted
+// until the fetch has finished, and readers finding it wait until it has been loaded.
+struct PDB::BlockCache::Shard
+{
+	explicit Shard(const Allocator& shardAllocator) PDB_NO_EXCEPT
+		: allocator(shardAllocator)
+		, mutex()
+		, loaded()
+		, pages(nullptr)
+		, keys(nullptr)
+		, loading(nullptr)
+		, previous(nullptr)
+		, next(nullptr)
+		, chain(nullptr)
+		, buckets(nullptr)
+		, slotCount(0u)
+		, usedSlotCount(0u)
+		, bucketMask(0u)
+		, head(InvalidSlot)
+		, tail(InvalidSlot)
+	{
+	}
+
+	~Shard(void) PDB_NO_EXCEPT
+	{
+		FreeArray(allocator, pages);
+		FreeArray(allocator, keys);
+		FreeArray(allocator, loading);
+		FreeArray(allocator, previous);
+		FreeArray(allocator, next);
+		FreeArray(allocator, chain);
+		FreeArray(allocator, buckets);
+	}
+
+	void Initialize(uint32_t count, uint32_t pageSize) PDB_NO_EXCEPT
+	{
+		slotCount = count;
+
+		pages = AllocateArray<Byte>(allocator, static_cast<size_t>(count) * pageSize);
+		keys = AllocateArray<uint64_t>(allocator, count);
+		loading = AllocateArray<bool>(allocator, count);
+		previous = AllocateArray<uint32_t>(allocator, count);
+		next = AllocateArray<uint32_t>(allocator, count);
+		chain = AllocateArray<uint32_t>(allocator, count);
+
+		const uint32_t bucketCount = RoundUpToPowerOfTwo(count);
+		buckets = AllocateArray<uint32_t>(allocator, bucketCount);
+		bucketMask = bucketCount - 1u;
+
+		for (uint32_t i = 0u; i < count; ++i)
+		{
+			loading[i] = false;
+		}
+
+		for (uint32_t i = 0u; i < bucketCount; ++i)
+		{
+			buckets[i] = InvalidSlot;
+		}
+	}
+
+	PDB_NO_DISCARD uint32_t Find(uint64_t key, uint64_t hash) const PDB_NO_EXCEPT
+	{
+		uint32_t slot = buckets[hash & bucketMask];
+		while (slot != InvalidSlot)
+		{
+			if (keys[slot] == key)
+			{
+				return slot;
+			}
+
+			slot = chain[slot];
+		}
+
+		return InvalidSlot;
+	}
+
+	void UnlinkFromList(uint32_t slot) PDB_NO_EXCEPT
+	{
+		if (previous[slot] != InvalidSlot)
+		{
+			next[previous[slot]] = next[slot];
+		}
+		else
+		{
+			head = next[slot];
+		}
+
+		if (next[slot] != InvalidSlot)
+		{
+			previous[next[slot]] = previous[slot];
+		}
+		else
+		{
+			tail = previous[slot];
+		}
+	}
+
+	void LinkToFront(uint32_t slot) PDB_NO_EXCEPT
+	{
+		previous[slot] = InvalidSlot;
+		next[slot] = head;
+
+		if (head != InvalidSlot)
+		{
+			previous[head] = slot;
+		}
+		else
+		{
+			tail = slot;
+		}
+
+		head = slot;
+	}
+
+	void UnlinkFromChain(uint32_t slot) PDB_NO_EXCEPT
+	{
+		uint32_t* link = &buckets[HashKey(keys[slot]) & bucketMask];
+		while (*link != slot)
+		{
+			link = &chain[*link];
+		}
+
+		*link = chain[slot];
+	}
+
+	void LinkToBack(uint32_t slot) PDB_NO_EXCEPT
+	{
+		previous[slot] = tail;
+		next[slot] = InvalidSlot;
+
+		if (tail != InvalidSlot)
+		{
+			next[tail] = slot;
+		}
+		else
+		{
+			head = slot;
+		}
+
+		tail = slot;
+	}
+
+	void Evict(uint32_t slot) PDB_NO_EXCEPT
+	{
+		// slots that have been evicted explicitly are no longer part of any hash chain
+		if (keys[slot] != InvalidKey)
+		{
+			UnlinkFromChain(slot);
+		}
+
+		UnlinkFromList(slot);
+		keys[slot] = InvalidKey;
+	}
+
+	PDB_NO_DISCARD uint32_t Insert(uint64_t key, uint64_t hash) PDB_NO_EXCEPT
+	{
+		uint32_t slot = InvalidSlot;
+		if (usedSlotCount < slotCount)
+		{
+			// the shard still has never-used slots
+			slot = usedSlotCount;
+			++usedSlotCount;
+		}
+		else
+		{
+			// recycle the least-recently used slot that is not being loaded
+			slot = tail;
+			while ((slot != InvalidSlot) && loading[slot])
+			{
+				slot = previous[slot];
+			}
+
+			if (slot == InvalidSlot)
+			{
+				// all slots are being loaded
+				return InvalidSlot;
+			}
+
+			Evict(slot);
+		}
+
+		keys[slot] = key;
+		chain[slot] = buckets[hash & bucketMask];
+		buckets[hash & bucketMask] = slot;
+		LinkToFront(slot);
+
+		return slot;
+	}
+
+	const Allocator allocator;
+	std::mutex mutex;
+	std::condition_variable loaded;
+	Byte* pages;
+	uint64_t* keys;
+	bool* loading;
+	uint32_t* previous;
+	uint32_t* next;
+	uint32_t* chain;
+	uint32_t* buckets;
+	uint32_t slotCount;
+	uint32_t usedSlotCount;
+	uint32_t bucketMask;
+	uint32_t head;
+	uint32_t tail;
+
+	PDB_DISABLE_COPY_MOVE(Shard);
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockCache::BlockCache(size_t capacity, uint32_t pageSize, uint32_t shardCount) PDB_NO_EXCEPT
+	: BlockCache(capacity, pageSize, shardCount, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockCache::BlockCache(size_t capacity, uint32_t pageSize, uint32_t shardCount, const Allocator& allocator) PDB_NO_EXCEPT
+	: m_allocator(allocator)
+	, m_shards(nullptr)
+	, m_shardCount(shardCount)
+	, m_pageSize(pageSize)
+	, m_nextFileId(0u)
+{
+	PDB_ASSERT(shardCount != 0u, "A block cache needs at least one shard.");
+	PDB_ASSERT(pageSize != 0u, "Invalid page size.");
+
+	// every shard needs at least one slot, otherwise nothing could ever be read through it.
+	// small caches use fewer shards instead, so that the capacity is never exceeded by more than the single page every cache needs.
+	const size_t pageCount = (capacity / pageSize != 0u) ? capacity / pageSize : 1u;
+	if (pageCount < m_shardCount)
+	{
+		m_shardCount = static_cast<uint32_t>(pageCount);
+	}
+
+	const size_t slotsPerShard = pageCount / m_shardCount;
+
+	// shards hold a mutex and condition variable, and are therefore constructed in place
+	m_shards = static_cast<Shard*>(m_allocator.allocate(m_allocator.userData, sizeof(Shard) * m_shardCount, alignof(Shard)));
+	for (uint32_t i = 0u; i < m_shardCount; ++i)
+	{
+		new (m_shards + i) Shard(m_allocator);
+		m_shards[i].Initialize(static_cast<uint32_t>(slotsPerShard), pageSize);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockCache::~BlockCache(void) PDB_NO_EXCEPT
+{
+	for (uint32_t i = 0u; i < m_shardCount; ++i)
+	{
+		m_shards[i].~Shard();
+	}
+
+	m_allocator.free(m_allocator.userData, m_shards);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::BlockCache::RegisterFile(void) PDB_NO_EXCEPT
+{
+	// identifiers are never reused, so stale pages of a file that has been closed can never be mistaken for pages of a new file
+	return m_nextFileId.fetch_add(1u, std::memory_order_relaxed);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::BlockCache::EvictFile(uint32_t fileId) PDB_NO_EXCEPT
+{
+	for (uint32_t i = 0u; i < m_shardCount; ++i)
+	{
+		Shard& shard = m_shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		for (uint32_t slot = 0u; slot < shard.usedSlotCount; ++slot)
+		{
+			// slots that are being loaded are left alone. they are recycled like any other slot once loaded, and can never be
+			// mistaken for pages of another file because identifiers are never reused.
+			if ((shard.keys[slot] != InvalidKey) && !shard.loading[slot] && (static_cast<uint32_t>(shard.keys[slot] >> 32u) == fileId))
+			{
+				// the slot stays part of the LRU list, but is moved to its end so that it is recycled first
+				shard.Evict(slot);
+				shard.LinkToBack(slot);
+			}
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::BlockCache::Read(uint32_t fileId, BlockSource::ReadFunction readFunction, void* userData, void* destination, size_t size, size_t fileOffset) PDB_NO_EXCEPT
+{
+	while (size != 0u)
+	{
+		const uint32_t pageIndex = static_cast<uint32_t>(fileOffset / m_pageSize);
+		const size_t offsetWithinPage = fileOffset % m_pageSize;
+		const size_t bytesToCopy = (size < m_pageSize - offsetWithinPage) ? size : (m_pageSize - offsetWithinPage);
+
+		const uint64_t key = MakeKey(fileId, pageIndex);
+		const uint64_t hash = HashKey(key);
+		Shard& shard = m_shards[(hash >> 32u) % m_shardCount];
+		{
+			std::unique_lock<std::mutex> lock(shard.mutex);
+
+			uint32_t slot = InvalidSlot;
+			for (;;)
+			{
+				slot = shard.Find(key, hash);
+				if (slot != InvalidSlot)
+				{
+					if (shard.loading[slot])
+					{
+						// another reader is fetching the page. wait for it instead of reading the page twice.
+						// the shard is unlocked while waiting, so other pages of the shard can still be read.
+						shard.loaded.wait(lock);
+						continue;
+					}
+
+					// cache hit, mark the page as most-recently used
+					shard.UnlinkFromList(slot);
+					shard.LinkToFront(slot);
+
+					break;
+				}
+
+				slot = shard.Insert(key, hash);
+				if (slot == InvalidSlot)
+				{
+					// all slots of the shard are being loaded, wait until one of them can be recycled
+					shard.loaded.wait(lock);
+					continue;
+				}
+
+				// cache miss, fetch the whole page.
+				// the shard is unlocked while reading, so that misses of other pages of the shard are not serialized behind the I/O.
+				shard.loading[slot] = true;
+				lock.unlock();
+
+				readFunction(userData, shard.pages + static_cast<size_t>(slot) * m_pageSize, m_pageSize, static_cast<size_t>(pageIndex) * m_pageSize);
+
+				lock.lock();
+				shard.loading[slot] = false;
+				shard.loaded.notify_all();
+
+				break;
+			}
+
+			std::memcpy(destination, shard.pages + static_cast<size_t>(slot) * m_pageSize + offsetWithinPage, bytesToCopy);
+		}
+
+		destination = Pointer::Offset<void*>(destination, bytesToCopy);
+		fileOffset += bytesToCopy;
+		size -= bytesToCopy;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CachedBlockSource::CachedBlockSource(BlockCache& cache, BlockSource::ReadFunction readFunction, void* userData) PDB_NO_EXCEPT
+	: m_cache(&cache)
+	, m_fileId(cache.RegisterFile())
+	, m_readFunction(readFunction)
+	, m_userData(userData)
+{
+}
+
+
+#if PDB_PLATFORM_LINUX
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CachedBlockSource::CachedBlockSource(BlockCache& cache, int fileDescriptor) PDB_NO_EXCEPT
+	: CachedBlockSource(cache, &ReadFromFileDescriptor, reinterpret_cast<void*>(static_cast<intptr_t>(fileDescriptor)))
+{
+}
+#endif
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CachedBlockSource::~CachedBlockSource(void) PDB_NO_EXCEPT
+{
+	m_cache->EvictFile(m_fileId);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::BlockSource PDB::CachedBlockSource::GetBlockSource(void) const PDB_NO_EXCEPT
+{
+	return BlockSource(&CachedBlockSource::Read, const_cast<CachedBlockSource*>(this));
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::CachedBlockSource::Read(void* userData, void* destination, size_t size, size_t fileOffset) PDB_NO_EXCEPT
+{
+	const CachedBlockSource* source = static_cast<const CachedBlockSource*>(userData);
+	source->m_cache->Read(source->m_fileId, source->m_readFunction, source->m_userData, destination, size, fileOffset);
+}
@@ -0,0 +1,90 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <atomic>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_BlockSource.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	// a bounded cache of file pages that can be shared by any number of files.
+	// the cache is split into shards that are locked individually, each shard evicting its least-recently used pages first.
+	// missing pages are fetched without holding the shard's lock. concurrent readers of a page being fetched wait for that page only.
+	// the memory used by the cache is allocated once upon construction, no matter how many files are read through it.
+	// the pages never exceed the given capacity, except for caches smaller than a single page, which still hold one page.
+	// caches holding fewer pages than the given number of shards use one shard per page.
+	class PDB_NO_DISCARD BlockCache
+	{
+	public:
+		explicit BlockCache(size_t capacity, uint32_t pageSize = 4096u, uint32_t shardCount = 16u) PDB_NO_EXCEPT;
+
+		// Creates a cache whose pages and bookkeeping are allocated using the given allocator.
+		explicit BlockCache(size_t capacity, uint32_t pageSize, uint32_t shardCount, const Allocator& allocator) PDB_NO_EXCEPT;
+
+		~BlockCache(void) PDB_NO_EXCEPT;
+
+		// Returns a new identifier for a file whose pages are going to be cached.
+		PDB_NO_DISCARD uint32_t RegisterFile(void) PDB_NO_EXCEPT;
+
+		// Evicts all cached pages of a file.
+		void EvictFile(uint32_t fileId) PDB_NO_EXCEPT;
+
+		// Reads a number of bytes at the given offset into a file, fetching pages that are not cached yet using the given function.
+		void Read(uint32_t fileId, BlockSource::ReadFunction readFunction, void* userData, void* destination, size_t size, size_t fileOffset) PDB_NO_EXCEPT;
+
+		// Returns the size of a cached page.
+		PDB_NO_DISCARD inline uint32_t GetPageSize(void) const PDB_NO_EXCEPT
+		{
+			return m_pageSize;
+		}
+
+	private:
+		struct Shard;
+
+		Allocator m_allocator;
+		Shard* m_shards;
+		uint32_t m_shardCount;
+		uint32_t m_pageSize;
+		std::atomic<uint32_t> m_nextFileId;
+
+		PDB_DISABLE_COPY_MOVE(BlockCache);
+	};
+
+
+	// a block source that reads a file through a block cache.
+	// the file's pages are evicted from the cache once the source is destroyed.
+	class PDB_NO_DISCARD CachedBlockSource
+	{
+	public:
+		// Creates a source that fetches missing pages using the given function.
+		explicit CachedBlockSource(BlockCache& cache, BlockSource::ReadFunction readFunction, void* userData) PDB_NO_EXCEPT;
+
+#if PDB_PLATFORM_LINUX
+		// Creates a source that fetches missing pages from the given file descriptor using pread().
+		explicit CachedBlockSource(BlockCache& cache, int fileDescriptor) PDB_NO_EXCEPT;
+#endif
+
+		~CachedBlockSource(void) PDB_NO_EXCEPT;
+
+		// Returns a block source that can be used for creating a raw file.
+		// The returned source refers to this object, which therefore needs to outlive all raw files and streams created from it.
+		PDB_NO_DISCARD BlockSource GetBlockSource(void) const PDB_NO_EXCEPT;
+
+	private:
+		static void Read(void* userData, void* destination, size_t size, size_t fileOffset) PDB_NO_EXCEPT;
+
+		BlockCache* m_cache;
+		uint32_t m_fileId;
+		BlockSource::ReadFunction m_readFunction;
+		void* m_userData;
+
+		PDB_DISABLE_COPY_MOVE(CachedBlockSource);
+	};
+}
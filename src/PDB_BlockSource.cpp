@@ -0,0 +1,49 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_BlockSource.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockSource::BlockSource(void) PDB_NO_EXCEPT
+	: m_data(nullptr)
+	, m_fileDescriptor(-1)
+	, m_readFunction(nullptr)
+	, m_userData(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockSource::BlockSource(const void* data) PDB_NO_EXCEPT
+	: m_data(data)
+	, m_fileDescriptor(-1)
+	, m_readFunction(nullptr)
+	, m_userData(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockSource::BlockSource(const void* data, int fileDescriptor) PDB_NO_EXCEPT
+	: m_data(data)
+	, m_fileDescriptor(fileDescriptor)
+	, m_readFunction(nullptr)
+	, m_userData(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BlockSource::BlockSource(ReadFunction readFunction, void* userData) PDB_NO_EXCEPT
+	: m_data(nullptr)
+	, m_fileDescriptor(-1)
+	, m_readFunction(readFunction)
+	, m_userData(userData)
+{
+}
@@ -0,0 +1,71 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstring>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace PDB
+{
+	// provides the data of an MSF file to the streams reading from it.
+	// either wraps a memory-mapped view of the whole file, or a function that reads parts of the file on demand.
+	// trivial to copy, does not own any data.
+	class PDB_NO_DISCARD BlockSource
+	{
+	public:
+		// Reads a number of bytes at the given offset into the file.
+		// Must be thread-safe, because streams can be read concurrently.
+		typedef void (*ReadFunction)(void* userData, void* destination, size_t size, size_t fileOffset);
+
+		BlockSource(void) PDB_NO_EXCEPT;
+
+		// Creates a block source from a memory-mapped view of the whole file.
+		explicit BlockSource(const void* data) PDB_NO_EXCEPT;
+
+		// Creates a block source from a memory-mapped view of the whole file, along with the file descriptor backing the view.
+		explicit BlockSource(const void* data, int fileDescriptor) PDB_NO_EXCEPT;
+
+		// Creates a block source that reads data on demand using the given function.
+		explicit BlockSource(ReadFunction readFunction, void* userData) PDB_NO_EXCEPT;
+
+		PDB_DEFAULT_COPY_MOVE(BlockSource);
+
+		// Reads a number of bytes at the given offset into the file.
+		inline void Read(void* destination, size_t size, size_t fileOffset) const PDB_NO_EXCEPT
+		{
+			if (m_data)
+			{
+				std::memcpy(destination, Pointer::Offset<const void*>(m_data, fileOffset), size);
+			}
+			else
+			{
+				m_readFunction(m_userData, destination, size, fileOffset);
+			}
+		}
+
+		// Provides read-only access to the memory-mapped data, if any.
+		// Returns nullptr if the file is not memory-mapped, in which case all data must be read using Read().
+		PDB_NO_DISCARD inline const void* GetData(void) const PDB_NO_EXCEPT
+		{
+			return m_data;
+		}
+
+		// Returns the file descriptor backing the data, or -1 if unknown.
+		PDB_NO_DISCARD inline int GetFileDescriptor(void) const PDB_NO_EXCEPT
+		{
+			return m_fileDescriptor;
+		}
+
+	private:
+		const void* m_data;
+		int m_fileDescriptor;
+		ReadFunction m_readFunction;
+		void* m_userData;
+	};
+}
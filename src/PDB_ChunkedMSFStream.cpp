@@ -0,0 +1,294 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ChunkedMSFStream.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_Util.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_Assert.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstring>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::Cursor::Cursor(const ChunkedMSFStream& stream) PDB_NO_EXCEPT
+	: m_stream(&stream)
+	, m_spanIndex(0u)
+	, m_offsetWithinSpan(0u)
+	, m_offset(0u)
+	, m_ownedBuffer(nullptr)
+	, m_ownedBufferSize(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::Cursor::~Cursor(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_stream->m_allocator, m_ownedBuffer);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const void* PDB::ChunkedMSFStream::Cursor::Read(size_t size) PDB_NO_EXCEPT
+{
+	const void* data = Peek(size);
+	Skip(size);
+
+	return data;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const void* PDB::ChunkedMSFStream::Cursor::Peek(size_t size) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(size <= GetBytesLeft(), "Not enough data left to read.");
+
+	if (size == 0u)
+	{
+		return nullptr;
+	}
+
+	const Span* spans = m_stream->m_spans;
+	const Span& span = spans[m_spanIndex];
+	const size_t bytesLeftInSpan = span.size - m_offsetWithinSpan;
+	if (bytesLeftInSpan >= size)
+	{
+		// fast path, the data is contiguous in memory
+		return span.data + m_offsetWithinSpan;
+	}
+
+	// slower path, the data straddles at least one span boundary and needs to be gathered in the bounce buffer
+	Byte* buffer = m_inlineBuffer;
+	if (size > InlineBufferSize)
+	{
+		if (size > m_ownedBufferSize)
+		{
+			FreeArray(m_stream->m_allocator, m_ownedBuffer);
+			m_ownedBuffer = AllocateArray<Byte>(m_stream->m_allocator, size);
+			m_ownedBufferSize = size;
+		}
+
+		buffer = m_ownedBuffer;
+	}
+
+	std::memcpy(buffer, span.data + m_offsetWithinSpan, bytesLeftInSpan);
+
+	size_t bytesCopied = bytesLeftInSpan;
+	for (size_t i = m_spanIndex + 1u; bytesCopied != size; ++i)
+	{
+		const size_t bytesLeftToCopy = size - bytesCopied;
+		const size_t bytesToCopy = (bytesLeftToCopy < spans[i].size) ? bytesLeftToCopy : spans[i].size;
+
+		std::memcpy(buffer + bytesCopied, spans[i].data, bytesToCopy);
+		bytesCopied += bytesToCopy;
+	}
+
+	return buffer;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ChunkedMSFStream::Cursor::Skip(size_t size) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(size <= GetBytesLeft(), "Not enough data left to skip.");
+
+	m_offset += size;
+	m_offsetWithinSpan += size;
+
+	// advance to the span holding the new offset. the cursor never points at the end of a span, unless it reached the end of the stream.
+	const Span* spans = m_stream->m_spans;
+	const size_t spanCount = m_stream->m_spanCount;
+	while ((m_spanIndex + 1u < spanCount) && (m_offsetWithinSpan >= spans[m_spanIndex].size))
+	{
+		m_offsetWithinSpan -= spans[m_spanIndex].size;
+		++m_spanIndex;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ChunkedMSFStream::Cursor::Seek(size_t offset) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(offset <= m_stream->GetSize(), "Offset out of bounds.");
+
+	if (m_stream->m_spanCount == 0u)
+	{
+		return;
+	}
+
+	// binary search for the last span starting at or before the given offset
+	const Span* spans = m_stream->m_spans;
+	size_t first = 0u;
+	size_t count = m_stream->m_spanCount;
+	while (count > 1u)
+	{
+		const size_t half = count / 2u;
+		if (spans[first + half].offset <= offset)
+		{
+			first += half;
+			count -= half;
+		}
+		else
+		{
+			count = half;
+		}
+	}
+
+	m_spanIndex = first;
+	m_offsetWithinSpan = offset - spans[first].offset;
+	m_offset = offset;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::ChunkedMSFStream(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_spans(nullptr)
+	, m_spanCount(0u)
+	, m_ownedData(nullptr)
+	, m_size(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::ChunkedMSFStream(ChunkedMSFStream&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_spans(PDB_MOVE(other.m_spans))
+	, m_spanCount(PDB_MOVE(other.m_spanCount))
+	, m_ownedData(PDB_MOVE(other.m_ownedData))
+	, m_size(PDB_MOVE(other.m_size))
+{
+	other.m_spans = nullptr;
+	other.m_spanCount = 0u;
+	other.m_ownedData = nullptr;
+	other.m_size = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream& PDB::ChunkedMSFStream::operator=(ChunkedMSFStream&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_spans);
+		FreeArray(m_allocator, m_ownedData);
+
+		m_allocator = other.m_allocator;
+		m_spans = PDB_MOVE(other.m_spans);
+		m_spanCount = PDB_MOVE(other.m_spanCount);
+		m_ownedData = PDB_MOVE(other.m_ownedData);
+		m_size = PDB_MOVE(other.m_size);
+
+		other.m_spans = nullptr;
+		other.m_spanCount = 0u;
+		other.m_ownedData = nullptr;
+		other.m_size = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::ChunkedMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
+	: ChunkedMSFStream(BlockSource(data), blockSize, blockIndices, streamSize)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::ChunkedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
+	: ChunkedMSFStream(source, blockSize, blockIndices, streamSize, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::ChunkedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT
+	: m_allocator(allocator)
+	, m_spans(nullptr)
+	, m_spanCount(0u)
+	, m_ownedData(nullptr)
+	, m_size(streamSize)
+{
+	if (streamSize == 0u)
+	{
+		return;
+	}
+
+	const void* data = source.GetData();
+	if (!data)
+	{
+		// the data is not memory-mapped, so there is nothing to point into. read the whole stream into one span instead.
+		m_ownedData = AllocateArray<Byte>(m_allocator, streamSize);
+
+		const DirectMSFStream directStream(source, blockSize, blockIndices, streamSize);
+		directStream.ReadAtOffset(m_ownedData, streamSize, 0u);
+		ReportCopy(m_allocator, streamSize);
+
+		m_spans = AllocateArray<Span>(m_allocator, 1u);
+		m_spans[0] = Span { m_ownedData, 0u, streamSize };
+		m_spanCount = 1u;
+
+		return;
+	}
+
+	// count the runs of contiguous blocks first, so that all spans can be allocated at once
+	const uint32_t blockCount = ConvertSizeToBlockCount(streamSize, blockSize);
+
+	size_t runCount = 1u;
+	for (uint32_t i = 1u; i < blockCount; ++i)
+	{
+		if (blockIndices[i] != blockIndices[i - 1u] + 1u)
+		{
+			++runCount;
+		}
+	}
+
+	m_spans = AllocateArray<Span>(m_allocator, runCount);
+	m_spanCount = runCount;
+
+	// gather one span for each run
+	size_t spanIndex = 0u;
+	uint32_t runStart = 0u;
+	for (uint32_t i = 1u; i <= blockCount; ++i)
+	{
+		if ((i == blockCount) || (blockIndices[i] != blockIndices[i - 1u] + 1u))
+		{
+			const uint32_t offset = runStart * blockSize;
+			const uint32_t runSize = (i - runStart) * blockSize;
+			const uint32_t size = (offset + runSize > streamSize) ? streamSize - offset : runSize;
+
+			const size_t fileOffset = ConvertBlockIndexToFileOffset(blockIndices[runStart], blockSize);
+			m_spans[spanIndex] = Span { Pointer::Offset<const Byte*>(data, fileOffset), offset, size };
+
+			++spanIndex;
+			runStart = i;
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ChunkedMSFStream::~ChunkedMSFStream(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_spans);
+	FreeArray(m_allocator, m_ownedData);
+}
@@ -0,0 +1,134 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_Types.h"
+#include "PDB_BlockSource.h"
+#include "PDB_Allocator.h"
+
+
+// https://llvm.org/docs/PDB/index.html#the-msf-container
+// https://llvm.org/docs/PDB/MsfFile.html
+namespace PDB
+{
+	// provides zero-copy access to an MSF stream as a list of spans, one for each run of contiguous blocks.
+	// inherently thread-safe, the stream doesn't carry any internal offset or similar. sequential reads are performed by cursors.
+	// only gathers the spans upon construction, no data is copied.
+	// useful when all data of a stream is needed exactly once, in order, e.g. when hashing a stream or parsing its records.
+	class PDB_NO_DISCARD ChunkedMSFStream
+	{
+	public:
+		// a part of the stream that is contiguous in memory.
+		struct Span
+		{
+			const Byte* data;
+			uint32_t offset;			// offset of the span's data within the stream
+			uint32_t size;
+		};
+
+		// reads a chunked stream sequentially.
+		// hands out pointers directly into the spans of the stream. data straddling a span boundary is copied into a bounce buffer first.
+		// pointers handed out by a cursor are valid until the next call to any of its Read or Peek functions.
+		// not thread-safe, but any number of cursors can read from the same stream concurrently.
+		class PDB_NO_DISCARD Cursor
+		{
+		public:
+			explicit Cursor(const ChunkedMSFStream& stream) PDB_NO_EXCEPT;
+			~Cursor(void) PDB_NO_EXCEPT;
+
+			// Reads a number of bytes and advances the cursor.
+			PDB_NO_DISCARD const void* Read(size_t size) PDB_NO_EXCEPT;
+
+			// Reads a number of bytes without advancing the cursor.
+			PDB_NO_DISCARD const void* Peek(size_t size) PDB_NO_EXCEPT;
+
+			// Reads from the stream and advances the cursor.
+			template <typename T>
+			PDB_NO_DISCARD inline const T* Read(void) PDB_NO_EXCEPT
+			{
+				return static_cast<const T*>(Read(sizeof(T)));
+			}
+
+			// Reads from the stream without advancing the cursor.
+			template <typename T>
+			PDB_NO_DISCARD inline const T* Peek(void) PDB_NO_EXCEPT
+			{
+				return static_cast<const T*>(Peek(sizeof(T)));
+			}
+
+			// Advances the cursor without reading any data.
+			void Skip(size_t size) PDB_NO_EXCEPT;
+
+			// Moves the cursor to the given offset into the stream.
+			void Seek(size_t offset) PDB_NO_EXCEPT;
+
+			// Returns the offset of the cursor within the stream.
+			PDB_NO_DISCARD inline size_t GetOffset(void) const PDB_NO_EXCEPT
+			{
+				return m_offset;
+			}
+
+			// Returns the number of bytes left to read.
+			PDB_NO_DISCARD inline size_t GetBytesLeft(void) const PDB_NO_EXCEPT
+			{
+				return m_stream->GetSize() - m_offset;
+			}
+
+		private:
+			static const size_t InlineBufferSize = 256u;
+
+			const ChunkedMSFStream* m_stream;
+			size_t m_spanIndex;
+			size_t m_offsetWithinSpan;
+			size_t m_offset;
+
+			// bounce buffer for data straddling a span boundary, either the inline buffer or grown using the allocator of the stream
+			Byte* m_ownedBuffer;
+			size_t m_ownedBufferSize;
+			alignas(8) Byte m_inlineBuffer[InlineBufferSize];
+
+			PDB_DISABLE_COPY_MOVE(Cursor);
+		};
+
+		ChunkedMSFStream(void) PDB_NO_EXCEPT;
+		ChunkedMSFStream(ChunkedMSFStream&& other) PDB_NO_EXCEPT;
+		ChunkedMSFStream& operator=(ChunkedMSFStream&& other) PDB_NO_EXCEPT;
+
+		explicit ChunkedMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
+
+		// Creates a chunked stream from any block source.
+		// Spans can only point into memory-mapped data. If the source is not memory-mapped, the stream is read into a single owned span.
+		explicit ChunkedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
+
+		// Creates a chunked stream from any block source, allocating the spans and any owned data using the given allocator.
+		explicit ChunkedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT;
+
+		~ChunkedMSFStream(void) PDB_NO_EXCEPT;
+
+		// Returns the size of the stream.
+		PDB_NO_DISCARD inline size_t GetSize(void) const PDB_NO_EXCEPT
+		{
+			return m_size;
+		}
+
+		// Returns all spans of the stream, ordered by their offset.
+		PDB_NO_DISCARD inline ArrayView<Span> GetSpans(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Span>(m_spans, m_spanCount);
+		}
+
+	private:
+		Allocator m_allocator;
+		Span* m_spans;
+		size_t m_spanCount;
+
+		// only used if the stream could not point into memory-mapped data
+		Byte* m_ownedData;
+		uint32_t m_size;
+
+		PDB_DISABLE_COPY(ChunkedMSFStream);
+	};
+}
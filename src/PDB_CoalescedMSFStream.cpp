@@ -6,9 +6,15 @@
 #include "PDB_Util.h"
 #include "PDB_DirectMSFStream.h"
 #include "Foundation/PDB_PointerUtil.h"
-#include "Foundation/PDB_Memory.h"
 #include "Foundation/PDB_DisableWarningsPush.h"
 #include <cstring>
+#if PDB_SSE2
+#	include <emmintrin.h>
+#endif
+#if PDB_PLATFORM_LINUX
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
 #include "Foundation/PDB_DisableWarningsPop.h"
 
 
@@ -19,13 +25,33 @@ namespace
 	PDB_NO_DISCARD static bool AreBlockIndicesContiguous(const uint32_t* blockIndices, uint32_t blockSize, uint32_t streamSize) PDB_NO_EXCEPT
 	{
 		const uint32_t blockCount = PDB::ConvertSizeToBlockCount(streamSize, blockSize);
+		const uint32_t firstIndex = blockIndices[0];
+		uint32_t i = 0u;
 
-		// start with the first index, checking if all following indices are contiguous (N, N+1, N+2, ...)
-		uint32_t expectedIndex = blockIndices[0];
-		for (uint32_t i = 1u; i < blockCount; ++i)
+#if PDB_SSE2
+		// compare 8 indices per iteration against the expected indices (N+i, N+i+1, ..., N+i+7)
+		const __m128i increment = _mm_set1_epi32(8);
+		__m128i expectedLow = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(firstIndex)), _mm_setr_epi32(0, 1, 2, 3));
+		__m128i expectedHigh = _mm_add_epi32(expectedLow, _mm_set1_epi32(4));
+		for (/* nothing */; i + 8u <= blockCount; i += 8u)
 		{
-			++expectedIndex;
-			if (blockIndices[i] != expectedIndex)
+			const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockIndices + i));
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockIndices + i + 4u));
+			const __m128i equal = _mm_and_si128(_mm_cmpeq_epi32(low, expectedLow), _mm_cmpeq_epi32(high, expectedHigh));
+			if (_mm_movemask_epi8(equal) != 0xFFFF)
+			{
+				return false;
+			}
+
+			expectedLow = _mm_add_epi32(expectedLow, increment);
+			expectedHigh = _mm_add_epi32(expectedHigh, increment);
+		}
+#endif
+
+		// check the remaining indices, or all of them if SSE2 is not available
+		for (/* nothing */; i < blockCount; ++i)
+		{
+			if (blockIndices[i] != firstIndex + i)
 			{
 				return false;
 			}
@@ -33,15 +59,177 @@ namespace
 
 		return true;
 	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void CopyBlocks(PDB::Byte* destination, const PDB::BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
+	{
+		// copy full blocks first
+		const uint32_t fullBlockCount = streamSize / blockSize;
+		for (uint32_t i = 0u; i < fullBlockCount; ++i)
+		{
+			const uint32_t index = blockIndices[i];
+
+			// read one single block at the correct offset in the stream
+			const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
+			source.Read(destination, blockSize, fileOffset);
+
+			destination += blockSize;
+		}
+
+		// account for non-full blocks
+		const uint32_t remainingBytes = streamSize - (fullBlockCount * blockSize);
+		if (remainingBytes != 0u)
+		{
+			const uint32_t index = blockIndices[fullBlockCount];
+
+			// read remaining bytes at correct offset in the stream
+			const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
+			source.Read(destination, remainingBytes, fileOffset);
+		}
+	}
+
+
+	// size of the chunks handed to individual workers when copying blocks in parallel
+	static constexpr const uint32_t ParallelCopyChunkSize = 1024u * 1024u;
+
+
+	struct ParallelCopyData
+	{
+		PDB::Byte* destination;
+		const PDB::BlockSource* source;
+		const uint32_t* blockIndices;
+		uint32_t blockSize;
+		uint32_t streamSize;
+		uint32_t blocksPerChunk;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void CopyChunk(void* taskData, uint32_t chunkIndex) PDB_NO_EXCEPT
+	{
+		const ParallelCopyData* data = static_cast<const ParallelCopyData*>(taskData);
+
+		// each chunk consists of the same number of blocks, except the last one
+		const uint32_t firstBlock = chunkIndex * data->blocksPerChunk;
+		const uint32_t offset = firstBlock * data->blockSize;
+		const uint32_t chunkSize = data->blocksPerChunk * data->blockSize;
+		const uint32_t size = (data->streamSize - offset < chunkSize) ? data->streamSize - offset : chunkSize;
+
+		CopyBlocks(data->destination + offset, *data->source, data->blockSize, data->blockIndices + firstBlock, size);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void CopyBlocksParallel(PDB::Byte* destination, const PDB::BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const PDB::Executor& executor) PDB_NO_EXCEPT
+	{
+		// workers copy disjunct chunks of whole blocks, so that page faults on different parts of the file can be serviced concurrently
+		const uint32_t blocksPerChunk = (ParallelCopyChunkSize > blockSize) ? ParallelCopyChunkSize / blockSize : 1u;
+		const uint32_t blockCount = PDB::ConvertSizeToBlockCount(streamSize, blockSize);
+		const uint32_t chunkCount = (blockCount + blocksPerChunk - 1u) / blocksPerChunk;
+
+		ParallelCopyData data = { destination, &source, blockIndices, blockSize, streamSize, blocksPerChunk };
+		PDB::ParallelFor(executor, chunkCount, &CopyChunk, &data);
+	}
+
+
+#if PDB_PLATFORM_LINUX
+	// each run of contiguous blocks needs its own mapping, and the kernel limits the number of mappings per process (vm.max_map_count, 65530 by default).
+	// heavily fragmented streams are therefore copied instead of remapped.
+	static constexpr const uint32_t MaxRemappedRunCount = 8192u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static void* RemapBlocks(int fileDescriptor, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, size_t* remappedSize) PDB_NO_EXCEPT
+	{
+		// blocks can only be mapped individually if they start and end at page boundaries
+		const long pageSize = sysconf(_SC_PAGESIZE);
+		if ((pageSize <= 0) || ((blockSize % static_cast<uint32_t>(pageSize)) != 0u))
+		{
+			return nullptr;
+		}
+
+		// count the number of runs of contiguous blocks, each of which will be mapped in one go
+		const uint32_t blockCount = PDB::ConvertSizeToBlockCount(streamSize, blockSize);
+		uint32_t runCount = 1u;
+		for (uint32_t i = 1u; i < blockCount; ++i)
+		{
+			if (blockIndices[i] != blockIndices[i - 1u] + 1u)
+			{
+				++runCount;
+			}
+		}
+
+		if (runCount > MaxRemappedRunCount)
+		{
+			return nullptr;
+		}
+
+		// reserve a contiguous range of address space first, then replace it run by run with mappings of the file
+		const size_t size = static_cast<size_t>(blockCount) * blockSize;
+		void* reservation = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (reservation == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		uint32_t runStart = 0u;
+		for (uint32_t i = 1u; i <= blockCount; ++i)
+		{
+			if ((i != blockCount) && (blockIndices[i] == blockIndices[i - 1u] + 1u))
+			{
+				// still inside the current run
+				continue;
+			}
+
+			const size_t runSize = static_cast<size_t>(i - runStart) * blockSize;
+			const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(blockIndices[runStart], blockSize);
+			void* address = PDB::Pointer::Offset<void*>(reservation, static_cast<size_t>(runStart) * blockSize);
+
+			if (mmap(address, runSize, PROT_READ, MAP_SHARED | MAP_FIXED, fileDescriptor, static_cast<off_t>(fileOffset)) == MAP_FAILED)
+			{
+				munmap(reservation, size);
+
+				return nullptr;
+			}
+
+			runStart = i;
+		}
+
+		*remappedSize = size;
+
+		return reservation;
+	}
+#endif
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void ReleaseRemappedBlocks(const void* remappedData, size_t remappedSize) PDB_NO_EXCEPT
+	{
+#if PDB_PLATFORM_LINUX
+		munmap(const_cast<void*>(remappedData), remappedSize);
+#else
+		(void)remappedData;
+		(void)remappedSize;
+#endif
+	}
 }
 
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(void) PDB_NO_EXCEPT
-	: m_ownedData(nullptr)
+	: m_allocator(GetDefaultAllocator())
+	, m_ownedData(nullptr)
 	, m_data(nullptr)
 	, m_size(0u)
+	, m_remappedSize(0u)
+	, m_path(CoalescingPath::None)
 {
 }
 
@@ -49,13 +237,18 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(void) PDB_NO_EXCEPT
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(CoalescedMSFStream&& other) PDB_NO_EXCEPT
-	: m_ownedData(PDB_MOVE(other.m_ownedData))
+	: m_allocator(other.m_allocator)
+	, m_ownedData(PDB_MOVE(other.m_ownedData))
 	, m_data(PDB_MOVE(other.m_data))
 	, m_size(PDB_MOVE(other.m_size))
+	, m_remappedSize(PDB_MOVE(other.m_remappedSize))
+	, m_path(PDB_MOVE(other.m_path))
 {
 	other.m_ownedData = nullptr;
 	other.m_data = nullptr;
 	other.m_size = 0u;
+	other.m_remappedSize = 0u;
+	other.m_path = CoalescingPath::None;
 }
 
 
@@ -65,15 +258,25 @@ PDB::CoalescedMSFStream& PDB::CoalescedMSFStream::operator=(CoalescedMSFStream&&
 {
 	if (this != &other)
 	{
-		PDB_DELETE_ARRAY(m_ownedData);
+		FreeArray(m_allocator, m_ownedData);
 
+		if (m_path == CoalescingPath::Remapped)
+		{
+			ReleaseRemappedBlocks(m_data, m_remappedSize);
+		}
+
+		m_allocator = other.m_allocator;
 		m_ownedData = PDB_MOVE(other.m_ownedData);
 		m_data = PDB_MOVE(other.m_data);
 		m_size = PDB_MOVE(other.m_size);
+		m_remappedSize = PDB_MOVE(other.m_remappedSize);
+		m_path = PDB_MOVE(other.m_path);
 
 		other.m_ownedData = nullptr;
 		other.m_data = nullptr;
 		other.m_size = 0u;
+		other.m_remappedSize = 0u;
+		other.m_path = CoalescingPath::None;
 	}
 
 	return *this;
@@ -83,77 +286,134 @@ PDB::CoalescedMSFStream& PDB::CoalescedMSFStream::operator=(CoalescedMSFStream&&
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
-	: m_ownedData(nullptr)
+	: CoalescedMSFStream(BlockSource(data), blockSize, blockIndices, streamSize)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CoalescedMSFStream::CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
+	: CoalescedMSFStream(source, blockSize, blockIndices, streamSize, Executor { nullptr, nullptr }, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CoalescedMSFStream::CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Executor& executor) PDB_NO_EXCEPT
+	: CoalescedMSFStream(source, blockSize, blockIndices, streamSize, executor, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CoalescedMSFStream::CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT
+	: CoalescedMSFStream(source, blockSize, blockIndices, streamSize, Executor { nullptr, nullptr }, allocator)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::CoalescedMSFStream::CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Executor& executor, const Allocator& allocator) PDB_NO_EXCEPT
+	: m_allocator(allocator)
+	, m_ownedData(nullptr)
 	, m_data(nullptr)
 	, m_size(streamSize)
+	, m_remappedSize(0u)
+	, m_path(CoalescingPath::None)
 {
-	if (AreBlockIndicesContiguous(blockIndices, blockSize, streamSize))
+	if (streamSize == 0u)
+	{
+		return;
+	}
+
+	const void* data = source.GetData();
+	if (data && AreBlockIndicesContiguous(blockIndices, blockSize, streamSize))
 	{
 		// fast path, all block indices are contiguous, so we don't have to copy any data at all.
 		// instead, we directly point into the memory-mapped file at the correct offset.
 		const uint32_t index = blockIndices[0];
 		const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
 		m_data = Pointer::Offset<const Byte*>(data, fileOffset);
-	}
-	else
-	{
-		// slower path, we need to copy disjunct blocks into our own data array, block by block
-		m_ownedData = PDB_NEW_ARRAY(Byte, streamSize);
-		m_data = m_ownedData;
+		m_path = CoalescingPath::Contiguous;
 
-		Byte* destination = m_ownedData;
+		return;
+	}
 
-		// copy full blocks first
-		const uint32_t fullBlockCount = streamSize / blockSize;
-		for (uint32_t i = 0u; i < fullBlockCount; ++i)
+#if PDB_PLATFORM_LINUX
+	const int fileDescriptor = source.GetFileDescriptor();
+	if (fileDescriptor >= 0)
+	{
+		// still fast, disjunct blocks are stitched together by mapping them into one contiguous range of virtual memory.
+		// this neither copies any data nor duplicates resident memory, since the mappings share the page cache with the memory-mapped file.
+		const void* remappedData = RemapBlocks(fileDescriptor, blockSize, blockIndices, streamSize, &m_remappedSize);
+		if (remappedData)
 		{
-			const uint32_t index = blockIndices[i];
+			m_data = static_cast<const Byte*>(remappedData);
+			m_path = CoalescingPath::Remapped;
 
-			// read one single block at the correct offset in the stream
-			const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
-			const void* sourceData = Pointer::Offset<const void*>(data, fileOffset);
-			std::memcpy(destination, sourceData, blockSize);
-
-			destination += blockSize;
+			return;
 		}
+	}
+#endif
 
-		// account for non-full blocks
-		const uint32_t remainingBytes = streamSize - (fullBlockCount * blockSize);
-		if (remainingBytes != 0u)
-		{
-			const uint32_t index = blockIndices[fullBlockCount];
+	// slower path, we need to copy disjunct blocks into our own data array, block by block
+	m_ownedData = AllocateArray<Byte>(m_allocator, streamSize);
+	m_data = m_ownedData;
+	m_path = CoalescingPath::Copied;
 
-			// read remaining bytes at correct offset in the stream
-			const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
-			const void* sourceData = Pointer::Offset<const void*>(data, fileOffset);
-			std::memcpy(destination, sourceData, remainingBytes);
-		}
+	if (executor.parallelFor && (streamSize >= ParallelCopyThreshold))
+	{
+		CopyBlocksParallel(m_ownedData, source, blockSize, blockIndices, streamSize, executor);
+	}
+	else
+	{
+		CopyBlocks(m_ownedData, source, blockSize, blockIndices, streamSize);
 	}
+
+	ReportCopy(m_allocator, streamSize);
 }
 
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset) PDB_NO_EXCEPT
-	: m_ownedData(nullptr)
+	: m_allocator(directStream.GetAllocator())
+	, m_ownedData(nullptr)
 	, m_data(nullptr)
 	, m_size(size)
+	, m_remappedSize(0u)
+	, m_path(CoalescingPath::None)
 {
+	if (size == 0u)
+	{
+		return;
+	}
+
 	const uint32_t* const blockIndicesForOffset = directStream.GetBlockIndicesForOffset(offset);
 
-	if (AreBlockIndicesContiguous(blockIndicesForOffset, directStream.GetBlockSize(), size))
+	// the sub-range does not necessarily start at the beginning of a block, so the range of blocks to check must include the bytes in front of it
+	const uint32_t offsetWithinBlock = offset & (directStream.GetBlockSize() - 1u);
+
+	if (directStream.GetData() && AreBlockIndicesContiguous(blockIndicesForOffset, directStream.GetBlockSize(), offsetWithinBlock + size))
 	{
 		// fast path, all block indices inside the direct stream from (data + offset) to (data + offset + size) are contiguous
 		const size_t offsetWithinData = directStream.GetDataOffsetForOffset(offset);
 		m_data = Pointer::Offset<const Byte*>(directStream.GetData(), offsetWithinData);
+		m_path = CoalescingPath::Contiguous;
 	}
 	else
 	{
 		// slower path, we need to copy from disjunct blocks, which is performed by the direct stream
-		m_ownedData = PDB_NEW_ARRAY(Byte, size);
+		m_ownedData = AllocateArray<Byte>(m_allocator, size);
 		m_data = m_ownedData;
+		m_path = CoalescingPath::Copied;
 
 		directStream.ReadAtOffset(m_ownedData, size, offset);
+		ReportCopy(m_allocator, size);
 	}
 }
 
@@ -162,5 +422,10 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(const DirectMSFStream& directStream,
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::~CoalescedMSFStream(void) PDB_NO_EXCEPT
 {
-	PDB_DELETE_ARRAY(m_ownedData);
+	FreeArray(m_allocator, m_ownedData);
+
+	if (m_path == CoalescingPath::Remapped)
+	{
+		ReleaseRemappedBlocks(m_data, m_remappedSize);
+	}
 }
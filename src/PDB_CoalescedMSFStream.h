@@ -5,13 +5,26 @@
 
 #include "Foundation/PDB_Macros.h"
 #include "PDB_Types.h"
+#include "PDB_BlockSource.h"
+#include "PDB_Executor.h"
+#include "PDB_Allocator.h"
 
 
 // https://llvm.org/docs/PDB/index.html#the-msf-container
 // https://llvm.org/docs/PDB/MsfFile.html
 namespace PDB
 {
-	class PDB_NO_DISCARD DirectMSFStream;
+	class DirectMSFStream;
+
+
+	// describes how the data of a coalesced stream was made contiguous.
+	enum class PDB_NO_DISCARD CoalescingPath : uint8_t
+	{
+		None,				// the stream is empty
+		Contiguous,			// all blocks were already contiguous, the stream points into the memory-mapped data directly
+		Remapped,			// disjunct blocks were mapped into one contiguous range of virtual memory, no data was copied
+		Copied				// disjunct blocks were copied into an owned buffer
+	};
 
 
 	// provides access to a coalesced version of an MSF stream.
@@ -21,13 +34,32 @@ namespace PDB
 	class PDB_NO_DISCARD CoalescedMSFStream
 	{
 	public:
+		// Streams of at least this size are copied in parallel, if an executor is given.
+		static const uint32_t ParallelCopyThreshold = 8u * 1024u * 1024u;
+
 		CoalescedMSFStream(void) PDB_NO_EXCEPT;
 		CoalescedMSFStream(CoalescedMSFStream&& other) PDB_NO_EXCEPT;
 		CoalescedMSFStream& operator=(CoalescedMSFStream&& other) PDB_NO_EXCEPT;
 
 		explicit CoalescedMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
 
-		// Creates a coalesced stream from a direct stream at any offset.
+		// Creates a coalesced stream from any block source.
+		// If the source knows the file descriptor backing the data, disjunct blocks are mapped into one contiguous range of virtual memory
+		// instead of being copied. This is only supported on Linux, and only if the block size is a multiple of the page size.
+		// Blocks are copied in all other cases.
+		explicit CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
+
+		// Creates a coalesced stream from any block source, copying the disjunct blocks of large streams in parallel using the given executor.
+		// Streams smaller than ParallelCopyThreshold are copied on the calling thread, because the overhead would outweigh the gains.
+		explicit CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Executor& executor) PDB_NO_EXCEPT;
+
+		// Creates a coalesced stream from any block source, allocating the data of disjunct blocks using the given allocator.
+		explicit CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT;
+
+		// Creates a coalesced stream from any block source using the given executor and allocator.
+		explicit CoalescedMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Executor& executor, const Allocator& allocator) PDB_NO_EXCEPT;
+
+		// Creates a coalesced stream from a direct stream at any offset, using the direct stream's allocator.
 		explicit CoalescedMSFStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset) PDB_NO_EXCEPT;
 
 		~CoalescedMSFStream(void) PDB_NO_EXCEPT;
@@ -38,6 +70,18 @@ namespace PDB
 			return m_size;
 		}
 
+		// Returns the allocator used by the stream.
+		PDB_NO_DISCARD inline const Allocator& GetAllocator(void) const PDB_NO_EXCEPT
+		{
+			return m_allocator;
+		}
+
+		// Returns how the data of the stream was made contiguous.
+		PDB_NO_DISCARD inline CoalescingPath GetCoalescingPath(void) const PDB_NO_EXCEPT
+		{
+			return m_path;
+		}
+
 		// Provides read-only access to the data.
 		template <typename T>
 		PDB_NO_DISCARD inline const T* GetDataAtOffset(size_t offset) const PDB_NO_EXCEPT
@@ -46,14 +90,21 @@ namespace PDB
 		}
 
 	private:
+		Allocator m_allocator;
+
 		// contiguous, coalesced data, can be null
 		Byte* m_ownedData;
 
-		// either points to the owned data that has been copied from disjunct blocks, or points to the
-		// memory-mapped data directly in case all stream blocks are contiguous.
+		// either points to the owned data that has been copied from disjunct blocks, points to the
+		// memory-mapped data directly in case all stream blocks are contiguous, or points to the
+		// virtual memory range that disjunct blocks have been remapped into.
 		const Byte* m_data;
 		size_t m_size;
 
+		// size of the virtual memory range in case the blocks have been remapped
+		size_t m_remappedSize;
+		CoalescingPath m_path;
+
 		PDB_DISABLE_COPY(CoalescedMSFStream);
 	};
 }
@@ -205,6 +205,23 @@ PDB_NO_DISCARD PDB::CoalescedMSFStream PDB::DBIStream::CreateSymbolRecordStream(
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::CoalescedMSFStream PDB::DBIStream::CreateSymbolRecordStream(const RawFile& file, const Executor& executor) const PDB_NO_EXCEPT
+{
+	// the symbol record stream is usually the largest stream in the file, and benefits the most from being copied in parallel
+	return file.CreateCoalescedMSFStream(m_header.symbolRecordStreamIndex, executor);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::StreamCache::Handle PDB::DBIStream::AcquireSymbolRecordStream(StreamCache& cache) const PDB_NO_EXCEPT
+{
+	return cache.Acquire(m_header.symbolRecordStreamIndex);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::ImageSectionStream PDB::DBIStream::CreateImageSectionStream(const RawFile& file) const PDB_NO_EXCEPT
@@ -273,6 +290,18 @@ PDB_NO_DISCARD PDB::SectionContributionStream PDB::DBIStream::CreateSectionContr
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SectionMapStream PDB::DBIStream::CreateSectionMapStream(const RawFile& /* file */, const ImageSectionStream& imageSectionStream) const PDB_NO_EXCEPT
+{
+	// find the section map sub-stream
+	// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+	const uint32_t streamOffset = GetSectionMapSubstreamOffset(m_header);
+
+	return SectionMapStream(m_stream, m_header.sectionMapSize, streamOffset, imageSectionStream);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::ModuleInfoStream PDB::DBIStream::CreateModuleInfoStream(const RawFile& /* file */) const PDB_NO_EXCEPT
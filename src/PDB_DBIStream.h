@@ -13,7 +13,9 @@
 #include "PDB_GlobalSymbolStream.h"
 #include "PDB_SourceFileStream.h"
 #include "PDB_SectionContributionStream.h"
+#include "PDB_SectionMapStream.h"
 #include "PDB_ModuleInfoStream.h"
+#include "PDB_StreamCache.h"
 
 
 // PDB DBI Stream
@@ -37,11 +39,17 @@ namespace PDB
 		PDB_NO_DISCARD ErrorCode HasValidSectionContributionStream(const RawFile& file) const PDB_NO_EXCEPT;
 
 		PDB_NO_DISCARD CoalescedMSFStream CreateSymbolRecordStream(const RawFile& file) const PDB_NO_EXCEPT;
+		PDB_NO_DISCARD CoalescedMSFStream CreateSymbolRecordStream(const RawFile& file, const Executor& executor) const PDB_NO_EXCEPT;
+
+		// Returns the symbol record stream from the given cache, coalescing it only if no other caller did so already.
+		PDB_NO_DISCARD StreamCache::Handle AcquireSymbolRecordStream(StreamCache& cache) const PDB_NO_EXCEPT;
+
 		PDB_NO_DISCARD ImageSectionStream CreateImageSectionStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD PublicSymbolStream CreatePublicSymbolStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD GlobalSymbolStream CreateGlobalSymbolStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD SourceFileStream CreateSourceFileStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD SectionContributionStream CreateSectionContributionStream(const RawFile& file) const PDB_NO_EXCEPT;
+		PDB_NO_DISCARD SectionMapStream CreateSectionMapStream(const RawFile& file, const ImageSectionStream& imageSectionStream) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD ModuleInfoStream CreateModuleInfoStream(const RawFile& file) const PDB_NO_EXCEPT;
 
 	private:
@@ -89,6 +89,40 @@ namespace PDB
 			uint32_t relocationCrc;
 		};
 
+		// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+		struct SectionMapHeader
+		{
+			uint16_t count;									// number of segment descriptors
+			uint16_t logicalCount;							// number of logical segment descriptors
+		};
+
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/dbi/dbi.h#L332
+		struct SectionMapEntry
+		{
+			// bit layout of OMFSegDescFlags: 4 flag bits, 4 reserved bits, fSel and fAbs, 2 reserved bits, fGroup, and 3 reserved bits
+			enum class PDB_NO_DISCARD Flags : uint16_t
+			{
+				None = 0u,
+				Read = 1u << 0u,
+				Write = 1u << 1u,
+				Execute = 1u << 2u,
+				AddressIs32Bit = 1u << 3u,
+				IsSelector = 1u << 8u,
+				IsAbsoluteAddress = 1u << 9u,			// the frame is an absolute address rather than a section
+				IsGroup = 1u << 12u
+			};
+
+			Flags flags;
+			uint16_t overlay;
+			uint16_t group;
+			uint16_t frame;									// one-based index of the physical section
+			uint16_t sectionName;
+			uint16_t className;
+			uint32_t offset;								// offset of the logical segment within the physical section
+			uint32_t sectionLength;
+		};
+		PDB_DEFINE_BIT_OPERATORS(SectionMapEntry::Flags);
+
 		// https://llvm.org/docs/PDB/DbiStream.html#module-info-substream
 		struct ModuleInfo
 		{
@@ -124,6 +158,8 @@ namespace PDB
 				S_THUNK32 =			0x1102u,		// thunk start
 				S_BLOCK32 =			0x1103u,		// block start
 				S_LABEL32 =			0x1105u,		// code label
+				S_CONSTANT =		0x1107u,		// constant symbol
+				S_UDT =				0x1108u,		// user-defined type
 				S_LDATA32 =			0x110Cu,		// (static) local data
 				S_GDATA32 =			0x110Du,		// global data
 				S_PUB32 =			0x110Eu,		// public symbol
@@ -132,6 +168,7 @@ namespace PDB
 				S_LTHREAD32 =		0x1112u,		// (static) thread-local data
 				S_GTHREAD32 =		0x1113u,		// global thread-local data
 				S_PROCREF =			0x1125u,		// reference to function in any compiland
+				S_DATAREF =			0x1126u,		// reference to data in any compiland
 				S_LPROCREF =		0x1127u,		// local reference to function in any compiland
 				S_TRAMPOLINE =		0x112Cu,		// incremental linking trampoline
 				S_SEPCODE =			0x1132u,		// separated code (from the compiler)
@@ -162,6 +199,27 @@ namespace PDB
 				TrampolineBranchIsland
 			};
 
+			// binary annotations of S_INLINESITE records describe the code ranges and source lines of an inlined function, relative to the enclosing procedure.
+			// each opcode is followed by one or two compressed operands.
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4461
+			enum class PDB_NO_DISCARD BinaryAnnotationOpcode : uint32_t
+			{
+				Invalid = 0u,						// link time pdb contains PADDINGs
+				CodeOffset = 1u,					// param: new code offset
+				ChangeCodeOffsetBase = 2u,			// param: new code offset base
+				ChangeCodeOffset = 3u,				// param: code offset delta
+				ChangeCodeLength = 4u,				// param: length of the code
+				ChangeFile = 5u,					// param: file checksum offset of the new file
+				ChangeLineOffset = 6u,				// param: signed line offset delta
+				ChangeLineEndDelta = 7u,			// param: how many lines the statement spans
+				ChangeRangeKind = 8u,				// param: either 1 (statement) or 0 (expression)
+				ChangeColumnStart = 9u,				// param: new column start
+				ChangeColumnEndDelta = 10u,			// param: signed column end delta
+				ChangeCodeOffsetAndLineOffset = 11u,	// param: ((signed line delta << 4) | code offset delta), compressed
+				ChangeCodeLengthAndCodeOffset = 12u,	// param: length of the code, code offset delta
+				ChangeColumnEnd = 13u				// param: new column end
+			};
+
 			enum class PDB_NO_DISCARD TrampolineType : uint16_t
 			{
 				Incremental,
@@ -327,6 +385,31 @@ namespace PDB
 						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
 					} S_OBJNAME;
 
+					// UDTSYM in https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h
+					struct
+					{
+						uint32_t typeIndex;
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} S_UDT;
+
+					// CONSTSYM in https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h
+					// values >= LF_NUMERIC (0x8000) denote the kind of a numeric leaf that follows, in which case the name is stored after the leaf
+					struct
+					{
+						uint32_t typeIndex;
+						uint16_t value;
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} S_CONSTANT;
+
+					// REFSYM2 in https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h
+					struct
+					{
+						uint32_t sumName;
+						uint32_t symbolOffset;			// offset of the referenced symbol in the module's symbol stream
+						uint16_t moduleIndex;			// one-based index of the module containing the referenced symbol
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} S_PROCREF, S_LPROCREF, S_DATAREF;
+
 					struct
 					{
 						TrampolineType type;
@@ -427,9 +510,141 @@ namespace PDB
 						uint8_t flags;
 						PDB_FLEXIBLE_ARRAY_MEMBER(char, strings);
 					} S_ENVBLOCK;
+
+					// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4199
+					struct
+					{
+						uint32_t parent;
+						uint32_t end;
+						uint32_t inlinee;					// refers to a LF_FUNC_ID or LF_MFUNC_ID record in the IPI stream
+						PDB_FLEXIBLE_ARRAY_MEMBER(uint8_t, binaryAnnotations);
+					} S_INLINESITE;
+
+					// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4208
+					struct
+					{
+						uint32_t parent;
+						uint32_t end;
+						uint32_t inlinee;					// refers to a LF_FUNC_ID or LF_MFUNC_ID record in the IPI stream
+						uint32_t invocations;				// dynamic invocation count
+						PDB_FLEXIBLE_ARRAY_MEMBER(uint8_t, binaryAnnotations);
+					} S_INLINESITE2;
 #pragma pack(pop)
 				} data;
 			};
+
+
+			// C13 line information is stored in subsections following the symbols of a module stream.
+			// https://llvm.org/docs/PDB/ModiStream.html#the-c13-line-information-substream
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4560
+			enum class PDB_NO_DISCARD DebugSubsectionKind : uint32_t
+			{
+				S_IGNORE = 0x80000000u,				// if set, the subsection must be ignored
+				S_SYMBOLS = 0xF1u,
+				S_LINES = 0xF2u,
+				S_STRINGTABLE = 0xF3u,
+				S_FILECHECKSUMS = 0xF4u,
+				S_FRAMEDATA = 0xF5u,
+				S_INLINEELINES = 0xF6u,
+				S_CROSSSCOPEIMPORTS = 0xF7u,
+				S_CROSSSCOPEEXPORTS = 0xF8u,
+				S_IL_LINES = 0xF9u,
+				S_FUNC_MDTOKEN_MAP = 0xFAu,
+				S_TYPE_MDTOKEN_MAP = 0xFBu,
+				S_MERGED_ASSEMBLYINPUT = 0xFCu,
+				S_COFF_SYMBOL_RVA = 0xFDu
+			};
+
+			// subsections are aligned to 4 bytes, the size does not include the padding
+			struct DebugSubsectionHeader
+			{
+				DebugSubsectionKind kind;
+				uint32_t size;
+			};
+
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4601
+			enum class PDB_NO_DISCARD LinesFlags : uint16_t
+			{
+				None = 0u,
+				HasColumns = 1u << 0u
+			};
+			PDB_DEFINE_BIT_OPERATORS(LinesFlags);
+
+			// a DEBUG_S_LINES subsection starts with this header, followed by one or more blocks of lines, one block per file
+			struct LinesHeader
+			{
+				uint32_t sectionOffset;
+				uint16_t sectionIndex;
+				LinesFlags flags;
+				uint32_t codeSize;
+			};
+
+			// a block is followed by its lines, and optionally their columns
+			struct LinesFileBlockHeader
+			{
+				uint32_t fileChecksumOffset;		// offset of the file's entry in the DEBUG_S_FILECHKSMS subsection
+				uint32_t numLines;
+				uint32_t size;						// including this header
+			};
+
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4581
+			struct Line
+			{
+				uint32_t offset;					// offset relative to the section offset of the subsection
+				uint32_t linenumStart : 24;
+				uint32_t deltaLineEnd : 7;
+				uint32_t isStatement : 1;
+			};
+
+			struct Column
+			{
+				uint16_t start;
+				uint16_t end;
+			};
+
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4573
+			enum class PDB_NO_DISCARD ChecksumKind : uint8_t
+			{
+				None = 0u,
+				MD5 = 1u,
+				SHA1 = 2u,
+				SHA256 = 3u
+			};
+
+			// a DEBUG_S_FILECHKSMS subsection stores one of these per file, each followed by the checksum, and aligned to 4 bytes
+			struct FileChecksumHeader
+			{
+				uint32_t filenameOffset;			// offset of the file name in the /names stream
+				uint8_t checksumSize;
+				ChecksumKind checksumKind;
+				PDB_FLEXIBLE_ARRAY_MEMBER(uint8_t, checksum);
+			};
+
+			// a DEBUG_S_INLINEELINES subsection starts with this signature, followed by the source lines of all inlinees
+			// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4629
+			enum class PDB_NO_DISCARD InlineeSourceLineSignature : uint32_t
+			{
+				Normal = 0u,						// entries are stored as InlineeSourceLine
+				Extended = 1u						// entries are stored as InlineeSourceLineEx
+			};
+
+			// the line at which the source of an inlined function starts
+			struct InlineeSourceLine
+			{
+				uint32_t inlinee;					// refers to a LF_FUNC_ID or LF_MFUNC_ID record in the IPI stream
+				uint32_t fileChecksumOffset;		// offset of the file's entry in the DEBUG_S_FILECHKSMS subsection
+				uint32_t sourceLineNumber;
+			};
+
+			// an inlinee whose source is spread across several files
+			struct InlineeSourceLineEx
+			{
+				uint32_t inlinee;
+				uint32_t fileChecksumOffset;
+				uint32_t sourceLineNumber;
+				uint32_t extraFileCount;
+				PDB_FLEXIBLE_ARRAY_MEMBER(uint32_t, extraFileChecksumOffsets);
+			};
 		}
 	}
 }
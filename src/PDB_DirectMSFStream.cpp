@@ -3,6 +3,7 @@
 
 #include "PDB_PCH.h"
 #include "PDB_DirectMSFStream.h"
+#include "PDB_Util.h"
 #include "Foundation/PDB_PointerUtil.h"
 #include "Foundation/PDB_BitUtil.h"
 #include "Foundation/PDB_Assert.h"
@@ -14,8 +15,10 @@
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::DirectMSFStream::DirectMSFStream(void) PDB_NO_EXCEPT
-	: m_data(nullptr)
+	: m_source()
+	, m_allocator(GetDefaultAllocator())
 	, m_blockIndices(nullptr)
+	, m_runLengths(nullptr)
 	, m_blockSize(0u)
 	, m_size(0u)
 	, m_blockSizeLog2(0u)
@@ -23,11 +26,77 @@ PDB::DirectMSFStream::DirectMSFStream(void) PDB_NO_EXCEPT
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::DirectMSFStream::DirectMSFStream(DirectMSFStream&& other) PDB_NO_EXCEPT
+	: m_source(PDB_MOVE(other.m_source))
+	, m_allocator(other.m_allocator)
+	, m_blockIndices(PDB_MOVE(other.m_blockIndices))
+	, m_runLengths(PDB_MOVE(other.m_runLengths))
+	, m_blockSize(PDB_MOVE(other.m_blockSize))
+	, m_size(PDB_MOVE(other.m_size))
+	, m_blockSizeLog2(PDB_MOVE(other.m_blockSizeLog2))
+{
+	other.m_source = BlockSource();
+	other.m_blockIndices = nullptr;
+	other.m_runLengths = nullptr;
+	other.m_blockSize = 0u;
+	other.m_size = 0u;
+	other.m_blockSizeLog2 = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::DirectMSFStream& PDB::DirectMSFStream::operator=(DirectMSFStream&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_runLengths);
+
+		m_source = PDB_MOVE(other.m_source);
+		m_allocator = other.m_allocator;
+		m_blockIndices = PDB_MOVE(other.m_blockIndices);
+		m_runLengths = PDB_MOVE(other.m_runLengths);
+		m_blockSize = PDB_MOVE(other.m_blockSize);
+		m_size = PDB_MOVE(other.m_size);
+		m_blockSizeLog2 = PDB_MOVE(other.m_blockSizeLog2);
+
+		other.m_source = BlockSource();
+		other.m_blockIndices = nullptr;
+		other.m_runLengths = nullptr;
+		other.m_blockSize = 0u;
+		other.m_size = 0u;
+		other.m_blockSizeLog2 = 0u;
+	}
+
+	return *this;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::DirectMSFStream::DirectMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
-	: m_data(data)
+	: DirectMSFStream(BlockSource(data), blockSize, blockIndices, streamSize)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::DirectMSFStream::DirectMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
+	: DirectMSFStream(source, blockSize, blockIndices, streamSize, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::DirectMSFStream::DirectMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT
+	: m_source(source)
+	, m_allocator(allocator)
 	, m_blockIndices(blockIndices)
+	, m_runLengths(nullptr)
 	, m_blockSize(blockSize)
 	, m_size(streamSize)
 	, m_blockSizeLog2(BitUtil::FindFirstSetBit(blockSize))
@@ -36,6 +105,36 @@ PDB::DirectMSFStream::DirectMSFStream(const void* data, uint32_t blockSize, cons
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::DirectMSFStream::~DirectMSFStream(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_runLengths);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::DirectMSFStream::BuildContiguousRunMap(void) PDB_NO_EXCEPT
+{
+	const uint32_t blockCount = ConvertSizeToBlockCount(m_size, m_blockSize);
+	if (blockCount == 0u || m_runLengths)
+	{
+		return;
+	}
+
+	// walk the blocks back to front, so that each entry stores the number of contiguous blocks starting at that block
+	m_runLengths = AllocateArray<uint32_t>(m_allocator, blockCount);
+	m_runLengths[blockCount - 1u] = 1u;
+
+	for (uint32_t i = blockCount - 1u; i != 0u; --i)
+	{
+		const bool isContiguous = (m_blockIndices[i - 1u] + 1u == m_blockIndices[i]);
+		m_runLengths[i - 1u] = isContiguous ? m_runLengths[i] + 1u : 1u;
+	}
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t offset) const PDB_NO_EXCEPT
@@ -46,6 +145,28 @@ void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t o
 	size_t blockIndex = offset >> m_blockSizeLog2;
 	const size_t offsetWithinBlock = offset & (m_blockSize - 1u);
 
+	if (m_runLengths)
+	{
+		// read whole runs of contiguous blocks at once
+		size_t offsetWithinRun = offsetWithinBlock;
+		size_t bytesRead = 0u;
+		while (bytesRead != size)
+		{
+			const uint32_t runLength = m_runLengths[blockIndex];
+			const size_t offsetWithinData = (static_cast<size_t>(m_blockIndices[blockIndex]) << m_blockSizeLog2) + offsetWithinRun;
+			const size_t bytesLeftInRun = (static_cast<size_t>(runLength) << m_blockSizeLog2) - offsetWithinRun;
+			const size_t bytesToRead = (size - bytesRead < bytesLeftInRun) ? size - bytesRead : bytesLeftInRun;
+
+			m_source.Read(Pointer::Offset<void*>(destination, bytesRead), bytesToRead, offsetWithinData);
+
+			bytesRead += bytesToRead;
+			blockIndex += runLength;
+			offsetWithinRun = 0u;
+		}
+
+		return;
+	}
+
 	// work out the offset within the data based on the block indices
 	size_t offsetWithinData = (static_cast<size_t>(m_blockIndices[blockIndex]) << m_blockSizeLog2) + offsetWithinBlock;
 	const size_t bytesLeftInBlock = m_blockSize - offsetWithinBlock;
@@ -53,17 +174,13 @@ void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t o
 	if (bytesLeftInBlock >= size)
 	{
 		// fast path, all the data can be read in one go
-		const void* const sourceData = Pointer::Offset<const void*>(m_data, offsetWithinData);
-		std::memcpy(destination, sourceData, size);
+		m_source.Read(destination, size, offsetWithinData);
 	}
 	else
 	{
 		// slower path, data is scattered across several blocks.
 		// read remaining bytes in current block first.
-		{
-			const void* const sourceData = Pointer::Offset<const void*>(m_data, offsetWithinData);
-			std::memcpy(destination, sourceData, bytesLeftInBlock);
-		}
+		m_source.Read(destination, bytesLeftInBlock, offsetWithinData);
 
 		// read remaining bytes from blocks
 		size_t bytesLeftToRead = size - bytesLeftInBlock;
@@ -74,18 +191,17 @@ void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t o
 			offsetWithinData = static_cast<size_t>(m_blockIndices[blockIndex]) << m_blockSizeLog2;
 
 			void* const destinationData = Pointer::Offset<void*>(destination, size - bytesLeftToRead);
-			const void* const sourceData = Pointer::Offset<const void*>(m_data, offsetWithinData);
 
 			if (bytesLeftToRead > m_blockSize)
 			{
 				// copy a whole block at once
-				std::memcpy(destinationData, sourceData, m_blockSize);
+				m_source.Read(destinationData, m_blockSize, offsetWithinData);
 				bytesLeftToRead -= m_blockSize;
 			}
 			else
 			{
 				// copy remaining bytes
-				std::memcpy(destinationData, sourceData, bytesLeftToRead);
+				m_source.Read(destinationData, bytesLeftToRead, offsetWithinData);
 				bytesLeftToRead -= bytesLeftToRead;
 			}
 		}
@@ -93,6 +209,44 @@ void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t o
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const void* PDB::DirectMSFStream::GetMappedRun(size_t offset, size_t& size) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(offset < m_size, "Offset out of bounds.");
+
+	const void* data = m_source.GetData();
+	if (!data)
+	{
+		size = 0u;
+		return nullptr;
+	}
+
+	// find the number of blocks following the offset's block that directly follow each other in the file
+	const size_t blockIndex = offset >> m_blockSizeLog2;
+	const size_t blockCount = ConvertSizeToBlockCount(m_size, m_blockSize);
+
+	size_t runLength = 1u;
+	if (m_runLengths)
+	{
+		runLength = m_runLengths[blockIndex];
+	}
+	else
+	{
+		while ((blockIndex + runLength < blockCount) && (m_blockIndices[blockIndex + runLength - 1u] + 1u == m_blockIndices[blockIndex + runLength]))
+		{
+			++runLength;
+		}
+	}
+
+	const size_t runEnd = (blockIndex + runLength) << m_blockSizeLog2;
+	size = ((runEnd < m_size) ? runEnd : m_size) - offset;
+
+	const size_t offsetWithinData = (static_cast<size_t>(m_blockIndices[blockIndex]) << m_blockSizeLog2) + (offset & (m_blockSize - 1u));
+	return Pointer::Offset<const void*>(data, offsetWithinData);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD const uint32_t* PDB::DirectMSFStream::GetBlockIndicesForOffset(uint32_t offset) const PDB_NO_EXCEPT
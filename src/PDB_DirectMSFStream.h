@@ -7,6 +7,8 @@
 #include "Foundation/PDB_DisableWarningsPush.h"
 #include <cstdint>
 #include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_BlockSource.h"
+#include "PDB_Allocator.h"
 
 
 // https://llvm.org/docs/PDB/index.html#the-msf-container
@@ -17,17 +19,35 @@ namespace PDB
 	// inherently thread-safe, the stream doesn't carry any internal offset or similar.
 	// trivial to construct.
 	// slower individual reads, but pays off when not all data of a stream is needed.
+	// optionally builds a map of contiguous block runs, which turns reads spanning several consecutive blocks into one single read.
 	class PDB_NO_DISCARD DirectMSFStream
 	{
 	public:
 		DirectMSFStream(void) PDB_NO_EXCEPT;
 		explicit DirectMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
+		explicit DirectMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT;
 
-		PDB_DEFAULT_MOVE(DirectMSFStream);
+		// Creates a direct stream that allocates its run map using the given allocator.
+		explicit DirectMSFStream(const BlockSource& source, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize, const Allocator& allocator) PDB_NO_EXCEPT;
+
+		DirectMSFStream(DirectMSFStream&& other) PDB_NO_EXCEPT;
+		DirectMSFStream& operator=(DirectMSFStream&& other) PDB_NO_EXCEPT;
+
+		~DirectMSFStream(void) PDB_NO_EXCEPT;
+
+		// Precomputes the length of each run of contiguous blocks in the stream.
+		// Reads spanning several blocks of the same run are then carried out in one go instead of block by block.
+		// Costs 4 bytes per block of the stream.
+		void BuildContiguousRunMap(void) PDB_NO_EXCEPT;
 
 		// Reads a number of bytes from the stream.
 		void ReadAtOffset(void* destination, size_t size, size_t offset) const PDB_NO_EXCEPT;
 
+		// Returns a pointer directly into the memory-mapped data at the given offset, and stores the number of bytes that are contiguous
+		// in memory from there on, up to the end of the run of blocks containing the offset.
+		// Returns nullptr in case the stream is not memory-mapped.
+		PDB_NO_DISCARD const void* GetMappedRun(size_t offset, size_t& size) const PDB_NO_EXCEPT;
+
 		// Reads from the stream.
 		template <typename T>
 		PDB_NO_DISCARD inline T ReadAtOffset(size_t offset) const PDB_NO_EXCEPT
@@ -49,6 +69,18 @@ namespace PDB
 			return m_size;
 		}
 
+		// Returns the allocator used by the stream.
+		PDB_NO_DISCARD inline const Allocator& GetAllocator(void) const PDB_NO_EXCEPT
+		{
+			return m_allocator;
+		}
+
+		// Returns whether a map of contiguous block runs has been built for the stream.
+		PDB_NO_DISCARD inline bool HasContiguousRunMap(void) const PDB_NO_EXCEPT
+		{
+			return (m_runLengths != nullptr);
+		}
+
 	private:
 		friend class CoalescedMSFStream;
 
@@ -58,14 +90,16 @@ namespace PDB
 		// Returns the offset into the data that corresponds to the given offset.
 		PDB_NO_DISCARD size_t GetDataOffsetForOffset(uint32_t offset) const PDB_NO_EXCEPT;
 
-		// Provides read-only access to the memory-mapped data.
+		// Provides read-only access to the memory-mapped data, if any.
 		PDB_NO_DISCARD inline const void* GetData(void) const PDB_NO_EXCEPT
 		{
-			return m_data;
+			return m_source.GetData();
 		}
 
-		const void* m_data;
+		BlockSource m_source;
+		Allocator m_allocator;
 		const uint32_t* m_blockIndices;
+		uint32_t* m_runLengths;
 		uint32_t m_blockSize;
 		uint32_t m_size;
 		uint32_t m_blockSizeLog2;
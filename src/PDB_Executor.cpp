@@ -0,0 +1,113 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_Executor.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <atomic>
+#include <thread>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace
+{
+	// shared by all threads taking part in a single call to parallelFor
+	struct WorkQueue
+	{
+		std::atomic<uint32_t> nextIndex;
+		uint32_t count;
+		PDB::Executor::TaskFunction task;
+		void* taskData;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void ProcessWorkQueue(WorkQueue* queue) PDB_NO_EXCEPT
+	{
+		// grab one index after the other until all tasks have been handed out
+		for (;;)
+		{
+			const uint32_t index = queue->nextIndex.fetch_add(1u, std::memory_order_relaxed);
+			if (index >= queue->count)
+			{
+				return;
+			}
+
+			queue->task(queue->taskData, index);
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ParallelFor(const Executor& executor, uint32_t count, Executor::TaskFunction task, void* taskData) PDB_NO_EXCEPT
+{
+	if (executor.parallelFor)
+	{
+		executor.parallelFor(executor.userData, count, task, taskData);
+		return;
+	}
+
+	for (uint32_t i = 0u; i < count; ++i)
+	{
+		task(taskData, i);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ThreadExecutor::ThreadExecutor(uint32_t threadCount) PDB_NO_EXCEPT
+	: m_threadCount((threadCount != 0u) ? threadCount : 1u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::Executor PDB::ThreadExecutor::GetExecutor(void) const PDB_NO_EXCEPT
+{
+	return Executor { &ThreadExecutor::ParallelFor, const_cast<ThreadExecutor*>(this) };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ThreadExecutor::ParallelFor(void* userData, uint32_t count, Executor::TaskFunction task, void* taskData) PDB_NO_EXCEPT
+{
+	const ThreadExecutor* executor = static_cast<const ThreadExecutor*>(userData);
+
+	WorkQueue queue;
+	queue.nextIndex.store(0u, std::memory_order_relaxed);
+	queue.count = count;
+	queue.task = task;
+	queue.taskData = taskData;
+
+	// there is no point in spawning more threads than there are tasks
+	const uint32_t threadCount = (executor->m_threadCount < count) ? executor->m_threadCount : count;
+	if (threadCount <= 1u)
+	{
+		ProcessWorkQueue(&queue);
+		return;
+	}
+
+	// the calling thread is one of the workers, so one thread less needs to be spawned
+	const uint32_t spawnedThreadCount = threadCount - 1u;
+	std::thread* threads = PDB_NEW_ARRAY(std::thread, spawnedThreadCount);
+	for (uint32_t i = 0u; i < spawnedThreadCount; ++i)
+	{
+		threads[i] = std::thread(&ProcessWorkQueue, &queue);
+	}
+
+	ProcessWorkQueue(&queue);
+
+	for (uint32_t i = 0u; i < spawnedThreadCount; ++i)
+	{
+		threads[i].join();
+	}
+
+	PDB_DELETE_ARRAY(threads);
+}
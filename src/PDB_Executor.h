@@ -0,0 +1,58 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace PDB
+{
+	// distributes work across threads.
+	// the library never creates threads on its own. functions that can make use of several threads accept an executor instead,
+	// which allows plugging in any existing job system or thread pool.
+	struct Executor
+	{
+		// A single task, invoked once for every index.
+		typedef void (*TaskFunction)(void* taskData, uint32_t index);
+
+		// Invokes the task for all indices in [0, count), potentially in parallel.
+		// Must not return before all invocations have finished.
+		typedef void (*ParallelForFunction)(void* userData, uint32_t count, TaskFunction task, void* taskData);
+
+		ParallelForFunction parallelFor;
+		void* userData;
+	};
+
+
+	// Invokes the task for all indices in [0, count) using the given executor, or serially on the calling thread if the executor has no parallelFor function.
+	void ParallelFor(const Executor& executor, uint32_t count, Executor::TaskFunction task, void* taskData) PDB_NO_EXCEPT;
+
+
+	// a simple executor that spawns a number of threads for each call to parallelFor.
+	// the calling thread takes part in the work as well.
+	class PDB_NO_DISCARD ThreadExecutor
+	{
+	public:
+		explicit ThreadExecutor(uint32_t threadCount) PDB_NO_EXCEPT;
+
+		// Returns an executor that refers to this object.
+		PDB_NO_DISCARD Executor GetExecutor(void) const PDB_NO_EXCEPT;
+
+		// Returns the number of threads used, including the calling thread.
+		PDB_NO_DISCARD inline uint32_t GetThreadCount(void) const PDB_NO_EXCEPT
+		{
+			return m_threadCount;
+		}
+
+	private:
+		static void ParallelFor(void* userData, uint32_t count, Executor::TaskFunction task, void* taskData) PDB_NO_EXCEPT;
+
+		uint32_t m_threadCount;
+
+		PDB_DISABLE_COPY_MOVE(ThreadExecutor);
+	};
+}
@@ -0,0 +1,468 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_FunctionIndex.h"
+#include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
+#include "PDB_ModuleInfoStream.h"
+#include "PDB_ModuleSymbolStream.h"
+#include "PDB_PublicSymbolStream.h"
+#include "PDB_SectionContributionStream.h"
+#include "PDB_SectionContributionIndex.h"
+#include "PDB_DBITypes.h"
+#include "PDB_SortUtil.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#if PDB_SSE2
+#	include <emmintrin.h>
+#endif
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace
+{
+	// number of lookups that are interleaved when looking up a batch of RVAs
+	static constexpr const size_t LookupBatchSize = 16u;
+
+	// a function gathered while building the index
+	struct FunctionEntry
+	{
+		uint32_t rva;
+		uint32_t size;
+		uint32_t nameOffset;
+		uint32_t isPublic;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename F>
+	static void ForEachFunction(const PDB::RawFile& file, const PDB::ImageSectionStream& imageSectionStream, const PDB::ModuleInfoStream& moduleInfoStream,
+		const PDB::CoalescedMSFStream& symbolRecordStream, const PDB::PublicSymbolStream& publicSymbolStream, F&& functor) PDB_NO_EXCEPT
+	{
+		using namespace PDB;
+
+		// gather all procedures from the module streams, these know their size
+		for (const ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasSymbolStream())
+			{
+				continue;
+			}
+
+			const ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(file);
+			moduleSymbolStream.ForEachSymbol([&functor, &imageSectionStream](const CodeView::DBI::Record* record)
+			{
+				const CodeView::DBI::SymbolRecordKind kind = record->header.kind;
+				if (kind == CodeView::DBI::SymbolRecordKind::S_THUNK32)
+				{
+					const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_THUNK32.section, record->data.S_THUNK32.offset);
+					if (rva != 0u)
+					{
+						functor(rva, record->data.S_THUNK32.length, record->data.S_THUNK32.name, false);
+					}
+				}
+				else if ((kind == CodeView::DBI::SymbolRecordKind::S_LPROC32) || (kind == CodeView::DBI::SymbolRecordKind::S_GPROC32) ||
+					(kind == CodeView::DBI::SymbolRecordKind::S_LPROC32_ID) || (kind == CodeView::DBI::SymbolRecordKind::S_GPROC32_ID) ||
+					(kind == CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC) || (kind == CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC_ID))
+				{
+					// all procedure records share the same layout
+					const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+					if (rva != 0u)
+					{
+						functor(rva, record->data.S_GPROC32.codeSize, record->data.S_GPROC32.name, false);
+					}
+				}
+			});
+		}
+
+		// add all public functions. the ones that are already known from the modules are removed after sorting.
+		for (const uint32_t addressMapEntry : publicSymbolStream.GetAddressMap())
+		{
+			const CodeView::DBI::Record* record = publicSymbolStream.GetAddressMapRecord(symbolRecordStream, addressMapEntry);
+			if (!record || ((PDB_AS_UNDERLYING(record->data.S_PUB32.flags) & PDB_AS_UNDERLYING(CodeView::DBI::PublicSymbolFlags::Function)) == 0u))
+			{
+				continue;
+			}
+
+			const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_PUB32.section, record->data.S_PUB32.offset);
+			if (rva != 0u)
+			{
+				functor(rva, 0u, record->data.S_PUB32.name, true);
+			}
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static uint32_t BuildEytzingerLayout(const uint32_t* rvas, uint32_t count, uint32_t* eytzingerRVAs, uint32_t* eytzingerRanks, uint32_t nodeCount, uint32_t sortedIndex, uint32_t node) PDB_NO_EXCEPT
+	{
+		// an in-order traversal of the tree visits the nodes in sorted order.
+		// nodes beyond the last RVA pad the tree, and compare larger than any RVA we look up.
+		if (node <= nodeCount)
+		{
+			sortedIndex = BuildEytzingerLayout(rvas, count, eytzingerRVAs, eytzingerRanks, nodeCount, sortedIndex, 2u * node);
+
+			eytzingerRVAs[node] = (sortedIndex < count) ? rvas[sortedIndex] : 0xFFFFFFFFu;
+			eytzingerRanks[node] = (sortedIndex < count) ? sortedIndex : count;
+			++sortedIndex;
+
+			sortedIndex = BuildEytzingerLayout(rvas, count, eytzingerRVAs, eytzingerRanks, nodeCount, sortedIndex, 2u * node + 1u);
+		}
+
+		return sortedIndex;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FunctionIndex::FunctionIndex(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_rvas(nullptr)
+	, m_sizes(nullptr)
+	, m_nameOffsets(nullptr)
+	, m_names(nullptr)
+	, m_count(0u)
+	, m_eytzingerRVAs(nullptr)
+	, m_eytzingerRanks(nullptr)
+	, m_treeDepth(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FunctionIndex::FunctionIndex(FunctionIndex&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_rvas(PDB_MOVE(other.m_rvas))
+	, m_sizes(PDB_MOVE(other.m_sizes))
+	, m_nameOffsets(PDB_MOVE(other.m_nameOffsets))
+	, m_names(PDB_MOVE(other.m_names))
+	, m_count(PDB_MOVE(other.m_count))
+	, m_eytzingerRVAs(PDB_MOVE(other.m_eytzingerRVAs))
+	, m_eytzingerRanks(PDB_MOVE(other.m_eytzingerRanks))
+	, m_treeDepth(PDB_MOVE(other.m_treeDepth))
+{
+	other.m_rvas = nullptr;
+	other.m_sizes = nullptr;
+	other.m_nameOffsets = nullptr;
+	other.m_names = nullptr;
+	other.m_count = 0u;
+	other.m_eytzingerRVAs = nullptr;
+	other.m_eytzingerRanks = nullptr;
+	other.m_treeDepth = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FunctionIndex& PDB::FunctionIndex::operator=(FunctionIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_rvas);
+		FreeArray(m_allocator, m_sizes);
+		FreeArray(m_allocator, m_nameOffsets);
+		FreeArray(m_allocator, m_names);
+		FreeArray(m_allocator, m_eytzingerRVAs);
+		FreeArray(m_allocator, m_eytzingerRanks);
+
+		m_allocator = other.m_allocator;
+		m_rvas = PDB_MOVE(other.m_rvas);
+		m_sizes = PDB_MOVE(other.m_sizes);
+		m_nameOffsets = PDB_MOVE(other.m_nameOffsets);
+		m_names = PDB_MOVE(other.m_names);
+		m_count = PDB_MOVE(other.m_count);
+		m_eytzingerRVAs = PDB_MOVE(other.m_eytzingerRVAs);
+		m_eytzingerRanks = PDB_MOVE(other.m_eytzingerRanks);
+		m_treeDepth = PDB_MOVE(other.m_treeDepth);
+
+		other.m_rvas = nullptr;
+		other.m_sizes = nullptr;
+		other.m_nameOffsets = nullptr;
+		other.m_names = nullptr;
+		other.m_count = 0u;
+		other.m_eytzingerRVAs = nullptr;
+		other.m_eytzingerRanks = nullptr;
+		other.m_treeDepth = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FunctionIndex::FunctionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const ModuleInfoStream& moduleInfoStream,
+	const CoalescedMSFStream& symbolRecordStream, const PublicSymbolStream& publicSymbolStream, const SectionContributionStream& sectionContributionStream) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_rvas(nullptr)
+	, m_sizes(nullptr)
+	, m_nameOffsets(nullptr)
+	, m_names(nullptr)
+	, m_count(0u)
+	, m_eytzingerRVAs(nullptr)
+	, m_eytzingerRanks(nullptr)
+	, m_treeDepth(0u)
+{
+	// count the functions and the size of their names first, so that everything can be gathered into exact allocations
+	size_t count = 0u;
+	size_t namesSize = 0u;
+	ForEachFunction(file, imageSectionStream, moduleInfoStream, symbolRecordStream, publicSymbolStream, [&count, &namesSize](uint32_t, uint32_t, const char* name, bool)
+	{
+		++count;
+		namesSize += std::strlen(name) + 1u;
+	});
+
+	if (count == 0u)
+	{
+		return;
+	}
+
+	FunctionEntry* entries = AllocateArray<FunctionEntry>(m_allocator, count);
+	m_names = AllocateArray<char>(m_allocator, namesSize);
+	{
+		size_t index = 0u;
+		size_t nameOffset = 0u;
+		ForEachFunction(file, imageSectionStream, moduleInfoStream, symbolRecordStream, publicSymbolStream, [this, entries, &index, &nameOffset](uint32_t rva, uint32_t size, const char* name, bool isPublic)
+		{
+			const size_t nameSize = std::strlen(name) + 1u;
+			std::memcpy(m_names + nameOffset, name, nameSize);
+
+			entries[index++] = FunctionEntry { rva, size, static_cast<uint32_t>(nameOffset), isPublic ? 1u : 0u };
+			nameOffset += nameSize;
+		});
+	}
+
+	// the sort is stable, so procedures from the modules come first in case several functions share the same RVA
+	SortUtil::RadixSortByKey(m_allocator, entries, count, [](const FunctionEntry& entry) { return entry.rva; });
+
+	size_t uniqueCount = 1u;
+	for (size_t i = 1u; i < count; ++i)
+	{
+		if (entries[i].rva != entries[uniqueCount - 1u].rva)
+		{
+			entries[uniqueCount++] = entries[i];
+		}
+	}
+
+	count = uniqueCount;
+
+	// the size of a public function is the distance to the next function, limited by the end of the contribution holding it
+	const SectionContributionIndex contributionIndex(file, imageSectionStream, sectionContributionStream);
+	for (size_t i = 0u; i < count; ++i)
+	{
+		FunctionEntry& entry = entries[i];
+		if (!entry.isPublic)
+		{
+			continue;
+		}
+
+		uint64_t end = (i + 1u < count) ? entries[i + 1u].rva : 0x100000000ull;
+
+		const DBI::SectionContribution* contribution = contributionIndex.FindContribution(entry.rva);
+		if (contribution)
+		{
+			const uint64_t contributionEnd = static_cast<uint64_t>(imageSectionStream.ConvertSectionOffsetToRVA(contribution->section, contribution->offset)) + contribution->size;
+			end = (contributionEnd < end) ? contributionEnd : end;
+		}
+
+		// the size of the last function remains unknown without a contribution
+		entry.size = (end != 0x100000000ull) ? static_cast<uint32_t>(end - entry.rva) : 0u;
+	}
+
+	// store the columns
+	m_count = static_cast<uint32_t>(count);
+	m_rvas = AllocateArray<uint32_t>(m_allocator, count);
+	m_sizes = AllocateArray<uint32_t>(m_allocator, count);
+	m_nameOffsets = AllocateArray<uint32_t>(m_allocator, count);
+	for (size_t i = 0u; i < count; ++i)
+	{
+		m_rvas[i] = entries[i].rva;
+		m_sizes[i] = entries[i].size;
+		m_nameOffsets[i] = entries[i].nameOffset;
+	}
+
+	FreeArray(m_allocator, entries);
+
+	// build the search tree as a complete binary tree, so that every lookup takes the same number of steps
+	m_treeDepth = 1u;
+	while ((1ull << m_treeDepth) - 1u < count)
+	{
+		++m_treeDepth;
+	}
+
+	const uint32_t nodeCount = (1u << m_treeDepth) - 1u;
+	m_eytzingerRVAs = AllocateArray<uint32_t>(m_allocator, nodeCount + 1u);
+	m_eytzingerRanks = AllocateArray<uint32_t>(m_allocator, nodeCount + 1u);
+	m_eytzingerRVAs[0] = 0u;
+	m_eytzingerRanks[0] = m_count;
+	(void)BuildEytzingerLayout(m_rvas, m_count, m_eytzingerRVAs, m_eytzingerRanks, nodeCount, 0u, 1u);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FunctionIndex::~FunctionIndex(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_rvas);
+	FreeArray(m_allocator, m_sizes);
+	FreeArray(m_allocator, m_nameOffsets);
+	FreeArray(m_allocator, m_names);
+	FreeArray(m_allocator, m_eytzingerRVAs);
+	FreeArray(m_allocator, m_eytzingerRanks);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::FunctionIndex::Lookup(uint32_t rva) const PDB_NO_EXCEPT
+{
+	if (m_count == 0u)
+	{
+		return InvalidFunction;
+	}
+
+	// descend the tree, going right whenever the node's RVA is not larger than the one we're looking for
+	uint32_t node = 1u;
+	for (uint32_t level = 0u; level < m_treeDepth; ++level)
+	{
+		node = 2u * node + static_cast<uint32_t>(m_eytzingerRVAs[node] <= rva);
+	}
+
+	// the node we ended up at is the first node with a larger RVA, after stripping the trailing right turns
+	node >>= BitUtil::FindFirstSetBit(~node) + 1u;
+
+	// the rank of the node is the index of the first function starting after the RVA, so the function before it is our candidate
+	const uint32_t upperBound = m_eytzingerRanks[node];
+	if (upperBound == 0u)
+	{
+		return InvalidFunction;
+	}
+
+	const uint32_t functionIndex = upperBound - 1u;
+	return (rva - m_rvas[functionIndex] < m_sizes[functionIndex]) ? functionIndex : InvalidFunction;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::FunctionIndex::Lookup(const uint32_t* rvas, size_t count, uint32_t* functionIndices) const PDB_NO_EXCEPT
+{
+	if (m_count == 0u)
+	{
+		for (size_t i = 0u; i < count; ++i)
+		{
+			functionIndices[i] = InvalidFunction;
+		}
+
+		return;
+	}
+
+	// descend the tree for several RVAs in lockstep, so that their cache misses overlap
+	const uint32_t nodeMask = (1u << m_treeDepth) - 1u;
+	for (size_t first = 0u; first < count; first += LookupBatchSize)
+	{
+		const size_t batchCount = (count - first < LookupBatchSize) ? count - first : LookupBatchSize;
+		const uint32_t* batchRVAs = rvas + first;
+
+		uint32_t nodes[LookupBatchSize];
+		for (size_t i = 0u; i < batchCount; ++i)
+		{
+			nodes[i] = 1u;
+		}
+
+		for (uint32_t level = 0u; level < m_treeDepth; ++level)
+		{
+			for (size_t i = 0u; i < batchCount; ++i)
+			{
+				nodes[i] = 2u * nodes[i] + static_cast<uint32_t>(m_eytzingerRVAs[nodes[i]] <= batchRVAs[i]);
+
+#if PDB_SSE2
+				// the 16 descendants four levels down are stored next to each other, fetch them early
+				_mm_prefetch(reinterpret_cast<const char*>(m_eytzingerRVAs + ((16u * nodes[i]) & nodeMask)), _MM_HINT_T0);
+#endif
+			}
+		}
+
+		for (size_t i = 0u; i < batchCount; ++i)
+		{
+			const uint32_t node = nodes[i] >> (BitUtil::FindFirstSetBit(~nodes[i]) + 1u);
+			const uint32_t upperBound = m_eytzingerRanks[node];
+			const uint32_t functionIndex = upperBound - 1u;
+
+			functionIndices[first + i] = ((upperBound != 0u) && (batchRVAs[i] - m_rvas[functionIndex] < m_sizes[functionIndex])) ? functionIndex : InvalidFunction;
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::FunctionIndex::LookupSorted(const uint32_t* rvas, size_t count, uint32_t* functionIndices) const PDB_NO_EXCEPT
+{
+	if ((m_count == 0u) || (count == 0u))
+	{
+		for (size_t i = 0u; i < count; ++i)
+		{
+			functionIndices[i] = InvalidFunction;
+		}
+
+		return;
+	}
+
+	PDB_ASSERT(count <= 0xFFFFFFFFu, "Cannot look up more than 2^32 RVAs at once.");
+
+	// sort the RVAs along with their original position, so that results can be scattered back
+	uint64_t* keys = AllocateArray<uint64_t>(m_allocator, count);
+	for (size_t i = 0u; i < count; ++i)
+	{
+		keys[i] = (static_cast<uint64_t>(rvas[i]) << 32u) | static_cast<uint64_t>(i);
+	}
+
+	SortUtil::RadixSortByKey(m_allocator, keys, count, [](uint64_t key) { return static_cast<uint32_t>(key >> 32u); });
+
+	// walk both sorted sequences. the candidate is the last function starting at or before the current RVA.
+	uint32_t candidate = 0u;
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const uint32_t rva = static_cast<uint32_t>(keys[i] >> 32u);
+		const size_t position = static_cast<size_t>(keys[i] & 0xFFFFFFFFu);
+
+		// skip over functions using an exponential search, which is cheaper than a linear walk when RVAs are sparse
+		if ((candidate + 1u < m_count) && (m_rvas[candidate + 1u] <= rva))
+		{
+			uint32_t low = candidate + 1u;
+			uint32_t step = 1u;
+			while ((low + step < m_count) && (m_rvas[low + step] <= rva))
+			{
+				low += step;
+				step *= 2u;
+			}
+
+			// the candidate is in [low, min(low + step, count))
+			uint32_t high = (low + step < m_count) ? low + step : m_count;
+			while (high - low > 1u)
+			{
+				const uint32_t middle = low + (high - low) / 2u;
+				if (m_rvas[middle] <= rva)
+				{
+					low = middle;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+
+			candidate = low;
+		}
+
+		const bool isInside = (m_rvas[candidate] <= rva) && (rva - m_rvas[candidate] < m_sizes[candidate]);
+		functionIndices[position] = isInside ? candidate : InvalidFunction;
+	}
+
+	FreeArray(m_allocator, keys);
+}
@@ -0,0 +1,98 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class CoalescedMSFStream;
+	class ImageSectionStream;
+	class ModuleInfoStream;
+	class PublicSymbolStream;
+	class SectionContributionStream;
+
+
+	// an immutable index that maps RVAs to the functions containing them.
+	// functions are gathered from the procedure symbols of all module symbol streams, and completed by the public function symbols
+	// that none of the modules know about. the sizes of public functions are deduced from the next function and the section contributions.
+	// the start RVAs are stored in Eytzinger (breadth-first) order, which makes lookups branch-free and cache-friendly.
+	// the index is thread-safe, because it is never modified after construction.
+	class PDB_NO_DISCARD FunctionIndex
+	{
+	public:
+		static constexpr const uint32_t InvalidFunction = 0xFFFFFFFFu;
+
+		FunctionIndex(void) PDB_NO_EXCEPT;
+		FunctionIndex(FunctionIndex&& other) PDB_NO_EXCEPT;
+		FunctionIndex& operator=(FunctionIndex&& other) PDB_NO_EXCEPT;
+
+		// Builds the index from the given streams. All streams must have been validated before.
+		explicit FunctionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const ModuleInfoStream& moduleInfoStream,
+			const CoalescedMSFStream& symbolRecordStream, const PublicSymbolStream& publicSymbolStream, const SectionContributionStream& sectionContributionStream) PDB_NO_EXCEPT;
+
+		~FunctionIndex(void) PDB_NO_EXCEPT;
+
+		// Returns the index of the function containing the given RVA, or InvalidFunction in case no function contains it.
+		PDB_NO_DISCARD uint32_t Lookup(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Looks up the functions containing the given RVAs, storing one function index per RVA.
+		// Searches are interleaved, hiding the latency of cache misses for large batches.
+		void Lookup(const uint32_t* rvas, size_t count, uint32_t* functionIndices) const PDB_NO_EXCEPT;
+
+		// Looks up the functions containing the given RVAs, storing one function index per RVA.
+		// The RVAs are radix-sorted first, and then walked in lockstep with the functions, which never touches a function twice.
+		// Faster than Lookup() for batches with millions of RVAs, but allocates temporary memory proportional to the number of RVAs.
+		void LookupSorted(const uint32_t* rvas, size_t count, uint32_t* functionIndices) const PDB_NO_EXCEPT;
+
+		// Returns the number of functions in the index. Functions are sorted by their RVA.
+		PDB_NO_DISCARD inline uint32_t GetFunctionCount(void) const PDB_NO_EXCEPT
+		{
+			return m_count;
+		}
+
+		// Returns the RVA of the function with the given index.
+		PDB_NO_DISCARD inline uint32_t GetRVA(uint32_t functionIndex) const PDB_NO_EXCEPT
+		{
+			return m_rvas[functionIndex];
+		}
+
+		// Returns the size of the function with the given index.
+		PDB_NO_DISCARD inline uint32_t GetSize(uint32_t functionIndex) const PDB_NO_EXCEPT
+		{
+			return m_sizes[functionIndex];
+		}
+
+		// Returns the name of the function with the given index.
+		PDB_NO_DISCARD inline const char* GetName(uint32_t functionIndex) const PDB_NO_EXCEPT
+		{
+			return m_names + m_nameOffsets[functionIndex];
+		}
+
+	private:
+		Allocator m_allocator;
+
+		// columns, sorted by RVA
+		uint32_t* m_rvas;
+		uint32_t* m_sizes;
+		uint32_t* m_nameOffsets;
+		char* m_names;
+		uint32_t m_count;
+
+		// the RVAs and their rank in Eytzinger order, padded to a complete binary tree.
+		// element 0 is unused, its rank denotes that no RVA is larger than the one we're looking for.
+		uint32_t* m_eytzingerRVAs;
+		uint32_t* m_eytzingerRanks;
+		uint32_t m_treeDepth;
+
+		PDB_DISABLE_COPY(FunctionIndex);
+	};
+}
@@ -14,6 +14,7 @@ PDB::GlobalSymbolStream::GlobalSymbolStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_hashRecords(nullptr)
 	, m_count(0u)
+	, m_hashTable()
 {
 }
 
@@ -24,6 +25,7 @@ PDB::GlobalSymbolStream::GlobalSymbolStream(const RawFile& file, uint16_t stream
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
 	, m_hashRecords(m_stream.GetDataAtOffset<HashRecord>(sizeof(HashTableHeader)))
 	, m_count(count)
+	, m_hashTable(m_stream, 0u)
 {
 }
 
@@ -6,6 +6,7 @@
 #include "Foundation/PDB_Macros.h"
 #include "Foundation/PDB_ArrayView.h"
 #include "PDB_CoalescedMSFStream.h"
+#include "PDB_SymbolHashTable.h"
 
 
 namespace PDB
@@ -39,10 +40,26 @@ namespace PDB
 			return ArrayView<HashRecord>(m_hashRecords, m_count);
 		}
 
+		// Calls the given functor for each record with the given name.
+		// Only the records stored in the hash bucket the name hashes to are inspected.
+		template <typename F>
+		void FindRecordsByName(const CoalescedMSFStream& symbolRecordStream, const char* name, F&& functor) const PDB_NO_EXCEPT
+		{
+			for (const HashRecord& hashRecord : m_hashTable.GetBucketRecords(name))
+			{
+				const CodeView::DBI::Record* record = GetRecord(symbolRecordStream, hashRecord);
+				if (record && SymbolHashTable::HasName(record, name))
+				{
+					functor(record);
+				}
+			}
+		}
+
 	private:
 		CoalescedMSFStream m_stream;
 		const HashRecord* m_hashRecords;
 		uint32_t m_count;
+		SymbolHashTable m_hashTable;
 
 		PDB_DISABLE_COPY(GlobalSymbolStream);
 	};
@@ -6,7 +6,6 @@
 #include "PDB_RawFile.h"
 #include "PDB_Util.h"
 #include "PDB_DirectMSFStream.h"
-#include "Foundation/PDB_Memory.h"
 
 namespace
 {
@@ -45,7 +44,7 @@ PDB::IPIStream& PDB::IPIStream::operator=(IPIStream&& other) PDB_NO_EXCEPT
 {
 	if (this != &other)
 	{
-		PDB_DELETE_ARRAY(m_records);
+		FreeArray(m_stream.GetAllocator(), m_records);
 
 		m_header = PDB_MOVE(other.m_header);
 		m_stream = PDB_MOVE(other.m_stream);
@@ -72,7 +71,7 @@ PDB::IPIStream::IPIStream(const RawFile& file, const IPI::StreamHeader& header)
 	// however, the index is not stored with types in the IPI stream directly, but has to be built while walking the stream.
 	// similarly, because types are variable-length records, there are no direct offsets to access individual types.
 	// we therefore walk the IPI stream once, and store pointers to the records for trivial O(N) array lookup by index later.
-	m_records = PDB_NEW_ARRAY(const CodeView::IPI::Record*, m_recordCount);
+	m_records = AllocateArray<const CodeView::IPI::Record*>(m_stream.GetAllocator(), m_recordCount);
 
 	// ignore the stream's header
 	size_t offset = sizeof(IPI::StreamHeader);
@@ -98,7 +97,30 @@ PDB::IPIStream::IPIStream(const RawFile& file, const IPI::StreamHeader& header)
 // ------------------------------------------------------------------------------------------------
 PDB::IPIStream::~IPIStream(void) PDB_NO_EXCEPT
 {
-	PDB_DELETE_ARRAY(m_records);
+	FreeArray(m_stream.GetAllocator(), m_records);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const char* PDB::IPIStream::GetFunctionName(uint32_t functionId) const PDB_NO_EXCEPT
+{
+	const CodeView::IPI::Record* record = GetTypeRecord(functionId);
+	if (!record)
+	{
+		return nullptr;
+	}
+
+	if (record->header.kind == CodeView::IPI::TypeRecordKind::LF_FUNC_ID)
+	{
+		return record->data.LF_FUNC_ID.name;
+	}
+	else if (record->header.kind == CodeView::IPI::TypeRecordKind::LF_MFUNC_ID)
+	{
+		return record->data.LF_MFUNC_ID.name;
+	}
+
+	return nullptr;
 }
 
 
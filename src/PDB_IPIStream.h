@@ -46,6 +46,17 @@ namespace PDB
 			return ArrayView<const CodeView::IPI::Record*>(m_records, m_recordCount);
 		}
 
+		// Returns the type record with the given index, or nullptr in case the index doesn't belong to the stream.
+		PDB_NO_DISCARD inline const CodeView::IPI::Record* GetTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT
+		{
+			const uint32_t index = typeIndex - m_header.typeIndexBegin;
+			return (index < m_recordCount) ? m_records[index] : nullptr;
+		}
+
+		// Returns the name of the function with the given ID, as referenced by procedures and inline sites.
+		// Returns nullptr in case the ID doesn't refer to a LF_FUNC_ID or LF_MFUNC_ID record.
+		PDB_NO_DISCARD const char* GetFunctionName(uint32_t functionId) const PDB_NO_EXCEPT;
+
 	private:
 		IPI::StreamHeader m_header;
 		CoalescedMSFStream m_stream;
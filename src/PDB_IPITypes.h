@@ -86,6 +86,22 @@ namespace PDB
 				union Data
 				{
 #pragma pack(push, 1)
+					// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L1665
+					struct
+					{
+						uint32_t scopeId;		// parent scope of the function, or 0 for global functions
+						uint32_t typeIndex;		// function type in the TPI stream
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} LF_FUNC_ID;
+
+					// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L1673
+					struct
+					{
+						uint32_t parentTypeIndex;	// type containing the function in the TPI stream
+						uint32_t typeIndex;			// function type in the TPI stream
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} LF_MFUNC_ID;
+
 					// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L1694
 					struct
 					{
@@ -4,6 +4,99 @@
 #include "PDB_PCH.h"
 #include "PDB_ImageSectionStream.h"
 #include "PDB_RawFile.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#if PDB_AVX2
+#	include <immintrin.h>
+#	if PDB_COMPILER_MSVC
+#		include <intrin.h>
+#	endif
+#endif
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+namespace
+{
+	// used by streams without any sections, so that conversions never need to check for a missing table
+	static const uint32_t NoVirtualAddresses[1u] = { 0u };
+
+
+#if PDB_AVX2
+	// MSVC allows using AVX2 intrinsics anywhere, other compilers need to be told which functions use them
+#	if PDB_COMPILER_MSVC
+#		define PDB_TARGET_AVX2
+#	else
+#		define PDB_TARGET_AVX2				__attribute__((target("avx2")))
+#	endif
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool DetectAVX2(void) PDB_NO_EXCEPT
+	{
+#	if PDB_COMPILER_MSVC
+		// the CPU needs to support AVX2, and the OS needs to save the YMM registers on context switches
+		int registers[4] = {};
+		__cpuid(registers, 0);
+		if (registers[0] < 7)
+		{
+			return false;
+		}
+
+		__cpuid(registers, 1);
+		const bool hasOSXSAVE = ((registers[2] & (1 << 27)) != 0);
+		if (!hasOSXSAVE || ((_xgetbv(0) & 0x6u) != 0x6u))
+		{
+			return false;
+		}
+
+		__cpuidex(registers, 7, 0);
+
+		return ((registers[1] & (1 << 5)) != 0);
+#	else
+		// also checks whether the OS saves the YMM registers
+		return __builtin_cpu_supports("avx2");
+#	endif
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool HasAVX2(void) PDB_NO_EXCEPT
+	{
+		static const bool hasAVX2 = DetectAVX2();
+
+		return hasAVX2;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD PDB_TARGET_AVX2 static size_t ConvertSectionOffsetsToRVAsAVX2(const uint32_t* virtualAddresses, uint32_t sectionCount, const uint16_t* oneBasedSectionIndices,
+		const uint32_t* offsetsInSection, size_t count, uint32_t* rvas) PDB_NO_EXCEPT
+	{
+		// invalid sections are redirected to entry 0 of the table, and their RVAs are masked out afterwards.
+		// section indices are zero-extended to 32-bit, so signed comparisons are fine.
+		const __m256i maximumIndex = _mm256_set1_epi32(static_cast<int>(sectionCount));
+		const __m256i zero = _mm256_setzero_si256();
+
+		size_t i = 0u;
+		for (/* nothing */; i + 8u <= count; i += 8u)
+		{
+			const __m256i indices = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(oneBasedSectionIndices + i)));
+			const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsetsInSection + i));
+
+			const __m256i isInvalid = _mm256_or_si256(_mm256_cmpgt_epi32(indices, maximumIndex), _mm256_cmpeq_epi32(indices, zero));
+			const __m256i sectionVirtualAddresses = _mm256_i32gather_epi32(reinterpret_cast<const int*>(virtualAddresses), _mm256_andnot_si256(isInvalid, indices), 4);
+			const __m256i result = _mm256_andnot_si256(isInvalid, _mm256_add_epi32(sectionVirtualAddresses, offsets));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rvas + i), result);
+		}
+
+		// the remaining offsets are converted by the caller
+		return i;
+	}
+#endif
+}
 
 
 // ------------------------------------------------------------------------------------------------
@@ -12,7 +105,52 @@ PDB::ImageSectionStream::ImageSectionStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_headers(nullptr)
 	, m_count(0u)
+	, m_allocator(GetDefaultAllocator())
+	, m_ownedVirtualAddresses(nullptr)
+	, m_virtualAddresses(NoVirtualAddresses)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream::ImageSectionStream(ImageSectionStream&& other) PDB_NO_EXCEPT
+	: m_stream(PDB_MOVE(other.m_stream))
+	, m_headers(PDB_MOVE(other.m_headers))
+	, m_count(PDB_MOVE(other.m_count))
+	, m_allocator(other.m_allocator)
+	, m_ownedVirtualAddresses(PDB_MOVE(other.m_ownedVirtualAddresses))
+	, m_virtualAddresses(PDB_MOVE(other.m_virtualAddresses))
+{
+	other.m_headers = nullptr;
+	other.m_count = 0u;
+	other.m_ownedVirtualAddresses = nullptr;
+	other.m_virtualAddresses = NoVirtualAddresses;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream& PDB::ImageSectionStream::operator=(ImageSectionStream&& other) PDB_NO_EXCEPT
 {
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_ownedVirtualAddresses);
+
+		m_stream = PDB_MOVE(other.m_stream);
+		m_headers = PDB_MOVE(other.m_headers);
+		m_count = PDB_MOVE(other.m_count);
+		m_allocator = other.m_allocator;
+		m_ownedVirtualAddresses = PDB_MOVE(other.m_ownedVirtualAddresses);
+		m_virtualAddresses = PDB_MOVE(other.m_virtualAddresses);
+
+		other.m_headers = nullptr;
+		other.m_count = 0u;
+		other.m_ownedVirtualAddresses = nullptr;
+		other.m_virtualAddresses = NoVirtualAddresses;
+	}
+
+	return *this;
 }
 
 
@@ -22,7 +160,32 @@ PDB::ImageSectionStream::ImageSectionStream(const RawFile& file, uint16_t stream
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
 	, m_headers(m_stream.GetDataAtOffset<IMAGE_SECTION_HEADER>(0u))
 	, m_count(m_stream.GetSize() / sizeof(IMAGE_SECTION_HEADER))
+	, m_allocator(file.GetAllocator())
+	, m_ownedVirtualAddresses(nullptr)
+	, m_virtualAddresses(NoVirtualAddresses)
+{
+	if (m_count == 0u)
+	{
+		return;
+	}
+
+	// entry 0 is used for all invalid section indices
+	m_ownedVirtualAddresses = AllocateArray<uint32_t>(m_allocator, m_count + 1u);
+	m_ownedVirtualAddresses[0u] = 0u;
+	for (size_t i = 0u; i < m_count; ++i)
+	{
+		m_ownedVirtualAddresses[i + 1u] = m_headers[i].VirtualAddress;
+	}
+
+	m_virtualAddresses = m_ownedVirtualAddresses;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream::~ImageSectionStream(void) PDB_NO_EXCEPT
 {
+	FreeArray(m_allocator, m_ownedVirtualAddresses);
 }
 
 
@@ -45,3 +208,56 @@ PDB_NO_DISCARD uint32_t PDB::ImageSectionStream::ConvertSectionOffsetToRVA(uint1
 
 	return m_headers[oneBasedSectionIndex - 1u].VirtualAddress + offsetInSection;
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ImageSectionStream::ConvertSectionOffsetsToRVAs(const uint16_t* oneBasedSectionIndices, const uint32_t* offsetsInSection, size_t count, uint32_t* rvas) const PDB_NO_EXCEPT
+{
+	// section indices are 16-bit, so larger section counts do not matter
+	const uint32_t sectionCount = (m_count < 0xFFFFu) ? static_cast<uint32_t>(m_count) : 0xFFFFu;
+
+	size_t i = 0u;
+
+#if PDB_AVX2
+	if (HasAVX2())
+	{
+		i = ConvertSectionOffsetsToRVAsAVX2(m_virtualAddresses, sectionCount, oneBasedSectionIndices, offsetsInSection, count, rvas);
+	}
+#endif
+
+	for (/* nothing */; i < count; ++i)
+	{
+		// index 0 wraps around, and is therefore treated like any other index that is out of range.
+		// the mask is used for both the index and the result, which keeps compilers from introducing a branch.
+		const uint32_t index = oneBasedSectionIndices[i];
+		const uint32_t validMask = 0u - static_cast<uint32_t>(index - 1u < sectionCount);
+		const uint32_t virtualAddress = m_virtualAddresses[index & validMask];
+
+		rvas[i] = (virtualAddress + offsetsInSection[i]) & validMask;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::ImageSectionStream::ConvertRVAToSectionOffset(uint32_t rva, uint16_t& oneBasedSectionIndex, uint32_t& offsetInSection) const PDB_NO_EXCEPT
+{
+	// images only have a handful of sections, so a linear search is fast enough
+	for (size_t i = 0u; i < m_count; ++i)
+	{
+		const IMAGE_SECTION_HEADER& header = m_headers[i];
+
+		// sections can be larger in memory than on disk, and vice versa
+		const uint32_t size = (header.Misc.VirtualSize > header.SizeOfRawData) ? header.Misc.VirtualSize : header.SizeOfRawData;
+		if ((rva >= header.VirtualAddress) && (rva - header.VirtualAddress < size))
+		{
+			oneBasedSectionIndex = static_cast<uint16_t>(i + 1u);
+			offsetInSection = rva - header.VirtualAddress;
+
+			return true;
+		}
+	}
+
+	return false;
+}
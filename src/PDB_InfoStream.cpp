@@ -4,12 +4,16 @@
 #include "PDB_PCH.h"
 #include "PDB_InfoStream.h"
 #include "PDB_RawFile.h"
+#include "PDB_DirectMSFStream.h"
 
 
 namespace
 {
 	// the PDB info stream always resides at index 1
 	static constexpr const uint32_t InfoStreamIndex = 1u;
+
+	// name of the stream storing the file names referenced by line information
+	static constexpr const char* const NamesStreamName = "/names";
 }
 
 
@@ -18,6 +22,7 @@ namespace
 PDB::InfoStream::InfoStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_header(nullptr)
+	, m_namesStreamIndex(InvalidStreamIndex)
 	, m_usesDebugFastlink(false)
 {
 }
@@ -28,6 +33,7 @@ PDB::InfoStream::InfoStream(void) PDB_NO_EXCEPT
 PDB::InfoStream::InfoStream(const RawFile& file) PDB_NO_EXCEPT
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(InfoStreamIndex))
 	, m_header(m_stream.GetDataAtOffset<const Header>(0u))
+	, m_namesStreamIndex(InvalidStreamIndex)
 	, m_usesDebugFastlink(false)
 {
 	// the info stream starts with the header, followed by the named stream map, followed by the feature codes
@@ -52,7 +58,22 @@ PDB::InfoStream::InfoStream(const RawFile& file) PDB_NO_EXCEPT
 	//	"/LinkInfo"
 	//	"/TMCache"
 	//	"/names"
-	// however, none of those streams are of interest to us, so we just skip the whole hash table
+	// we are only interested in the "/names" stream, which is needed for resolving the file names of line information
+	const NamedStreamMap::HashTableEntry* entries = m_stream.GetDataAtOffset<const NamedStreamMap::HashTableEntry>(streamOffset);
+	for (uint32_t i = 0u; i < hashTableHeader->size; ++i)
+	{
+		const NamedStreamMap::HashTableEntry& entry = entries[i];
+		if (entry.stringTableOffset >= namedStreamMap->length)
+		{
+			continue;
+		}
+
+		if (std::strcmp(namedStreamMap->stringTable + entry.stringTableOffset, NamesStreamName) == 0)
+		{
+			m_namesStreamIndex = entry.streamIndex;
+		}
+	}
+
 	streamOffset += sizeof(NamedStreamMap::HashTableEntry) * hashTableHeader->size;
 
 	// read feature codes by consuming remaining bytes
@@ -69,3 +90,44 @@ PDB::InfoStream::InfoStream(const RawFile& file) PDB_NO_EXCEPT
 		}
 	}
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::InfoStream::HasValidNamesStream(const RawFile& file) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(HasNamesStream(), "PDB file does not have a /names stream.");
+
+	if (m_namesStreamIndex >= file.GetStreamCount())
+	{
+		return ErrorCode::InvalidStreamIndex;
+	}
+
+	DirectMSFStream namesStream = file.CreateMSFStream<DirectMSFStream>(m_namesStreamIndex);
+	if (namesStream.GetSize() < sizeof(NamesHeader))
+	{
+		return ErrorCode::InvalidSignature;
+	}
+
+	const NamesHeader header = namesStream.ReadAtOffset<NamesHeader>(0u);
+	if (header.signature != NamesHeader::Signature)
+	{
+		return ErrorCode::InvalidSignature;
+	}
+	else if ((header.hashVersion != 1u) && (header.hashVersion != 2u))
+	{
+		return ErrorCode::UnknownVersion;
+	}
+
+	return ErrorCode::Success;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::NamesStream PDB::InfoStream::CreateNamesStream(const RawFile& file) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(HasNamesStream(), "PDB file does not have a /names stream.");
+
+	return NamesStream(file, m_namesStreamIndex);
+}
@@ -4,8 +4,10 @@
 #pragma once
 
 #include "Foundation/PDB_Macros.h"
+#include "PDB_ErrorCodes.h"
 #include "PDB_Types.h"
 #include "PDB_CoalescedMSFStream.h"
+#include "PDB_NamesStream.h"
 
 
 namespace PDB
@@ -35,9 +37,24 @@ namespace PDB
 			return m_usesDebugFastlink;
 		}
 
+		// Returns whether the PDB file has a "/names" stream, which stores the file names referenced by line information.
+		PDB_NO_DISCARD inline bool HasNamesStream(void) const PDB_NO_EXCEPT
+		{
+			return (m_namesStreamIndex != InvalidStreamIndex);
+		}
+
+		// Validates the "/names" stream. The stream must exist.
+		PDB_NO_DISCARD ErrorCode HasValidNamesStream(const RawFile& file) const PDB_NO_EXCEPT;
+
+		// Creates the "/names" stream. The stream must have been validated before.
+		PDB_NO_DISCARD NamesStream CreateNamesStream(const RawFile& file) const PDB_NO_EXCEPT;
+
 	private:
+		static constexpr const uint32_t InvalidStreamIndex = 0xFFFFFFFFu;
+
 		CoalescedMSFStream m_stream;
 		const Header* m_header;
+		uint32_t m_namesStreamIndex;
 		bool m_usesDebugFastlink;
 
 		PDB_DISABLE_COPY(InfoStream);
@@ -3,7 +3,6 @@
 
 #include "PDB_PCH.h"
 #include "PDB_ModuleInfoStream.h"
-#include "Foundation/PDB_Memory.h"
 #include "Foundation/PDB_DisableWarningsPush.h"
 #include <cstring>
 #include "Foundation/PDB_DisableWarningsPop.h"
@@ -71,6 +70,27 @@ PDB_NO_DISCARD PDB::ModuleSymbolStream PDB::ModuleInfoStream::Module::CreateSymb
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::ModuleInfoStream::Module::HasLineStream(void) const PDB_NO_EXCEPT
+{
+	// modules without a symbol stream cannot have line information either.
+	// modules of old compilers might store C11 line information, which we don't support.
+	return HasSymbolStream() && (m_info->c13Size != 0u);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ModuleLineStream PDB::ModuleInfoStream::Module::CreateLineStream(const RawFile& file) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(HasLineStream(), "Module does not have C13 line information.");
+
+	// the C13 line information follows the symbols and the C11 line information
+	return ModuleLineStream(file, m_info->moduleSymbolStreamIndex, m_info->symbolSize + m_info->c11Size, m_info->c13Size);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::ModuleInfoStream::ModuleInfoStream(void) PDB_NO_EXCEPT
@@ -99,7 +119,7 @@ PDB::ModuleInfoStream& PDB::ModuleInfoStream::operator=(ModuleInfoStream&& other
 {
 	if (this != &other)
 	{
-		PDB_DELETE_ARRAY(m_modules);
+		FreeArray(m_stream.GetAllocator(), m_modules);
 
 		m_stream = PDB_MOVE(other.m_stream);
 		m_modules = PDB_MOVE(other.m_modules);
@@ -120,7 +140,7 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 	, m_modules(nullptr)
 	, m_moduleCount(0u)
 {
-	m_modules = PDB_NEW_ARRAY(Module, EstimateModuleCount(size));
+	m_modules = AllocateArray<Module>(m_stream.GetAllocator(), EstimateModuleCount(size));
 
 	size_t streamOffset = 0u;
 	while (streamOffset < size)
@@ -137,7 +157,7 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 		streamOffset += objectNameLength + 1u;
 
 		// the stream is aligned to 4 bytes
-		streamOffset = BitUtil::RoundUpToMultiple(streamOffset, 4ull);
+		streamOffset = BitUtil::RoundUpToMultiple<size_t>(streamOffset, 4u);
 
 		m_modules[m_moduleCount] = Module(moduleInfo, name, nameLength, objectName, objectNameLength);
 		++m_moduleCount;
@@ -149,7 +169,7 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 // ------------------------------------------------------------------------------------------------
 PDB::ModuleInfoStream::~ModuleInfoStream(void) PDB_NO_EXCEPT
 {
-	PDB_DELETE_ARRAY(m_modules);
+	FreeArray(m_stream.GetAllocator(), m_modules);
 }
 
 
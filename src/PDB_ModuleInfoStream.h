@@ -7,11 +7,12 @@
 #include "Foundation/PDB_ArrayView.h"
 #include "PDB_CoalescedMSFStream.h"
 #include "PDB_ModuleSymbolStream.h"
+#include "PDB_ModuleLineStream.h"
 
 
 namespace PDB
 {
-	class PDB_NO_DISCARD DirectMSFStream;
+	class DirectMSFStream;
 
 
 	class PDB_NO_DISCARD ModuleInfoStream
@@ -31,6 +32,18 @@ namespace PDB
 			// Creates a symbol stream for the module.
 			PDB_NO_DISCARD ModuleSymbolStream CreateSymbolStream(const RawFile& file) const PDB_NO_EXCEPT;
 
+			// Returns whether the module has C13 line information.
+			PDB_NO_DISCARD bool HasLineStream(void) const PDB_NO_EXCEPT;
+
+			// Creates a stream for the C13 line information of the module.
+			PDB_NO_DISCARD ModuleLineStream CreateLineStream(const RawFile& file) const PDB_NO_EXCEPT;
+
+			// Returns the info of the module as stored in the DBI stream.
+			PDB_NO_DISCARD inline const DBI::ModuleInfo& GetInfo(void) const PDB_NO_EXCEPT
+			{
+				return *m_info;
+			}
+
 			// Returns the name of the module.
 			PDB_NO_DISCARD inline ArrayView<char> GetName(void) const PDB_NO_EXCEPT
 			{
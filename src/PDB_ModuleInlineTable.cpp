@@ -0,0 +1,503 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ModuleInlineTable.h"
+#include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
+#include "PDB_IPIStream.h"
+#include "PDB_ModuleLineStream.h"
+#include "PDB_ModuleSymbolStream.h"
+#include "PDB_BinaryAnnotations.h"
+#include "PDB_DBITypes.h"
+#include "PDB_SortUtil.h"
+
+
+namespace
+{
+	static constexpr const uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+	// the line at which the source of an inlinee starts, gathered from the DEBUG_S_INLINEELINES subsections
+	struct InlineeEntry
+	{
+		uint32_t inlinee;
+		uint32_t lineNumber;
+		uint32_t fileChecksumOffset;
+	};
+
+	// an inline site, which is a node in the tree of inline sites of a procedure
+	struct SiteEntry
+	{
+		uint32_t parent;
+		uint32_t depth;
+		uint32_t inlinee;
+	};
+
+	// a code range of an inline site
+	struct PieceEntry
+	{
+		uint32_t start;
+		uint32_t end;
+		uint32_t site;
+		uint32_t lineNumber;
+		uint32_t filenameOffset;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool IsProcedure(PDB::CodeView::DBI::SymbolRecordKind kind) PDB_NO_EXCEPT
+	{
+		return (kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32) || (kind == PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32) ||
+			(kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32_ID) || (kind == PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32_ID) ||
+			(kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC) || (kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC_ID);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool IsInlineSite(PDB::CodeView::DBI::SymbolRecordKind kind) PDB_NO_EXCEPT
+	{
+		return (kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE) || (kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE2);
+	}
+
+
+	// sweeps over the elementary intervals in order, keeping track of the piece covering each inline depth.
+	// every piece is started and ended exactly once, no matter how many intervals it spans.
+	struct IntervalSweep
+	{
+		const PieceEntry* pieces;
+		const SiteEntry* sites;
+		const uint32_t* piecesByStart;
+		const uint32_t* piecesByEnd;
+		size_t pieceCount;
+		const uint32_t* boundaries;
+		size_t boundaryCount;
+
+		// the piece covering each inline depth in the current and the previous interval, or InvalidIndex
+		uint32_t* row;
+		uint32_t* previousRow;
+		size_t depthCount;
+
+		// Calls the functor with the start RVA and the row of every run of neighbouring intervals covered by the same pieces.
+		// The row of the last run is always empty, since all pieces end at or before the last boundary.
+		template <typename F>
+		void Run(F&& functor) const PDB_NO_EXCEPT
+		{
+			for (size_t depth = 0u; depth < depthCount; ++depth)
+			{
+				row[depth] = InvalidIndex;
+			}
+
+			size_t nextStart = 0u;
+			size_t nextEnd = 0u;
+			for (size_t boundary = 0u; boundary < boundaryCount; ++boundary)
+			{
+				const uint32_t rva = boundaries[boundary];
+
+				// end pieces first, so that a piece directly following another one at the same depth replaces it
+				for (; (nextEnd < pieceCount) && (pieces[piecesByEnd[nextEnd]].end <= rva); ++nextEnd)
+				{
+					const uint32_t piece = piecesByEnd[nextEnd];
+					const size_t depth = sites[pieces[piece].site].depth - 1u;
+					row[depth] = (row[depth] == piece) ? InvalidIndex : row[depth];
+				}
+
+				// empty pieces don't cover any interval
+				for (; (nextStart < pieceCount) && (pieces[piecesByStart[nextStart]].start <= rva); ++nextStart)
+				{
+					const uint32_t piece = piecesByStart[nextStart];
+					if (pieces[piece].start != pieces[piece].end)
+					{
+						row[sites[pieces[piece].site].depth - 1u] = piece;
+					}
+				}
+
+				if ((boundary == 0u) || (std::memcmp(row, previousRow, depthCount * sizeof(uint32_t)) != 0))
+				{
+					functor(rva, static_cast<const uint32_t*>(row));
+					std::memcpy(previousRow, row, depthCount * sizeof(uint32_t));
+				}
+			}
+		}
+	};
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleInlineTable::ModuleInlineTable(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_rvas(nullptr)
+	, m_stackOffsets(nullptr)
+	, m_stackDepths(nullptr)
+	, m_count(0u)
+	, m_frames(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleInlineTable::ModuleInlineTable(ModuleInlineTable&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_rvas(PDB_MOVE(other.m_rvas))
+	, m_stackOffsets(PDB_MOVE(other.m_stackOffsets))
+	, m_stackDepths(PDB_MOVE(other.m_stackDepths))
+	, m_count(PDB_MOVE(other.m_count))
+	, m_frames(PDB_MOVE(other.m_frames))
+{
+	other.m_rvas = nullptr;
+	other.m_stackOffsets = nullptr;
+	other.m_stackDepths = nullptr;
+	other.m_count = 0u;
+	other.m_frames = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleInlineTable& PDB::ModuleInlineTable::operator=(ModuleInlineTable&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_rvas);
+		FreeArray(m_allocator, m_stackOffsets);
+		FreeArray(m_allocator, m_stackDepths);
+		FreeArray(m_allocator, m_frames);
+
+		m_allocator = other.m_allocator;
+		m_rvas = PDB_MOVE(other.m_rvas);
+		m_stackOffsets = PDB_MOVE(other.m_stackOffsets);
+		m_stackDepths = PDB_MOVE(other.m_stackDepths);
+		m_count = PDB_MOVE(other.m_count);
+		m_frames = PDB_MOVE(other.m_frames);
+
+		other.m_rvas = nullptr;
+		other.m_stackOffsets = nullptr;
+		other.m_stackDepths = nullptr;
+		other.m_count = 0u;
+		other.m_frames = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleInlineTable::ModuleInlineTable(const RawFile& file, const ModuleSymbolStream& moduleSymbolStream, const ModuleLineStream& moduleLineStream,
+	const ImageSectionStream& imageSectionStream, const IPIStream& ipiStream) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_rvas(nullptr)
+	, m_stackOffsets(nullptr)
+	, m_stackDepths(nullptr)
+	, m_count(0u)
+	, m_frames(nullptr)
+{
+	// count the inline sites and their code ranges first, so that everything can be gathered into exact allocations
+	size_t siteCount = 0u;
+	size_t pieceCount = 0u;
+	size_t maximumScopeDepth = 0u;
+	{
+		size_t scopeDepth = 0u;
+		moduleSymbolStream.ForEachSymbol([&siteCount, &pieceCount, &maximumScopeDepth, &scopeDepth](const CodeView::DBI::Record* record)
+		{
+			const CodeView::DBI::SymbolRecordKind kind = record->header.kind;
+			if (IsScopeStartRecord(record))
+			{
+				++scopeDepth;
+				maximumScopeDepth = (scopeDepth > maximumScopeDepth) ? scopeDepth : maximumScopeDepth;
+			}
+			else if (IsScopeEndRecord(record))
+			{
+				scopeDepth -= (scopeDepth != 0u) ? 1u : 0u;
+			}
+
+			if (IsInlineSite(kind))
+			{
+				++siteCount;
+				ForEachInlineSiteRange(record, 0u, 0u, [&pieceCount](uint32_t, uint32_t, uint32_t, uint32_t)
+				{
+					++pieceCount;
+				});
+			}
+		});
+	}
+
+	if (pieceCount == 0u)
+	{
+		return;
+	}
+
+	// gather the lines inlinees start at, sorted by inlinee
+	size_t inlineeCount = 0u;
+	moduleLineStream.ForEachSection([&moduleLineStream, &inlineeCount](const CodeView::DBI::DebugSubsectionHeader* section)
+	{
+		if (section->kind == CodeView::DBI::DebugSubsectionKind::S_INLINEELINES)
+		{
+			moduleLineStream.ForEachInlineeLine(section, [&inlineeCount](const CodeView::DBI::InlineeSourceLine* /* line */)
+			{
+				++inlineeCount;
+			});
+		}
+	});
+
+	InlineeEntry* inlinees = AllocateArray<InlineeEntry>(m_allocator, inlineeCount);
+	uint32_t* inlineeIds = AllocateArray<uint32_t>(m_allocator, inlineeCount);
+	{
+		size_t index = 0u;
+		moduleLineStream.ForEachSection([&moduleLineStream, inlinees, &index](const CodeView::DBI::DebugSubsectionHeader* section)
+		{
+			if (section->kind == CodeView::DBI::DebugSubsectionKind::S_INLINEELINES)
+			{
+				moduleLineStream.ForEachInlineeLine(section, [inlinees, &index](const CodeView::DBI::InlineeSourceLine* line)
+				{
+					inlinees[index++] = InlineeEntry { line->inlinee, line->sourceLineNumber, line->fileChecksumOffset };
+				});
+			}
+		});
+
+		SortUtil::RadixSortByKey(m_allocator, inlinees, inlineeCount, [](const InlineeEntry& entry) { return entry.inlinee; });
+		for (size_t i = 0u; i < inlineeCount; ++i)
+		{
+			inlineeIds[i] = inlinees[i].inlinee;
+		}
+	}
+
+	// decode the code ranges of all inline sites. the scope stack stores the innermost inline site enclosing each scope, if any.
+	SiteEntry* sites = AllocateArray<SiteEntry>(m_allocator, siteCount);
+	PieceEntry* pieces = AllocateArray<PieceEntry>(m_allocator, pieceCount);
+	uint32_t* scopeSites = AllocateArray<uint32_t>(m_allocator, maximumScopeDepth);
+	size_t maximumSiteDepth = 0u;
+	siteCount = 0u;
+	pieceCount = 0u;
+	{
+		size_t scopeDepth = 0u;
+		uint32_t procedureRVA = 0u;
+		moduleSymbolStream.ForEachSymbol([&](const CodeView::DBI::Record* record)
+		{
+			const CodeView::DBI::SymbolRecordKind kind = record->header.kind;
+			if (IsScopeEndRecord(record))
+			{
+				scopeDepth -= (scopeDepth != 0u) ? 1u : 0u;
+				return;
+			}
+			else if (!IsScopeStartRecord(record))
+			{
+				return;
+			}
+
+			const uint32_t parentSite = (scopeDepth != 0u) ? scopeSites[scopeDepth - 1u] : InvalidIndex;
+			if (IsProcedure(kind))
+			{
+				procedureRVA = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+			}
+
+			if (!IsInlineSite(kind))
+			{
+				scopeSites[scopeDepth++] = parentSite;
+				return;
+			}
+
+			const uint32_t inlinee = (kind == CodeView::DBI::SymbolRecordKind::S_INLINESITE2) ? record->data.S_INLINESITE2.inlinee : record->data.S_INLINESITE.inlinee;
+			const uint32_t depth = (parentSite != InvalidIndex) ? sites[parentSite].depth + 1u : 1u;
+			maximumSiteDepth = (depth > maximumSiteDepth) ? depth : maximumSiteDepth;
+
+			const uint32_t site = static_cast<uint32_t>(siteCount++);
+			sites[site] = SiteEntry { parentSite, depth, inlinee };
+			scopeSites[scopeDepth++] = site;
+
+			if (procedureRVA == 0u)
+			{
+				// the code of the enclosing procedure has been discarded by the linker
+				return;
+			}
+
+			// without a source line for the inlinee, the ranges are still known, but their lines aren't
+			const uint32_t inlineeIndex = SortUtil::FindLastLessOrEqual(inlineeIds, static_cast<uint32_t>(inlineeCount), inlinee);
+			const bool hasLine = (inlineeIndex != SortUtil::InvalidIndex) && (inlineeIds[inlineeIndex] == inlinee) && moduleLineStream.HasFileChecksums();
+			const uint32_t baseLineNumber = hasLine ? inlinees[inlineeIndex].lineNumber : 0u;
+			const uint32_t baseFileChecksumOffset = hasLine ? inlinees[inlineeIndex].fileChecksumOffset : 0u;
+
+			ForEachInlineSiteRange(record, baseLineNumber, baseFileChecksumOffset, [&](uint32_t codeOffset, uint32_t codeLength, uint32_t lineNumber, uint32_t fileChecksumOffset)
+			{
+				const uint32_t filenameOffset = hasLine ? moduleLineStream.GetFileChecksumHeader(fileChecksumOffset)->filenameOffset : 0u;
+				pieces[pieceCount++] = PieceEntry { procedureRVA + codeOffset, procedureRVA + codeOffset + codeLength, site, hasLine ? lineNumber : InvalidLine, filenameOffset };
+			});
+		});
+	}
+
+	FreeArray(m_allocator, scopeSites);
+	FreeArray(m_allocator, inlineeIds);
+	FreeArray(m_allocator, inlinees);
+
+	if (pieceCount == 0u)
+	{
+		FreeArray(m_allocator, pieces);
+		FreeArray(m_allocator, sites);
+		return;
+	}
+
+	// the starts and ends of all pieces split the address space into elementary intervals, each of which is covered by the same pieces
+	uint32_t* boundaries = AllocateArray<uint32_t>(m_allocator, pieceCount * 2u);
+	for (size_t i = 0u; i < pieceCount; ++i)
+	{
+		boundaries[i * 2u + 0u] = pieces[i].start;
+		boundaries[i * 2u + 1u] = pieces[i].end;
+	}
+
+	SortUtil::RadixSortByKey(m_allocator, boundaries, pieceCount * 2u, [](uint32_t boundary) { return boundary; });
+
+	size_t boundaryCount = 1u;
+	for (size_t i = 1u; i < pieceCount * 2u; ++i)
+	{
+		if (boundaries[i] != boundaries[boundaryCount - 1u])
+		{
+			boundaries[boundaryCount++] = boundaries[i];
+		}
+	}
+
+	// sweep over the intervals, keeping track of the piece covering each inline depth, one column per depth
+	uint32_t* piecesByStart = AllocateArray<uint32_t>(m_allocator, pieceCount);
+	uint32_t* piecesByEnd = AllocateArray<uint32_t>(m_allocator, pieceCount);
+	for (size_t i = 0u; i < pieceCount; ++i)
+	{
+		piecesByStart[i] = static_cast<uint32_t>(i);
+		piecesByEnd[i] = static_cast<uint32_t>(i);
+	}
+
+	SortUtil::RadixSortByKey(m_allocator, piecesByStart, pieceCount, [pieces](uint32_t piece) { return pieces[piece].start; });
+	SortUtil::RadixSortByKey(m_allocator, piecesByEnd, pieceCount, [pieces](uint32_t piece) { return pieces[piece].end; });
+
+	uint32_t* row = AllocateArray<uint32_t>(m_allocator, maximumSiteDepth);
+	uint32_t* previousRow = AllocateArray<uint32_t>(m_allocator, maximumSiteDepth);
+	const IntervalSweep sweep = { pieces, sites, piecesByStart, piecesByEnd, pieceCount, boundaries, boundaryCount, row, previousRow, maximumSiteDepth };
+
+	// returns the innermost piece of a row, or InvalidIndex if no piece covers it
+	auto findInnermostPiece = [maximumSiteDepth](const uint32_t* pieceRow) -> uint32_t
+	{
+		for (size_t column = maximumSiteDepth; column > 0u; --column)
+		{
+			if (pieceRow[column - 1u] != InvalidIndex)
+			{
+				return pieceRow[column - 1u];
+			}
+		}
+
+		return InvalidIndex;
+	};
+
+	// neighbouring intervals covered by the same pieces form one range, and every run of ranges is ended with an empty one
+	size_t rangeCount = 0u;
+	size_t frameCount = 0u;
+	bool isInRange = false;
+	sweep.Run([&](uint32_t /* rva */, const uint32_t* pieceRow)
+	{
+		const uint32_t innermostPiece = findInnermostPiece(pieceRow);
+		if (innermostPiece != InvalidIndex)
+		{
+			++rangeCount;
+			frameCount += sites[pieces[innermostPiece].site].depth;
+			isInRange = true;
+		}
+		else if (isInRange)
+		{
+			++rangeCount;
+			isInRange = false;
+		}
+	});
+
+	// store the columns and stacks. the stack of a range follows the parents of its innermost site, picking the pieces
+	// of the enclosing sites from the same row.
+	m_count = static_cast<uint32_t>(rangeCount);
+	m_rvas = AllocateArray<uint32_t>(m_allocator, rangeCount);
+	m_stackOffsets = AllocateArray<uint32_t>(m_allocator, rangeCount);
+	m_stackDepths = AllocateArray<uint32_t>(m_allocator, rangeCount);
+	m_frames = AllocateArray<Frame>(m_allocator, frameCount);
+
+	rangeCount = 0u;
+	frameCount = 0u;
+	isInRange = false;
+	sweep.Run([&](uint32_t rva, const uint32_t* pieceRow)
+	{
+		const uint32_t innermostPiece = findInnermostPiece(pieceRow);
+		if (innermostPiece != InvalidIndex)
+		{
+			const uint32_t depth = sites[pieces[innermostPiece].site].depth;
+
+			m_rvas[rangeCount] = rva;
+			m_stackOffsets[rangeCount] = static_cast<uint32_t>(frameCount);
+			m_stackDepths[rangeCount] = depth;
+
+			uint32_t site = pieces[innermostPiece].site;
+			for (uint32_t column = depth; column > 0u; --column)
+			{
+				const uint32_t piece = pieceRow[column - 1u];
+				const bool isPieceOfSite = (piece != InvalidIndex) && (pieces[piece].site == site);
+
+				m_frames[frameCount + column - 1u] = Frame { sites[site].inlinee, ipiStream.GetFunctionName(sites[site].inlinee),
+					isPieceOfSite ? pieces[piece].lineNumber : InvalidLine, isPieceOfSite ? pieces[piece].filenameOffset : 0u };
+
+				site = sites[site].parent;
+			}
+
+			frameCount += depth;
+			++rangeCount;
+			isInRange = true;
+		}
+		else if (isInRange)
+		{
+			m_rvas[rangeCount] = rva;
+			m_stackOffsets[rangeCount] = static_cast<uint32_t>(frameCount);
+			m_stackDepths[rangeCount] = 0u;
+
+			++rangeCount;
+			isInRange = false;
+		}
+	});
+
+	FreeArray(m_allocator, previousRow);
+	FreeArray(m_allocator, row);
+	FreeArray(m_allocator, piecesByEnd);
+	FreeArray(m_allocator, piecesByStart);
+	FreeArray(m_allocator, boundaries);
+	FreeArray(m_allocator, pieces);
+	FreeArray(m_allocator, sites);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleInlineTable::~ModuleInlineTable(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_rvas);
+	FreeArray(m_allocator, m_stackOffsets);
+	FreeArray(m_allocator, m_stackDepths);
+	FreeArray(m_allocator, m_frames);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleInlineTable::Lookup(uint32_t rva) const PDB_NO_EXCEPT
+{
+	// find the last range starting at or before the RVA
+	const uint32_t rangeIndex = SortUtil::FindLastLessOrEqual(m_rvas, m_count, rva);
+
+	return ((rangeIndex != SortUtil::InvalidIndex) && (m_stackDepths[rangeIndex] != 0u)) ? rangeIndex : InvalidRange;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ModuleInlineTable::Lookup(const uint32_t* rvas, size_t count, uint32_t* rangeIndices) const PDB_NO_EXCEPT
+{
+	SortUtil::FindLastLessOrEqual(m_rvas, m_count, rvas, count, rangeIndices);
+
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const uint32_t rangeIndex = rangeIndices[i];
+		rangeIndices[i] = ((rangeIndex != SortUtil::InvalidIndex) && (m_stackDepths[rangeIndex] != 0u)) ? rangeIndex : InvalidRange;
+	}
+}
@@ -0,0 +1,95 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ImageSectionStream;
+	class IPIStream;
+	class ModuleLineStream;
+	class ModuleSymbolStream;
+
+
+	// an immutable table that maps the RVAs of a module to the functions inlined at them.
+	// the code ranges of all S_INLINESITE records of the module are decoded from their binary annotations, and split into
+	// disjunct ranges sorted by RVA. each range stores the full stack of functions inlined at its RVAs, outermost first.
+	// the names of inlined functions are resolved using the given IPI stream, which needs to outlive the table.
+	// the table is thread-safe, because it is never modified after construction.
+	class PDB_NO_DISCARD ModuleInlineTable
+	{
+	public:
+		static constexpr const uint32_t InvalidRange = 0xFFFFFFFFu;
+		static constexpr const uint32_t InvalidLine = 0xFFFFFFFFu;
+
+		// a function on the inline stack
+		struct Frame
+		{
+			uint32_t inlinee;					// ID of the LF_FUNC_ID or LF_MFUNC_ID record in the IPI stream
+			const char* name;					// can be null in case the ID could not be resolved
+			uint32_t lineNumber;				// source line executing in the inlined function, or InvalidLine if unknown
+			uint32_t filenameOffset;			// offset of the file name in the "/names" stream
+		};
+
+		ModuleInlineTable(void) PDB_NO_EXCEPT;
+		ModuleInlineTable(ModuleInlineTable&& other) PDB_NO_EXCEPT;
+		ModuleInlineTable& operator=(ModuleInlineTable&& other) PDB_NO_EXCEPT;
+
+		// Builds the table from the symbols and line information of a module.
+		explicit ModuleInlineTable(const RawFile& file, const ModuleSymbolStream& moduleSymbolStream, const ModuleLineStream& moduleLineStream,
+			const ImageSectionStream& imageSectionStream, const IPIStream& ipiStream) PDB_NO_EXCEPT;
+
+		~ModuleInlineTable(void) PDB_NO_EXCEPT;
+
+		// Returns the index of the range containing the given RVA, or InvalidRange in case no function is inlined at the RVA.
+		PDB_NO_DISCARD uint32_t Lookup(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Looks up the ranges containing the given RVAs, storing one range index per RVA.
+		// Searches are interleaved, hiding the latency of cache misses for large batches.
+		void Lookup(const uint32_t* rvas, size_t count, uint32_t* rangeIndices) const PDB_NO_EXCEPT;
+
+		// Returns the stack of functions inlined in the range with the given index, outermost first.
+		// The innermost frame is the function whose code the range belongs to, every other frame holds the line its inner frame was inlined at.
+		PDB_NO_DISCARD inline ArrayView<Frame> GetInlineStack(uint32_t rangeIndex) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Frame>(m_frames + m_stackOffsets[rangeIndex], m_stackDepths[rangeIndex]);
+		}
+
+		// Returns the number of ranges in the table. Ranges are sorted by their RVA.
+		// Ranges without any inlined function have an empty stack, and are never returned by a lookup.
+		PDB_NO_DISCARD inline uint32_t GetRangeCount(void) const PDB_NO_EXCEPT
+		{
+			return m_count;
+		}
+
+		// Returns the RVA at which the range with the given index starts. It ends where the next range starts.
+		PDB_NO_DISCARD inline uint32_t GetRVA(uint32_t rangeIndex) const PDB_NO_EXCEPT
+		{
+			return m_rvas[rangeIndex];
+		}
+
+	private:
+		Allocator m_allocator;
+
+		// columns, sorted by RVA
+		uint32_t* m_rvas;
+		uint32_t* m_stackOffsets;
+		uint32_t* m_stackDepths;
+		uint32_t m_count;
+
+		// the inline stacks of all ranges
+		Frame* m_frames;
+
+		PDB_DISABLE_COPY(ModuleInlineTable);
+	};
+}
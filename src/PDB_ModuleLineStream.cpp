@@ -0,0 +1,34 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ModuleLineStream.h"
+#include "PDB_RawFile.h"
+#include "PDB_DirectMSFStream.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineStream::ModuleLineStream(void) PDB_NO_EXCEPT
+	: m_stream()
+	, m_fileChecksums(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineStream::ModuleLineStream(const RawFile& file, uint16_t streamIndex, uint32_t lineInfoOffset, uint32_t lineInfoSize) PDB_NO_EXCEPT
+	: m_stream(file.CreateMSFStream<DirectMSFStream>(streamIndex), lineInfoSize, lineInfoOffset)
+	, m_fileChecksums(nullptr)
+{
+	// the line information consists of several subsections. lines refer to files by the offset of the file's entry
+	// in the DEBUG_S_FILECHKSMS subsection, so we remember where that is.
+	ForEachSection([this](const CodeView::DBI::DebugSubsectionHeader* section)
+	{
+		if (section->kind == CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+		{
+			m_fileChecksums = Pointer::Offset<const Byte*>(section, sizeof(CodeView::DBI::DebugSubsectionHeader));
+		}
+	});
+}
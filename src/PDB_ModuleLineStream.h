@@ -0,0 +1,151 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "PDB_DBITypes.h"
+#include "PDB_CoalescedMSFStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+
+
+	// provides access to the C13 line information of a module, which is stored in a sequence of subsections following the module's symbols.
+	// the stream only coalesces the line information, not the symbols or global refs preceding and following it.
+	// https://llvm.org/docs/PDB/ModiStream.html#the-c13-line-information-substream
+	class PDB_NO_DISCARD ModuleLineStream
+	{
+	public:
+		ModuleLineStream(void) PDB_NO_EXCEPT;
+		explicit ModuleLineStream(const RawFile& file, uint16_t streamIndex, uint32_t lineInfoOffset, uint32_t lineInfoSize) PDB_NO_EXCEPT;
+
+		PDB_DEFAULT_MOVE(ModuleLineStream);
+
+		// Iterates all subsections in the stream, including the ones we don't know about.
+		template <typename F>
+		void ForEachSection(F&& functor) const PDB_NO_EXCEPT
+		{
+			size_t offset = 0u;
+			while (offset + sizeof(CodeView::DBI::DebugSubsectionHeader) <= m_stream.GetSize())
+			{
+				const CodeView::DBI::DebugSubsectionHeader* section = m_stream.GetDataAtOffset<const CodeView::DBI::DebugSubsectionHeader>(offset);
+
+				functor(section);
+
+				// subsections are aligned to 4 bytes
+				offset = BitUtil::RoundUpToMultiple<size_t>(offset + sizeof(CodeView::DBI::DebugSubsectionHeader) + section->size, 4u);
+			}
+		}
+
+		// Iterates all blocks of lines of a DEBUG_S_LINES subsection. There is one block per file contributing to the subsection.
+		template <typename F>
+		void ForEachLinesBlock(const CodeView::DBI::DebugSubsectionHeader* section, F&& functor) const PDB_NO_EXCEPT
+		{
+			PDB_ASSERT(section->kind == CodeView::DBI::DebugSubsectionKind::S_LINES, "Subsection kind %X is not S_LINES.", static_cast<uint32_t>(section->kind));
+
+			const CodeView::DBI::LinesHeader* linesHeader = GetLinesHeader(section);
+
+			size_t offset = sizeof(CodeView::DBI::LinesHeader);
+			while (offset + sizeof(CodeView::DBI::LinesFileBlockHeader) <= section->size)
+			{
+				const CodeView::DBI::LinesFileBlockHeader* block = Pointer::Offset<const CodeView::DBI::LinesFileBlockHeader*>(linesHeader, offset);
+
+				functor(linesHeader, block);
+
+				// the size of a block includes its header, all lines, and all columns
+				if (block->size < sizeof(CodeView::DBI::LinesFileBlockHeader))
+				{
+					break;
+				}
+
+				offset += block->size;
+			}
+		}
+
+		// Iterates the source lines of all inlinees of a DEBUG_S_INLINEELINES subsection.
+		// Extended entries are passed as their common InlineeSourceLine prefix, the additional files are skipped.
+		template <typename F>
+		void ForEachInlineeLine(const CodeView::DBI::DebugSubsectionHeader* section, F&& functor) const PDB_NO_EXCEPT
+		{
+			PDB_ASSERT(section->kind == CodeView::DBI::DebugSubsectionKind::S_INLINEELINES, "Subsection kind %X is not S_INLINEELINES.", static_cast<uint32_t>(section->kind));
+
+			if (section->size < sizeof(CodeView::DBI::InlineeSourceLineSignature))
+			{
+				return;
+			}
+
+			const CodeView::DBI::InlineeSourceLineSignature signature = *Pointer::Offset<const CodeView::DBI::InlineeSourceLineSignature*>(section, sizeof(CodeView::DBI::DebugSubsectionHeader));
+			const bool isExtended = (signature == CodeView::DBI::InlineeSourceLineSignature::Extended);
+
+			size_t offset = sizeof(CodeView::DBI::InlineeSourceLineSignature);
+			while (offset + sizeof(CodeView::DBI::InlineeSourceLine) <= section->size)
+			{
+				const CodeView::DBI::InlineeSourceLine* line = Pointer::Offset<const CodeView::DBI::InlineeSourceLine*>(section, sizeof(CodeView::DBI::DebugSubsectionHeader) + offset);
+
+				functor(line);
+
+				if (isExtended)
+				{
+					const CodeView::DBI::InlineeSourceLineEx* lineEx = Pointer::Offset<const CodeView::DBI::InlineeSourceLineEx*>(line, 0u);
+					offset += sizeof(CodeView::DBI::InlineeSourceLineEx) + sizeof(uint32_t) * lineEx->extraFileCount;
+				}
+				else
+				{
+					offset += sizeof(CodeView::DBI::InlineeSourceLine);
+				}
+			}
+		}
+
+		// Returns the header of a DEBUG_S_LINES subsection.
+		PDB_NO_DISCARD inline const CodeView::DBI::LinesHeader* GetLinesHeader(const CodeView::DBI::DebugSubsectionHeader* section) const PDB_NO_EXCEPT
+		{
+			return Pointer::Offset<const CodeView::DBI::LinesHeader*>(section, sizeof(CodeView::DBI::DebugSubsectionHeader));
+		}
+
+		// Returns the lines of a block.
+		PDB_NO_DISCARD inline const CodeView::DBI::Line* GetLines(const CodeView::DBI::LinesFileBlockHeader* block) const PDB_NO_EXCEPT
+		{
+			return Pointer::Offset<const CodeView::DBI::Line*>(block, sizeof(CodeView::DBI::LinesFileBlockHeader));
+		}
+
+		// Returns the columns of a block, or nullptr in case the subsection doesn't store any columns.
+		PDB_NO_DISCARD inline const CodeView::DBI::Column* GetColumns(const CodeView::DBI::LinesHeader* linesHeader, const CodeView::DBI::LinesFileBlockHeader* block) const PDB_NO_EXCEPT
+		{
+			if ((linesHeader->flags & CodeView::DBI::LinesFlags::HasColumns) == CodeView::DBI::LinesFlags::None)
+			{
+				return nullptr;
+			}
+
+			// the columns directly follow the lines
+			return Pointer::Offset<const CodeView::DBI::Column*>(block, sizeof(CodeView::DBI::LinesFileBlockHeader) + sizeof(CodeView::DBI::Line) * block->numLines);
+		}
+
+		// Returns whether the stream has a DEBUG_S_FILECHKSMS subsection, which is needed for resolving the files of lines.
+		PDB_NO_DISCARD inline bool HasFileChecksums(void) const PDB_NO_EXCEPT
+		{
+			return (m_fileChecksums != nullptr);
+		}
+
+		// Returns the file checksum header at the given offset, as referenced by a block of lines.
+		// The file checksum header stores the offset of the file's name in the "/names" stream.
+		PDB_NO_DISCARD inline const CodeView::DBI::FileChecksumHeader* GetFileChecksumHeader(uint32_t fileChecksumOffset) const PDB_NO_EXCEPT
+		{
+			PDB_ASSERT(HasFileChecksums(), "Module line stream does not have a file checksums subsection.");
+
+			return Pointer::Offset<const CodeView::DBI::FileChecksumHeader*>(m_fileChecksums, fileChecksumOffset);
+		}
+
+	private:
+		CoalescedMSFStream m_stream;
+
+		// points to the data of the DEBUG_S_FILECHKSMS subsection, can be null
+		const Byte* m_fileChecksums;
+
+		PDB_DISABLE_COPY(ModuleLineStream);
+	};
+}
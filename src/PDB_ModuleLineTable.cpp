@@ -0,0 +1,237 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ModuleLineTable.h"
+#include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
+#include "PDB_ModuleLineStream.h"
+#include "PDB_DBITypes.h"
+#include "PDB_SortUtil.h"
+
+
+namespace
+{
+	// compilers emit these line numbers for code that doesn't belong to any source line, e.g. compiler-generated cleanup code
+	// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4592
+	static constexpr const uint32_t HiddenLineNumber = 0xFEEFEEu;
+	static constexpr const uint32_t AlwaysStepIntoLineNumber = 0xF00F00u;
+
+	// a line gathered while building the table
+	struct LineEntry
+	{
+		uint32_t rva;
+		uint32_t lineNumber;
+		uint32_t filenameOffset;
+	};
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineTable::ModuleLineTable(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_rvas(nullptr)
+	, m_lineNumbers(nullptr)
+	, m_filenameOffsets(nullptr)
+	, m_count(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineTable::ModuleLineTable(ModuleLineTable&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_rvas(PDB_MOVE(other.m_rvas))
+	, m_lineNumbers(PDB_MOVE(other.m_lineNumbers))
+	, m_filenameOffsets(PDB_MOVE(other.m_filenameOffsets))
+	, m_count(PDB_MOVE(other.m_count))
+{
+	other.m_rvas = nullptr;
+	other.m_lineNumbers = nullptr;
+	other.m_filenameOffsets = nullptr;
+	other.m_count = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineTable& PDB::ModuleLineTable::operator=(ModuleLineTable&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_rvas);
+		FreeArray(m_allocator, m_lineNumbers);
+		FreeArray(m_allocator, m_filenameOffsets);
+
+		m_allocator = other.m_allocator;
+		m_rvas = PDB_MOVE(other.m_rvas);
+		m_lineNumbers = PDB_MOVE(other.m_lineNumbers);
+		m_filenameOffsets = PDB_MOVE(other.m_filenameOffsets);
+		m_count = PDB_MOVE(other.m_count);
+
+		other.m_rvas = nullptr;
+		other.m_lineNumbers = nullptr;
+		other.m_filenameOffsets = nullptr;
+		other.m_count = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineTable::ModuleLineTable(const RawFile& file, const ModuleLineStream& moduleLineStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_rvas(nullptr)
+	, m_lineNumbers(nullptr)
+	, m_filenameOffsets(nullptr)
+	, m_count(0u)
+{
+	// lines can only be resolved to files with the help of the file checksums
+	if (!moduleLineStream.HasFileChecksums())
+	{
+		return;
+	}
+
+	// count the lines first, so that all entries can be gathered into one allocation.
+	// every subsection needs one additional entry that marks the end of its code.
+	size_t subsectionCount = 0u;
+	size_t lineCount = 0u;
+	moduleLineStream.ForEachSection([&moduleLineStream, &subsectionCount, &lineCount](const CodeView::DBI::DebugSubsectionHeader* section)
+	{
+		if (section->kind != CodeView::DBI::DebugSubsectionKind::S_LINES)
+		{
+			return;
+		}
+
+		++subsectionCount;
+		moduleLineStream.ForEachLinesBlock(section, [&lineCount](const CodeView::DBI::LinesHeader* /* linesHeader */, const CodeView::DBI::LinesFileBlockHeader* block)
+		{
+			lineCount += block->numLines;
+		});
+	});
+
+	const size_t maximumCount = subsectionCount + lineCount;
+	if (maximumCount == 0u)
+	{
+		return;
+	}
+
+	// the entries ending a subsection are stored in front of all lines. the sort is stable, so a line starting
+	// at the same RVA as the end of another subsection is guaranteed to come after it, and can replace it.
+	LineEntry* entries = AllocateArray<LineEntry>(m_allocator, maximumCount);
+	size_t endCount = 0u;
+	size_t count = subsectionCount;
+
+	moduleLineStream.ForEachSection([&moduleLineStream, &imageSectionStream, entries, &endCount, &count](const CodeView::DBI::DebugSubsectionHeader* section)
+	{
+		if (section->kind != CodeView::DBI::DebugSubsectionKind::S_LINES)
+		{
+			return;
+		}
+
+		const CodeView::DBI::LinesHeader* linesHeader = moduleLineStream.GetLinesHeader(section);
+		const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(linesHeader->sectionIndex, linesHeader->sectionOffset);
+		if (rva == 0u)
+		{
+			// the code of this subsection has been discarded by the linker
+			return;
+		}
+
+		entries[endCount++] = LineEntry { rva + linesHeader->codeSize, InvalidLine, 0u };
+
+		moduleLineStream.ForEachLinesBlock(section, [&moduleLineStream, entries, &count, rva](const CodeView::DBI::LinesHeader* /* linesHeader */, const CodeView::DBI::LinesFileBlockHeader* block)
+		{
+			const uint32_t filenameOffset = moduleLineStream.GetFileChecksumHeader(block->fileChecksumOffset)->filenameOffset;
+			const CodeView::DBI::Line* lines = moduleLineStream.GetLines(block);
+			for (uint32_t i = 0u; i < block->numLines; ++i)
+			{
+				const uint32_t lineNumber = lines[i].linenumStart;
+				const bool isHidden = (lineNumber == HiddenLineNumber) || (lineNumber == AlwaysStepIntoLineNumber);
+
+				entries[count++] = LineEntry { rva + lines[i].offset, isHidden ? InvalidLine : lineNumber, filenameOffset };
+			}
+		});
+	});
+
+	// close the gap left by discarded subsections between the entries ending a subsection and the lines
+	if (endCount != subsectionCount)
+	{
+		std::memmove(entries + endCount, entries + subsectionCount, (count - subsectionCount) * sizeof(LineEntry));
+		count -= subsectionCount - endCount;
+	}
+
+	if (count == 0u)
+	{
+		FreeArray(m_allocator, entries);
+		return;
+	}
+
+	SortUtil::RadixSortByKey(m_allocator, entries, count, [](const LineEntry& entry) { return entry.rva; });
+
+	// keep one entry per RVA, which is the first line starting at the RVA, if any
+	size_t uniqueCount = 1u;
+	for (size_t i = 1u; i < count; ++i)
+	{
+		if (entries[i].rva != entries[uniqueCount - 1u].rva)
+		{
+			entries[uniqueCount++] = entries[i];
+		}
+		else if ((entries[uniqueCount - 1u].lineNumber == InvalidLine) && (entries[i].lineNumber != InvalidLine))
+		{
+			entries[uniqueCount - 1u] = entries[i];
+		}
+	}
+
+	// store the columns
+	m_count = static_cast<uint32_t>(uniqueCount);
+	m_rvas = AllocateArray<uint32_t>(m_allocator, uniqueCount);
+	m_lineNumbers = AllocateArray<uint32_t>(m_allocator, uniqueCount);
+	m_filenameOffsets = AllocateArray<uint32_t>(m_allocator, uniqueCount);
+	for (size_t i = 0u; i < uniqueCount; ++i)
+	{
+		m_rvas[i] = entries[i].rva;
+		m_lineNumbers[i] = entries[i].lineNumber;
+		m_filenameOffsets[i] = entries[i].filenameOffset;
+	}
+
+	FreeArray(m_allocator, entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleLineTable::~ModuleLineTable(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_rvas);
+	FreeArray(m_allocator, m_lineNumbers);
+	FreeArray(m_allocator, m_filenameOffsets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleLineTable::Lookup(uint32_t rva) const PDB_NO_EXCEPT
+{
+	// find the last entry starting at or before the RVA
+	const uint32_t lineIndex = SortUtil::FindLastLessOrEqual(m_rvas, m_count, rva);
+
+	return ((lineIndex != SortUtil::InvalidIndex) && (m_lineNumbers[lineIndex] != InvalidLine)) ? lineIndex : InvalidLine;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ModuleLineTable::Lookup(const uint32_t* rvas, size_t count, uint32_t* lineIndices) const PDB_NO_EXCEPT
+{
+	SortUtil::FindLastLessOrEqual(m_rvas, m_count, rvas, count, lineIndices);
+
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const uint32_t lineIndex = lineIndices[i];
+		lineIndices[i] = ((lineIndex != SortUtil::InvalidIndex) && (m_lineNumbers[lineIndex] != InvalidLine)) ? lineIndex : InvalidLine;
+	}
+}
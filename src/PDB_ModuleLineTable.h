@@ -0,0 +1,83 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ImageSectionStream;
+	class ModuleLineStream;
+
+
+	// an immutable table that maps the RVAs of a module to the source lines they were generated from.
+	// the lines of all DEBUG_S_LINES subsections of the module are stored in a compact table sorted by RVA.
+	// each subsection additionally ends in an entry without a line, so that RVAs between functions don't resolve to the preceding line.
+	// the file of a line is stored as the offset of its name in the "/names" stream, see NamesStream::GetFilename().
+	// the table is thread-safe, because it is never modified after construction.
+	class PDB_NO_DISCARD ModuleLineTable
+	{
+	public:
+		static constexpr const uint32_t InvalidLine = 0xFFFFFFFFu;
+
+		ModuleLineTable(void) PDB_NO_EXCEPT;
+		ModuleLineTable(ModuleLineTable&& other) PDB_NO_EXCEPT;
+		ModuleLineTable& operator=(ModuleLineTable&& other) PDB_NO_EXCEPT;
+
+		// Builds the table from the line information of a module.
+		explicit ModuleLineTable(const RawFile& file, const ModuleLineStream& moduleLineStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+
+		~ModuleLineTable(void) PDB_NO_EXCEPT;
+
+		// Returns the index of the line containing the given RVA, or InvalidLine in case no line contains it.
+		PDB_NO_DISCARD uint32_t Lookup(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Looks up the lines containing the given RVAs, storing one line index per RVA.
+		// Searches are interleaved, hiding the latency of cache misses for large batches.
+		void Lookup(const uint32_t* rvas, size_t count, uint32_t* lineIndices) const PDB_NO_EXCEPT;
+
+		// Returns the number of entries in the table. Entries are sorted by their RVA.
+		// Entries ending a subsection store InvalidLine as their line number, and are never returned by a lookup.
+		PDB_NO_DISCARD inline uint32_t GetLineCount(void) const PDB_NO_EXCEPT
+		{
+			return m_count;
+		}
+
+		// Returns the RVA at which the code of the line with the given index starts.
+		PDB_NO_DISCARD inline uint32_t GetRVA(uint32_t lineIndex) const PDB_NO_EXCEPT
+		{
+			return m_rvas[lineIndex];
+		}
+
+		// Returns the source line number of the line with the given index.
+		PDB_NO_DISCARD inline uint32_t GetLineNumber(uint32_t lineIndex) const PDB_NO_EXCEPT
+		{
+			return m_lineNumbers[lineIndex];
+		}
+
+		// Returns the offset of the file name in the "/names" stream of the line with the given index.
+		PDB_NO_DISCARD inline uint32_t GetFilenameOffset(uint32_t lineIndex) const PDB_NO_EXCEPT
+		{
+			return m_filenameOffsets[lineIndex];
+		}
+
+	private:
+		Allocator m_allocator;
+
+		// columns, sorted by RVA
+		uint32_t* m_rvas;
+		uint32_t* m_lineNumbers;
+		uint32_t* m_filenameOffsets;
+		uint32_t m_count;
+
+		PDB_DISABLE_COPY(ModuleLineTable);
+	};
+}
@@ -0,0 +1,174 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ModuleSymbolCursor.h"
+#include "PDB_RawFile.h"
+#include "Foundation/PDB_BitUtil.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleSymbolCursor::ModuleSymbolCursor(const RawFile& file, const ModuleInfoStream::Module& module) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_stream(file.CreateMSFStream<DirectMSFStream>(module.GetInfo().moduleSymbolStreamIndex))
+	, m_offset(sizeof(uint32_t))
+	, m_symbolStreamSize(module.GetInfo().symbolSize)
+	, m_window(nullptr)
+	, m_windowBegin(0u)
+	, m_windowEnd(0u)
+	, m_blockBuffer(nullptr)
+	, m_ownedBuffer(nullptr)
+	, m_ownedBufferSize(0u)
+{
+	PDB_ASSERT(module.HasSymbolStream(), "Module symbol stream index is invalid.");
+
+	// the symbols are preceded by the stream's 4-byte signature, and followed by line information and global refs.
+	// see ModuleSymbolStream for the layout of the stream.
+	if (m_symbolStreamSize > m_stream.GetSize())
+	{
+		m_symbolStreamSize = m_stream.GetSize();
+	}
+
+	// every move of the window looks up the run of contiguous blocks containing the new offset
+	m_stream.BuildContiguousRunMap();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleSymbolCursor::~ModuleSymbolCursor(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_blockBuffer);
+	FreeArray(m_allocator, m_ownedBuffer);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::ModuleSymbolCursor::Next(void) PDB_NO_EXCEPT
+{
+	if (m_offset + sizeof(CodeView::DBI::RecordHeader) > m_symbolStreamSize)
+	{
+		return nullptr;
+	}
+
+	// records are 4-byte aligned, so their header never straddles a block boundary, and is always found in the window
+	if ((m_offset < m_windowBegin) || (m_offset + sizeof(CodeView::DBI::RecordHeader) > m_windowEnd))
+	{
+		MoveWindow(m_offset);
+	}
+
+	// the stored size includes the size of the 'kind' field, but not the size of the 'size' field itself
+	const CodeView::DBI::Record* record = reinterpret_cast<const CodeView::DBI::Record*>(m_window + (m_offset - m_windowBegin));
+	const size_t recordSize = sizeof(uint16_t) + record->header.size;
+	if ((record->header.size < sizeof(uint16_t)) || (m_offset + recordSize > m_symbolStreamSize))
+	{
+		return nullptr;
+	}
+
+	if (m_offset + recordSize > m_windowEnd)
+	{
+		// slower path, the record straddles the end of the window
+		Byte* buffer = m_inlineBuffer;
+		if (recordSize > InlineBufferSize)
+		{
+			if (recordSize > m_ownedBufferSize)
+			{
+				FreeArray(m_allocator, m_ownedBuffer);
+				m_ownedBuffer = AllocateArray<Byte>(m_allocator, recordSize);
+				m_ownedBufferSize = recordSize;
+			}
+
+			buffer = m_ownedBuffer;
+		}
+
+		m_stream.ReadAtOffset(buffer, recordSize, m_offset);
+		record = reinterpret_cast<const CodeView::DBI::Record*>(buffer);
+
+		if (buffer == m_ownedBuffer)
+		{
+			ReportCopy(m_allocator, recordSize);
+		}
+	}
+
+	m_offset = BitUtil::RoundUpToMultiple<uint32_t>(m_offset + static_cast<uint32_t>(recordSize), 4u);
+
+	return record;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ModuleSymbolCursor::MoveWindow(uint32_t offset) PDB_NO_EXCEPT
+{
+	// hand out the whole run of contiguous blocks containing the offset, if the file is memory-mapped
+	size_t size = 0u;
+	const void* data = m_stream.GetMappedRun(offset, size);
+	if (data)
+	{
+		m_window = static_cast<const Byte*>(data);
+		m_windowBegin = offset;
+		m_windowEnd = (size < m_symbolStreamSize - offset) ? offset + static_cast<uint32_t>(size) : m_symbolStreamSize;
+
+		return;
+	}
+
+	// otherwise, read the block containing the offset, but nothing beyond the symbols
+	const uint32_t blockSize = m_stream.GetBlockSize();
+	if (!m_blockBuffer)
+	{
+		m_blockBuffer = AllocateArray<Byte>(m_allocator, blockSize);
+	}
+
+	const uint32_t blockBegin = offset & ~(blockSize - 1u);
+	const uint32_t blockEnd = (m_symbolStreamSize - blockBegin > blockSize) ? blockBegin + blockSize : m_symbolStreamSize;
+	m_stream.ReadAtOffset(m_blockBuffer, blockEnd - blockBegin, blockBegin);
+	ReportCopy(m_allocator, blockEnd - blockBegin);
+
+	m_window = m_blockBuffer;
+	m_windowBegin = blockBegin;
+	m_windowEnd = blockEnd;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ModuleSymbolCursor::SkipScope(uint32_t scopeEnd) PDB_NO_EXCEPT
+{
+	// only trust the end offset if it really points at a record closing a scope, otherwise keep walking linearly
+	const uint32_t offset = m_offset;
+	m_offset = scopeEnd;
+
+	const CodeView::DBI::Record* endRecord = Next();
+	if (!endRecord || !IsScopeEndRecord(endRecord))
+	{
+		m_offset = offset;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ModuleSymbolCursor::Seek(uint32_t offset) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(offset <= m_symbolStreamSize, "Offset out of bounds.");
+
+	m_offset = offset;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::ModuleSymbolCursor::FindRecord(CodeView::DBI::SymbolRecordKind kind) PDB_NO_EXCEPT
+{
+	for (const CodeView::DBI::Record* record = Next(); record != nullptr; record = Next())
+	{
+		if (record->header.kind == kind)
+		{
+			return record;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,106 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "PDB_Types.h"
+#include "PDB_DBITypes.h"
+#include "PDB_Allocator.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_ModuleSymbolStream.h"
+#include "PDB_ModuleInfoStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+
+
+	// reads the symbols of a module one record at a time, without coalescing the module symbol stream.
+	// records are handed out directly from the memory-mapped data. only records straddling a boundary between blocks that are not
+	// contiguous in the file are copied into a bounce buffer first, so the memory needed is bounded by the size of the largest record
+	// rather than the size of the module.
+	// if the file is not memory-mapped, the stream is read one block at a time into an owned buffer instead.
+	// pays off when only a few records of a module are needed, e.g. when looking for the module's S_COMPILE3 record.
+	// records handed out by a cursor are valid until the next call to Next() or Seek().
+	// not thread-safe, but any number of cursors can read from the same module concurrently.
+	class PDB_NO_DISCARD ModuleSymbolCursor
+	{
+	public:
+		explicit ModuleSymbolCursor(const RawFile& file, const ModuleInfoStream::Module& module) PDB_NO_EXCEPT;
+		~ModuleSymbolCursor(void) PDB_NO_EXCEPT;
+
+		// Returns the record at the cursor and advances the cursor to the next record.
+		// Returns nullptr once all records have been read, or in case a record is malformed.
+		PDB_NO_DISCARD const CodeView::DBI::Record* Next(void) PDB_NO_EXCEPT;
+
+		// Moves the cursor to the record at the given offset into the module symbol stream, e.g. the end of a scope.
+		void Seek(uint32_t offset) PDB_NO_EXCEPT;
+
+		// Returns the offset of the record at the cursor.
+		PDB_NO_DISCARD inline uint32_t GetOffset(void) const PDB_NO_EXCEPT
+		{
+			return m_offset;
+		}
+
+		// Finds the next record of a certain kind, leaving the cursor after it.
+		PDB_NO_DISCARD const CodeView::DBI::Record* FindRecord(CodeView::DBI::SymbolRecordKind kind) PDB_NO_EXCEPT;
+
+		// Iterates all remaining records.
+		template <typename F>
+		void ForEachSymbol(F&& functor) PDB_NO_EXCEPT
+		{
+			for (const CodeView::DBI::Record* record = Next(); record != nullptr; record = Next())
+			{
+				functor(record);
+			}
+		}
+
+		// Iterates all remaining records, but only descends into the scopes accepted by the filter.
+		// Skipped scopes are never read, see ModuleSymbolStream::ForEachSymbol() for details.
+		template <typename F, typename Filter>
+		void ForEachSymbol(F&& functor, Filter&& shouldDescend) PDB_NO_EXCEPT
+		{
+			for (const CodeView::DBI::Record* record = Next(); record != nullptr; record = Next())
+			{
+				functor(record);
+
+				const uint32_t scopeEnd = GetScopeEndOffset(record);
+				if ((scopeEnd >= m_offset) && (scopeEnd < m_symbolStreamSize) && ((scopeEnd & 3u) == 0u) && !shouldDescend(record))
+				{
+					SkipScope(scopeEnd);
+				}
+			}
+		}
+
+	private:
+		static const size_t InlineBufferSize = 256u;
+
+		// Makes the window hold the data at the given offset.
+		void MoveWindow(uint32_t offset) PDB_NO_EXCEPT;
+
+		// Moves the cursor past the record closing a scope at the given offset, or leaves it untouched in case there is no such record.
+		void SkipScope(uint32_t scopeEnd) PDB_NO_EXCEPT;
+
+		Allocator m_allocator;
+		DirectMSFStream m_stream;
+		uint32_t m_offset;
+		uint32_t m_symbolStreamSize;
+
+		// the part of the stream that is contiguous in memory and can be handed out directly, [m_windowBegin, m_windowEnd)
+		const Byte* m_window;
+		uint32_t m_windowBegin;
+		uint32_t m_windowEnd;
+
+		// holds one block in case the file is not memory-mapped
+		Byte* m_blockBuffer;
+
+		// bounce buffer for records straddling a block boundary, either the inline buffer or grown using the allocator
+		Byte* m_ownedBuffer;
+		size_t m_ownedBufferSize;
+		alignas(8) Byte m_inlineBuffer[InlineBufferSize];
+
+		PDB_DISABLE_COPY_MOVE(ModuleSymbolCursor);
+	};
+}
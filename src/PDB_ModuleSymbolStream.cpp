@@ -31,6 +31,7 @@ PDB::ModuleSymbolStream::ModuleSymbolStream(const RawFile& file, uint16_t stream
 	// we are only interested in the symbols, but not the line information or global refs.
 	// the coalesced stream is therefore only built for the symbols, not all the data in the stream.
 	// this potentially saves a lot of memory and performance on large PDBs.
+	// the C13 line information is accessed through a ModuleLineStream instead.
 }
 
 
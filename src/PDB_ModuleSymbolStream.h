@@ -15,6 +15,45 @@ namespace PDB
 	class RawFile;
 
 
+	// Returns whether the given record opens a scope, which is closed by a matching S_END, S_PROC_ID_END or S_INLINESITE_END record.
+	PDB_NO_DISCARD inline bool IsScopeStartRecord(const CodeView::DBI::Record* record) PDB_NO_EXCEPT
+	{
+		switch (record->header.kind)
+		{
+			case CodeView::DBI::SymbolRecordKind::S_LPROC32:
+			case CodeView::DBI::SymbolRecordKind::S_GPROC32:
+			case CodeView::DBI::SymbolRecordKind::S_LPROC32_ID:
+			case CodeView::DBI::SymbolRecordKind::S_GPROC32_ID:
+			case CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC:
+			case CodeView::DBI::SymbolRecordKind::S_LPROC32_DPC_ID:
+			case CodeView::DBI::SymbolRecordKind::S_THUNK32:
+			case CodeView::DBI::SymbolRecordKind::S_BLOCK32:
+			case CodeView::DBI::SymbolRecordKind::S_SEPCODE:
+			case CodeView::DBI::SymbolRecordKind::S_INLINESITE:
+			case CodeView::DBI::SymbolRecordKind::S_INLINESITE2:
+				return true;
+
+			default:
+				return false;
+		}
+	}
+
+	// Returns the offset of the record closing the scope opened by the given record, or 0 in case the record does not open a scope.
+	PDB_NO_DISCARD inline uint32_t GetScopeEndOffset(const CodeView::DBI::Record* record) PDB_NO_EXCEPT
+	{
+		// all records opening a scope start with the offsets of their parent and end records, see e.g. BLOCKSYM32 and SEPCODESYM in cvinfo.h
+		return IsScopeStartRecord(record) ? record->data.S_BLOCK32.end : 0u;
+	}
+
+	// Returns whether the given record closes a scope.
+	PDB_NO_DISCARD inline bool IsScopeEndRecord(const CodeView::DBI::Record* record) PDB_NO_EXCEPT
+	{
+		return (record->header.kind == CodeView::DBI::SymbolRecordKind::S_END) ||
+			(record->header.kind == CodeView::DBI::SymbolRecordKind::S_PROC_ID_END) ||
+			(record->header.kind == CodeView::DBI::SymbolRecordKind::S_INLINESITE_END);
+	}
+
+
 	class PDB_NO_DISCARD ModuleSymbolStream
 	{
 	public:
@@ -37,6 +76,21 @@ namespace PDB
 			return m_stream.GetDataAtOffset<const CodeView::DBI::Record>(record.end);
 		}
 
+		// Returns the end record of a record of any kind, or nullptr in case the record does not open a scope, or its end offset does not
+		// point at a record closing a scope.
+		PDB_NO_DISCARD inline const CodeView::DBI::Record* GetEndRecord(const CodeView::DBI::Record* record) const PDB_NO_EXCEPT
+		{
+			const uint32_t scopeEnd = GetScopeEndOffset(record);
+			if ((scopeEnd == 0u) || ((scopeEnd & 3u) != 0u) || (scopeEnd + sizeof(CodeView::DBI::RecordHeader) > m_stream.GetSize()))
+			{
+				return nullptr;
+			}
+
+			const CodeView::DBI::Record* endRecord = m_stream.GetDataAtOffset<const CodeView::DBI::Record>(scopeEnd);
+
+			return IsScopeEndRecord(endRecord) ? endRecord : nullptr;
+		}
+
 		// Finds a record of a certain kind.
 		PDB_NO_DISCARD const CodeView::DBI::Record* FindRecord(CodeView::DBI::SymbolRecordKind Kind) const PDB_NO_EXCEPT;
 
@@ -62,6 +116,38 @@ namespace PDB
 			}
 		}
 
+		// Iterates all records in the stream, but only descends into the scopes accepted by the filter.
+		// Procedures, thunks, blocks, separated code and inline sites are handed to the functor, and then to the filter. In case the filter returns false,
+		// all records nested inside the scope as well as the record closing it are skipped by jumping straight to the scope's end.
+		// Returning false for all scopes visits top-level records only, which skips most of the stream for modules with many locals.
+		template <typename F, typename Filter>
+		void ForEachSymbol(F&& functor, Filter&& shouldDescend) const PDB_NO_EXCEPT
+		{
+			// ignore the stream's 4-byte signature
+			size_t offset = sizeof(uint32_t);
+
+			while (offset < m_stream.GetSize())
+			{
+				const CodeView::DBI::Record* record = m_stream.GetDataAtOffset<const CodeView::DBI::Record>(offset);
+				const uint32_t recordSize = GetCodeViewRecordSize(record);
+
+				functor(record);
+
+				offset = BitUtil::RoundUpToMultiple<size_t>(offset + sizeof(CodeView::DBI::RecordHeader) + recordSize, 4u);
+
+				// only trust the end offset if it lies ahead and really points at a record closing a scope, otherwise keep walking linearly
+				const uint32_t scopeEnd = GetScopeEndOffset(record);
+				if ((scopeEnd >= offset) && !shouldDescend(record))
+				{
+					const CodeView::DBI::Record* endRecord = GetEndRecord(record);
+					if (endRecord)
+					{
+						offset = BitUtil::RoundUpToMultiple<size_t>(scopeEnd + sizeof(CodeView::DBI::RecordHeader) + GetCodeViewRecordSize(endRecord), 4u);
+					}
+				}
+			}
+		}
+
 	private:
 		CoalescedMSFStream m_stream;
 
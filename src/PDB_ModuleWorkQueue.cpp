@@ -0,0 +1,118 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ModuleWorkQueue.h"
+#include "PDB_RawFile.h"
+#include "PDB_DBITypes.h"
+#include "PDB_SortUtil.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <atomic>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+// shares are aligned to a cache line, which also pads them to its size, so that workers popping from their own share don't cause false sharing
+struct alignas(64) PDB::ModuleWorkQueue::Share
+{
+	std::atomic<uint32_t> next;
+	uint32_t end;
+};
+
+
+namespace
+{
+	// a module gathered while building the queue
+	struct ModuleEntry
+	{
+		uint32_t size;
+		uint32_t index;
+	};
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleWorkQueue::ModuleWorkQueue(const RawFile& file, const ModuleInfoStream& moduleInfoStream, uint32_t workerCount) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_modules(nullptr)
+	, m_shareMemory(nullptr)
+	, m_shares(nullptr)
+	, m_workerCount((workerCount != 0u) ? workerCount : 1u)
+{
+	const ArrayView<ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
+
+	// gather all modules that have symbols, largest first
+	ModuleEntry* entries = AllocateArray<ModuleEntry>(m_allocator, modules.GetLength());
+	uint32_t count = 0u;
+	for (size_t i = 0u; i < modules.GetLength(); ++i)
+	{
+		if (modules[i].HasSymbolStream())
+		{
+			entries[count++] = ModuleEntry { modules[i].GetInfo().symbolSize, static_cast<uint32_t>(i) };
+		}
+	}
+
+	// sorting by the inverted size puts the largest modules first
+	SortUtil::RadixSortByKey(m_allocator, entries, count, [](const ModuleEntry& entry) { return ~entry.size; });
+
+	// deal the modules round-robin, worker w getting modules w, w + n, w + 2n, and so on.
+	// the shares are stored one after another, each of them still sorted by size.
+	m_modules = AllocateArray<uint32_t>(m_allocator, count);
+
+	// allocators only guarantee the alignment of std::max_align_t, so the shares are aligned by hand
+	m_shareMemory = AllocateArray<Byte>(m_allocator, sizeof(Share) * m_workerCount + alignof(Share) - 1u);
+	m_shares = reinterpret_cast<Share*>(BitUtil::RoundUpToMultiple<uintptr_t>(reinterpret_cast<uintptr_t>(m_shareMemory), alignof(Share)));
+	for (uint32_t worker = 0u; worker < m_workerCount; ++worker)
+	{
+		new (m_shares + worker) Share;
+	}
+
+	uint32_t offset = 0u;
+	for (uint32_t worker = 0u; worker < m_workerCount; ++worker)
+	{
+		m_shares[worker].next.store(offset, std::memory_order_relaxed);
+		for (uint32_t i = worker; i < count; i += m_workerCount)
+		{
+			m_modules[offset++] = entries[i].index;
+		}
+
+		m_shares[worker].end = offset;
+	}
+
+	FreeArray(m_allocator, entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ModuleWorkQueue::~ModuleWorkQueue(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_modules);
+	FreeArray(m_allocator, m_shareMemory);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleWorkQueue::Pop(uint32_t worker) PDB_NO_EXCEPT
+{
+	// take from our own share first, and steal from the shares of the following workers once it is exhausted
+	for (uint32_t i = 0u; i < m_workerCount; ++i)
+	{
+		Share& share = m_shares[(worker + i) % m_workerCount];
+
+		// check first, so that exhausted shares don't keep counting up
+		if (share.next.load(std::memory_order_relaxed) >= share.end)
+		{
+			continue;
+		}
+
+		const uint32_t index = share.next.fetch_add(1u, std::memory_order_relaxed);
+		if (index < share.end)
+		{
+			return m_modules[index];
+		}
+	}
+
+	return InvalidModule;
+}
@@ -0,0 +1,103 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_Assert.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <type_traits>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+#include "PDB_Executor.h"
+#include "PDB_ModuleInfoStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+
+
+	// distributes the modules with a symbol stream across a fixed number of workers, weighted by the size of their symbols.
+	// modules are sorted by size and dealt round-robin, so every worker starts with a similar amount of work, largest modules first.
+	// a worker that runs out of modules steals from the other workers, which evens out the rest.
+	// popping modules is lock-free and can be done concurrently by all workers.
+	class PDB_NO_DISCARD ModuleWorkQueue
+	{
+		struct Share;
+
+	public:
+		static constexpr const uint32_t InvalidModule = 0xFFFFFFFFu;
+
+		explicit ModuleWorkQueue(const RawFile& file, const ModuleInfoStream& moduleInfoStream, uint32_t workerCount) PDB_NO_EXCEPT;
+		~ModuleWorkQueue(void) PDB_NO_EXCEPT;
+
+		// Returns the index of the next module the given worker should process, or InvalidModule in case all modules have been handed out.
+		PDB_NO_DISCARD uint32_t Pop(uint32_t worker) PDB_NO_EXCEPT;
+
+		// Returns the number of workers.
+		PDB_NO_DISCARD inline uint32_t GetWorkerCount(void) const PDB_NO_EXCEPT
+		{
+			return m_workerCount;
+		}
+
+	private:
+		Allocator m_allocator;
+
+		// the indices of all modules, grouped by the worker they were dealt to
+		uint32_t* m_modules;
+
+		// the part of m_modules owned by each worker, along with the next module to hand out.
+		// the shares are aligned to a cache line inside the memory allocated for them.
+		Byte* m_shareMemory;
+		Share* m_shares;
+		uint32_t m_workerCount;
+
+		PDB_DISABLE_COPY_MOVE(ModuleWorkQueue);
+	};
+
+
+	// Iterates the symbols of all modules in parallel, calling the functor with an accumulator, the module index and the record.
+	// Modules are distributed across workerCount workers using a ModuleWorkQueue, and each worker is run as one task of the executor.
+	// Every worker exclusively owns the accumulator with its index, so the functor doesn't need any locking.
+	// Once all workers are done, the accumulators of all other workers are merged into the first one on the calling thread.
+	// The accumulators array must hold workerCount elements, and the allocator of the file must be thread-safe.
+	template <typename Accumulator, typename F, typename M>
+	void ForEachModuleSymbolParallel(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const Executor& executor, Accumulator* accumulators, uint32_t workerCount, F&& functor, M&& merge) PDB_NO_EXCEPT
+	{
+		PDB_ASSERT(workerCount != 0u, "At least one worker is needed.");
+
+		struct TaskData
+		{
+			const RawFile* file;
+			const ModuleInfoStream* moduleInfoStream;
+			ModuleWorkQueue* queue;
+			Accumulator* accumulators;
+			typename std::remove_reference<F>::type* functor;
+		};
+
+		ModuleWorkQueue queue(file, moduleInfoStream, workerCount);
+		TaskData taskData = { &file, &moduleInfoStream, &queue, accumulators, &functor };
+
+		ParallelFor(executor, workerCount, [](void* data, uint32_t worker)
+		{
+			TaskData* task = static_cast<TaskData*>(data);
+			Accumulator& accumulator = task->accumulators[worker];
+
+			for (uint32_t moduleIndex = task->queue->Pop(worker); moduleIndex != ModuleWorkQueue::InvalidModule; moduleIndex = task->queue->Pop(worker))
+			{
+				const ModuleSymbolStream moduleSymbolStream = task->moduleInfoStream->GetModule(moduleIndex).CreateSymbolStream(*task->file);
+				moduleSymbolStream.ForEachSymbol([task, &accumulator, moduleIndex](const CodeView::DBI::Record* record)
+				{
+					(*task->functor)(accumulator, moduleIndex, record);
+				});
+			}
+		}, &taskData);
+
+		for (uint32_t worker = 1u; worker < workerCount; ++worker)
+		{
+			merge(accumulators[0], accumulators[worker]);
+		}
+	}
+}
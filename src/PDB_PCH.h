@@ -10,7 +10,9 @@
 
 // third-party includes
 #include "Foundation/PDB_DisableWarningsPush.h"
-#include <intrin.h>
+#if PDB_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
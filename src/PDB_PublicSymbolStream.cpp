@@ -4,6 +4,7 @@
 #include "PDB_PCH.h"
 #include "PDB_PublicSymbolStream.h"
 #include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
 #include "PDB_Types.h"
 #include "PDB_DBITypes.h"
 
@@ -14,6 +15,13 @@ PDB::PublicSymbolStream::PublicSymbolStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_hashRecords(nullptr)
 	, m_count(0u)
+	, m_hashTable()
+	, m_addressMap(nullptr)
+	, m_addressMapCount(0u)
+	, m_thunkMap(nullptr)
+	, m_thunkCount(0u)
+	, m_thunkSize(0u)
+	, m_thunkTableRVA(0u)
 {
 }
 
@@ -24,7 +32,49 @@ PDB::PublicSymbolStream::PublicSymbolStream(const RawFile& file, uint16_t stream
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
 	, m_hashRecords(m_stream.GetDataAtOffset<HashRecord>(sizeof(PublicStreamHeader) + sizeof(HashTableHeader)))
 	, m_count(count)
+	, m_hashTable(m_stream, sizeof(PublicStreamHeader))
+	, m_addressMap(nullptr)
+	, m_addressMapCount(0u)
+	, m_thunkMap(nullptr)
+	, m_thunkCount(0u)
+	, m_thunkSize(0u)
+	, m_thunkTableRVA(0u)
 {
+	// the address map directly follows the hash table
+	const PublicStreamHeader* header = m_stream.GetDataAtOffset<const PublicStreamHeader>(0u);
+	const size_t addressMapOffset = sizeof(PublicStreamHeader) + header->symHash;
+	if (addressMapOffset + header->addrMap > m_stream.GetSize())
+	{
+		// malformed data
+		return;
+	}
+
+	m_addressMap = m_stream.GetDataAtOffset<const uint32_t>(addressMapOffset);
+	m_addressMapCount = header->addrMap / sizeof(uint32_t);
+
+	// the address map is followed by the thunk map and the section map
+	const size_t thunkMapOffset = addressMapOffset + header->addrMap;
+	const size_t sectionMapOffset = thunkMapOffset + static_cast<size_t>(header->thunkCount) * sizeof(uint32_t);
+	if ((header->thunkCount == 0u) || (header->sizeOfThunk == 0u) || (sectionMapOffset + header->sectionCount * sizeof(PublicStreamSectionMapEntry) > m_stream.GetSize()))
+	{
+		// no incremental linking thunks, or malformed data
+		return;
+	}
+
+	// the thunk table is stored as section offset, and the section map tells us the RVA of that section
+	const PublicStreamSectionMapEntry* sectionMap = m_stream.GetDataAtOffset<const PublicStreamSectionMapEntry>(sectionMapOffset);
+	for (uint16_t i = 0u; i < header->sectionCount; ++i)
+	{
+		if (sectionMap[i].section == header->isectThunkTable)
+		{
+			m_thunkMap = m_stream.GetDataAtOffset<const uint32_t>(thunkMapOffset);
+			m_thunkCount = header->thunkCount;
+			m_thunkSize = header->sizeOfThunk;
+			m_thunkTableRVA = sectionMap[i].offset + header->offsetThunkTable;
+
+			break;
+		}
+	}
 }
 
 
@@ -47,3 +97,104 @@ PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::PublicSymbolStream::GetRec
 
 	return record;
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::PublicSymbolStream::GetAddressMapRecord(const CoalescedMSFStream& symbolRecordStream, uint32_t addressMapEntry) const PDB_NO_EXCEPT
+{
+	// unlike hash record offsets, address map offsets start at 0
+	const CodeView::DBI::Record* record = symbolRecordStream.GetDataAtOffset<const CodeView::DBI::Record>(addressMapEntry);
+
+	if (record->header.kind != CodeView::DBI::SymbolRecordKind::S_PUB32)
+	{
+		// malformed data
+		return nullptr;
+	}
+
+	return record;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::PublicSymbolStream::FindPublicByAddress(const CoalescedMSFStream& symbolRecordStream, uint16_t oneBasedSectionIndex, uint32_t offsetInSection) const PDB_NO_EXCEPT
+{
+	// find the first entry whose address is larger than the one we're looking for
+	uint32_t first = 0u;
+	uint32_t count = m_addressMapCount;
+	while (count > 0u)
+	{
+		const uint32_t step = count / 2u;
+		const uint32_t index = first + step;
+
+		const CodeView::DBI::Record* record = GetAddressMapRecord(symbolRecordStream, m_addressMap[index]);
+		if (!record)
+		{
+			// malformed data
+			return nullptr;
+		}
+
+		const uint16_t section = record->data.S_PUB32.section;
+		const bool isLessOrEqual = (section < oneBasedSectionIndex) || ((section == oneBasedSectionIndex) && (record->data.S_PUB32.offset <= offsetInSection));
+		if (isLessOrEqual)
+		{
+			first = index + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	if (first == 0u)
+	{
+		// all symbols are stored at larger addresses
+		return nullptr;
+	}
+
+	// the entry preceding the one we found is the closest symbol, as long as it is stored in the same section
+	const CodeView::DBI::Record* record = GetAddressMapRecord(symbolRecordStream, m_addressMap[first - 1u]);
+	if (record->data.S_PUB32.section != oneBasedSectionIndex)
+	{
+		return nullptr;
+	}
+
+	return record;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::DBI::Record* PDB::PublicSymbolStream::FindPublicByRVA(const CoalescedMSFStream& symbolRecordStream, const ImageSectionStream& imageSectionStream, uint32_t rva) const PDB_NO_EXCEPT
+{
+	uint16_t oneBasedSectionIndex = 0u;
+	uint32_t offsetInSection = 0u;
+	if (!imageSectionStream.ConvertRVAToSectionOffset(rva, oneBasedSectionIndex, offsetInSection))
+	{
+		return nullptr;
+	}
+
+	return FindPublicByAddress(symbolRecordStream, oneBasedSectionIndex, offsetInSection);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::PublicSymbolStream::ConvertThunkRVAToTargetRVA(uint32_t rva) const PDB_NO_EXCEPT
+{
+	if (m_thunkCount == 0u)
+	{
+		return 0u;
+	}
+
+	// RVAs in front of the thunk table wrap around, and end up outside the table as well
+	const uint32_t thunkIndex = (rva - m_thunkTableRVA) / m_thunkSize;
+	if (thunkIndex >= m_thunkCount)
+	{
+		return 0u;
+	}
+
+	return m_thunkMap[thunkIndex];
+}
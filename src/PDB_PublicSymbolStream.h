@@ -6,11 +6,13 @@
 #include "Foundation/PDB_Macros.h"
 #include "Foundation/PDB_ArrayView.h"
 #include "PDB_CoalescedMSFStream.h"
+#include "PDB_SymbolHashTable.h"
 
 
 namespace PDB
 {
 	class RawFile;
+	class ImageSectionStream;
 	struct HashRecord;
 
 	namespace CodeView
@@ -40,10 +42,71 @@ namespace PDB
 			return ArrayView<HashRecord>(m_hashRecords, m_count);
 		}
 
+		// Returns a view of the address map, which stores the offsets of all S_PUB32 records in the symbol record stream, sorted by section and offset.
+		PDB_NO_DISCARD inline ArrayView<uint32_t> GetAddressMap(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<uint32_t>(m_addressMap, m_addressMapCount);
+		}
+
+		// Turns a given address map entry into a DBI record using the given symbol stream.
+		// Returns nullptr in case the record is not of type S_PUB32, which should only happen for invalid PDBs.
+		PDB_NO_DISCARD const CodeView::DBI::Record* GetAddressMapRecord(const CoalescedMSFStream& symbolRecordStream, uint32_t addressMapEntry) const PDB_NO_EXCEPT;
+
+		// Returns the public symbol closest to the given one-based section offset, i.e. the symbol with the largest offset in the same section that is not larger than the given offset.
+		// Returns nullptr in case there is no such symbol. This does a binary search in the address map, and does not allocate.
+		PDB_NO_DISCARD const CodeView::DBI::Record* FindPublicByAddress(const CoalescedMSFStream& symbolRecordStream, uint16_t oneBasedSectionIndex, uint32_t offsetInSection) const PDB_NO_EXCEPT;
+
+		// Returns the public symbol closest to the given RVA, see FindPublicByAddress().
+		PDB_NO_DISCARD const CodeView::DBI::Record* FindPublicByRVA(const CoalescedMSFStream& symbolRecordStream, const ImageSectionStream& imageSectionStream, uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Returns a view of the thunk map, which stores the RVA of the target of each incremental linking thunk in the thunk table.
+		PDB_NO_DISCARD inline ArrayView<uint32_t> GetThunkMap(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<uint32_t>(m_thunkMap, m_thunkCount);
+		}
+
+		// Returns the RVA of the incremental linking thunk table, or 0 in case the image doesn't contain any thunks.
+		PDB_NO_DISCARD inline uint32_t GetThunkTableRVA(void) const PDB_NO_EXCEPT
+		{
+			return m_thunkTableRVA;
+		}
+
+		// Returns the size of each incremental linking thunk in bytes.
+		PDB_NO_DISCARD inline uint32_t GetThunkSize(void) const PDB_NO_EXCEPT
+		{
+			return m_thunkSize;
+		}
+
+		// Converts an RVA inside an incremental linking thunk into the RVA of the thunk's target in constant time.
+		// Returns 0 in case the RVA doesn't belong to any thunk.
+		PDB_NO_DISCARD uint32_t ConvertThunkRVAToTargetRVA(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Calls the given functor for each record with the given name.
+		// Only the records stored in the hash bucket the name hashes to are inspected.
+		template <typename F>
+		void FindRecordsByName(const CoalescedMSFStream& symbolRecordStream, const char* name, F&& functor) const PDB_NO_EXCEPT
+		{
+			for (const HashRecord& hashRecord : m_hashTable.GetBucketRecords(name))
+			{
+				const CodeView::DBI::Record* record = GetRecord(symbolRecordStream, hashRecord);
+				if (record && SymbolHashTable::HasName(record, name))
+				{
+					functor(record);
+				}
+			}
+		}
+
 	private:
 		CoalescedMSFStream m_stream;
 		const HashRecord* m_hashRecords;
 		uint32_t m_count;
+		SymbolHashTable m_hashTable;
+		const uint32_t* m_addressMap;
+		uint32_t m_addressMapCount;
+		const uint32_t* m_thunkMap;
+		uint32_t m_thunkCount;
+		uint32_t m_thunkSize;
+		uint32_t m_thunkTableRVA;
 
 		PDB_DISABLE_COPY(PublicSymbolStream);
 	};
@@ -6,26 +6,33 @@
 #include "PDB_Types.h"
 #include "PDB_Util.h"
 #include "PDB_DirectMSFStream.h"
+#include "PDB_ChunkedMSFStream.h"
 #include "Foundation/PDB_PointerUtil.h"
-#include "Foundation/PDB_Memory.h"
 #include "Foundation/PDB_Assert.h"
 
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::RawFile::RawFile(RawFile&& other) PDB_NO_EXCEPT
-	: m_data(PDB_MOVE(other.m_data))
+	: m_source(PDB_MOVE(other.m_source))
+	, m_allocator(other.m_allocator)
 	, m_superBlock(PDB_MOVE(other.m_superBlock))
+	, m_ownedSuperBlock(PDB_MOVE(other.m_ownedSuperBlock))
 	, m_directoryStream(PDB_MOVE(other.m_directoryStream))
 	, m_streamCount(PDB_MOVE(other.m_streamCount))
 	, m_streamSizes(PDB_MOVE(other.m_streamSizes))
-	, m_streamBlocks(PDB_MOVE(other.m_streamBlocks))
+	, m_directoryStreamBlocks(PDB_MOVE(other.m_directoryStreamBlocks))
+	, m_streamBlockOffsets(PDB_MOVE(other.m_streamBlockOffsets))
+	, m_resolvedStreamCount(other.m_resolvedStreamCount.load(std::memory_order_acquire))
 {
-	other.m_data = nullptr;
+	other.m_source = BlockSource();
 	other.m_superBlock = nullptr;
+	other.m_ownedSuperBlock = nullptr;
 	other.m_streamCount = 0u;
 	other.m_streamSizes = nullptr;
-	other.m_streamBlocks = nullptr;
+	other.m_directoryStreamBlocks = nullptr;
+	other.m_streamBlockOffsets = nullptr;
+	other.m_resolvedStreamCount.store(0u, std::memory_order_relaxed);
 }
 
 
@@ -35,20 +42,28 @@ PDB::RawFile& PDB::RawFile::operator=(RawFile&& other) PDB_NO_EXCEPT
 {
 	if (this != &other)
 	{
-		PDB_DELETE_ARRAY(m_streamBlocks);
+		FreeArray(m_allocator, m_streamBlockOffsets);
+		FreeArray(m_allocator, m_ownedSuperBlock);
 
-		m_data = PDB_MOVE(other.m_data);
+		m_source = PDB_MOVE(other.m_source);
+		m_allocator = other.m_allocator;
 		m_superBlock = PDB_MOVE(other.m_superBlock);
+		m_ownedSuperBlock = PDB_MOVE(other.m_ownedSuperBlock);
 		m_directoryStream = PDB_MOVE(other.m_directoryStream);
 		m_streamCount = PDB_MOVE(other.m_streamCount);
 		m_streamSizes = PDB_MOVE(other.m_streamSizes);
-		m_streamBlocks = PDB_MOVE(other.m_streamBlocks);
+		m_directoryStreamBlocks = PDB_MOVE(other.m_directoryStreamBlocks);
+		m_streamBlockOffsets = PDB_MOVE(other.m_streamBlockOffsets);
+		m_resolvedStreamCount.store(other.m_resolvedStreamCount.load(std::memory_order_acquire), std::memory_order_relaxed);
 
-		other.m_data = nullptr;
+		other.m_source = BlockSource();
 		other.m_superBlock = nullptr;
+		other.m_ownedSuperBlock = nullptr;
 		other.m_streamCount = 0u;
 		other.m_streamSizes = nullptr;
-		other.m_streamBlocks = nullptr;
+		other.m_directoryStreamBlocks = nullptr;
+		other.m_streamBlockOffsets = nullptr;
+		other.m_resolvedStreamCount.store(0u, std::memory_order_relaxed);
 	}
 
 	return *this;
@@ -58,24 +73,68 @@ PDB::RawFile& PDB::RawFile::operator=(RawFile&& other) PDB_NO_EXCEPT
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::RawFile::RawFile(const void* data) PDB_NO_EXCEPT
-	: m_data(data)
-	, m_superBlock(Pointer::Offset<const SuperBlock*>(data, 0u))
+	: RawFile(BlockSource(data))
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::RawFile::RawFile(const void* data, int fileDescriptor) PDB_NO_EXCEPT
+	: RawFile(BlockSource(data, fileDescriptor))
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::RawFile::RawFile(const BlockSource& source) PDB_NO_EXCEPT
+	: RawFile(source, GetDefaultAllocator())
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::RawFile::RawFile(const BlockSource& source, const Allocator& allocator) PDB_NO_EXCEPT
+	: m_source(source)
+	, m_allocator(allocator)
+	, m_superBlock(Pointer::Offset<const SuperBlock*>(source.GetData(), 0u))
+	, m_ownedSuperBlock(nullptr)
 	, m_directoryStream()
 	, m_streamCount(0u)
 	, m_streamSizes(nullptr)
-	, m_streamBlocks(nullptr)
+	, m_directoryStreamBlocks(nullptr)
+	, m_streamBlockOffsets(nullptr)
+	, m_resolvedStreamCount(0u)
 {
+	if (!source.GetData())
+	{
+		// the file is not memory-mapped, so the SuperBlock including the indices of directory blocks needs to be read first
+		SuperBlock header;
+		source.Read(&header, sizeof(SuperBlock), 0u);
+
+		const uint32_t directoryBlockCount = PDB::ConvertSizeToBlockCount(header.directorySize, header.blockSize);
+		const uint32_t directoryIndicesBlockCount = PDB::ConvertSizeToBlockCount(static_cast<uint32_t>(directoryBlockCount * sizeof(uint32_t)), header.blockSize);
+		const size_t superBlockSize = sizeof(SuperBlock) + directoryIndicesBlockCount * sizeof(uint32_t);
+
+		m_ownedSuperBlock = AllocateArray<Byte>(m_allocator, superBlockSize);
+		source.Read(m_ownedSuperBlock, superBlockSize, 0u);
+		ReportCopy(m_allocator, superBlockSize);
+		m_superBlock = Pointer::Offset<SuperBlock*>(m_ownedSuperBlock, 0u);
+	}
+
 	// the SuperBlock stores an array of indices of blocks that make up the indices of directory blocks, which need to be stitched together to form the directory.
 	// the blocks holding the indices of directory blocks are not necessarily contiguous, so they need to be coalesced first.
 	const uint32_t directoryBlockCount = PDB::ConvertSizeToBlockCount(m_superBlock->directorySize, m_superBlock->blockSize);
 
 	// the directory is made up of directoryBlockCount blocks, so we need that many indices to be read from the blocks that make up the indices
-	CoalescedMSFStream directoryIndicesStream(data, m_superBlock->blockSize, m_superBlock->directoryBlockIndices, directoryBlockCount * sizeof(uint32_t));
+	CoalescedMSFStream directoryIndicesStream(source, m_superBlock->blockSize, m_superBlock->directoryBlockIndices, directoryBlockCount * sizeof(uint32_t), m_allocator);
 
 	// these are the indices of blocks making up the directory stream, now guaranteed to be contiguous
 	const uint32_t* directoryIndices = directoryIndicesStream.GetDataAtOffset<uint32_t>(0u);
 
-	m_directoryStream = CoalescedMSFStream(data, m_superBlock->blockSize, directoryIndices, m_superBlock->directorySize);
+	m_directoryStream = CoalescedMSFStream(source, m_superBlock->blockSize, directoryIndices, m_superBlock->directorySize, m_allocator);
 
 	// https://llvm.org/docs/PDB/MsfFile.html#the-stream-directory
 	// parse the directory from its contiguous version. the directory matches the following struct:
@@ -89,20 +148,13 @@ PDB::RawFile::RawFile(const void* data) PDB_NO_EXCEPT
 
 	// we can assign pointers into the stream directly, since the RawFile keeps ownership of the directory stream
 	m_streamSizes = m_directoryStream.GetDataAtOffset<uint32_t>(sizeof(uint32_t));
-	const uint32_t* directoryStreamBlocks = m_directoryStream.GetDataAtOffset<uint32_t>(sizeof(uint32_t) + sizeof(uint32_t) * m_streamCount);
-
-	// prepare indices for directly accessing individual streams
-	m_streamBlocks = PDB_NEW_ARRAY(const uint32_t*, m_streamCount);
+	m_directoryStreamBlocks = m_directoryStream.GetDataAtOffset<uint32_t>(sizeof(uint32_t) + sizeof(uint32_t) * m_streamCount);
 
-	const uint32_t* indicesForCurrentBlock = directoryStreamBlocks;
-	for (uint32_t i = 0u; i < m_streamCount; ++i)
-	{
-		const uint32_t sizeInBytes = m_streamSizes[i];
-		const uint32_t blockCount = ConvertSizeToBlockCount(sizeInBytes, m_superBlock->blockSize);
-		m_streamBlocks[i] = indicesForCurrentBlock;
-		
-		indicesForCurrentBlock += blockCount;
-	}
+	// the offsets of individual streams' block indices are only resolved once a stream is accessed.
+	// the table is not initialized here, the first stream always starts at offset 0.
+	m_streamBlockOffsets = AllocateArray<std::atomic<uint32_t>>(m_allocator, m_streamCount + 1u);
+	m_streamBlockOffsets[0].store(0u, std::memory_order_relaxed);
+	m_resolvedStreamCount.store(1u, std::memory_order_release);
 }
 
 
@@ -110,7 +162,36 @@ PDB::RawFile::RawFile(const void* data) PDB_NO_EXCEPT
 // ------------------------------------------------------------------------------------------------
 PDB::RawFile::~RawFile(void) PDB_NO_EXCEPT
 {
-	PDB_DELETE_ARRAY(m_streamBlocks);
+	FreeArray(m_allocator, m_streamBlockOffsets);
+	FreeArray(m_allocator, m_ownedSuperBlock);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const uint32_t* PDB::RawFile::GetStreamBlockIndices(uint32_t streamIndex) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(streamIndex < m_streamCount, "Invalid stream index %u.", streamIndex);
+
+	uint32_t resolvedCount = m_resolvedStreamCount.load(std::memory_order_acquire);
+	if (streamIndex >= resolvedCount)
+	{
+		// resolve the prefix sum of block counts up to the requested stream, starting at the last resolved entry
+		uint32_t offset = m_streamBlockOffsets[resolvedCount - 1u].load(std::memory_order_relaxed);
+		for (uint32_t i = resolvedCount; i <= streamIndex; ++i)
+		{
+			offset += ConvertSizeToBlockCount(m_streamSizes[i - 1u], m_superBlock->blockSize);
+			m_streamBlockOffsets[i].store(offset, std::memory_order_relaxed);
+		}
+
+		// publish the new entries, unless another thread already resolved even more of them
+		const uint32_t newResolvedCount = streamIndex + 1u;
+		while ((resolvedCount < newResolvedCount) && !m_resolvedStreamCount.compare_exchange_weak(resolvedCount, newResolvedCount, std::memory_order_release, std::memory_order_acquire))
+		{
+		}
+	}
+
+	return m_directoryStreamBlocks + m_streamBlockOffsets[streamIndex].load(std::memory_order_relaxed);
 }
 
 
@@ -119,7 +200,7 @@ PDB::RawFile::~RawFile(void) PDB_NO_EXCEPT
 template <typename T>
 PDB_NO_DISCARD T PDB::RawFile::CreateMSFStream(uint32_t streamIndex) const PDB_NO_EXCEPT
 {
-	return T(m_data, m_superBlock->blockSize, m_streamBlocks[streamIndex], m_streamSizes[streamIndex]);
+	return T(m_source, m_superBlock->blockSize, GetStreamBlockIndices(streamIndex), m_streamSizes[streamIndex], m_allocator);
 }
 
 
@@ -130,13 +211,23 @@ PDB_NO_DISCARD T PDB::RawFile::CreateMSFStream(uint32_t streamIndex, uint32_t st
 {
 	PDB_ASSERT(streamSize <= m_streamSizes[streamIndex], "Invalid stream size.");
 
-	return T(m_data, m_superBlock->blockSize, m_streamBlocks[streamIndex], streamSize);
+	return T(m_source, m_superBlock->blockSize, GetStreamBlockIndices(streamIndex), streamSize, m_allocator);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::CoalescedMSFStream PDB::RawFile::CreateCoalescedMSFStream(uint32_t streamIndex, const Executor& executor) const PDB_NO_EXCEPT
+{
+	return CoalescedMSFStream(m_source, m_superBlock->blockSize, GetStreamBlockIndices(streamIndex), m_streamSizes[streamIndex], executor, m_allocator);
 }
 
 
 // explicit template instantiation
 template PDB::CoalescedMSFStream PDB::RawFile::CreateMSFStream<PDB::CoalescedMSFStream>(uint32_t streamIndex) const PDB_NO_EXCEPT;
 template PDB::DirectMSFStream PDB::RawFile::CreateMSFStream<PDB::DirectMSFStream>(uint32_t streamIndex) const PDB_NO_EXCEPT;
+template PDB::ChunkedMSFStream PDB::RawFile::CreateMSFStream<PDB::ChunkedMSFStream>(uint32_t streamIndex) const PDB_NO_EXCEPT;
 
 template PDB::CoalescedMSFStream PDB::RawFile::CreateMSFStream<PDB::CoalescedMSFStream>(uint32_t streamIndex, uint32_t streamSize) const PDB_NO_EXCEPT;
 template PDB::DirectMSFStream PDB::RawFile::CreateMSFStream<PDB::DirectMSFStream>(uint32_t streamIndex, uint32_t streamSize) const PDB_NO_EXCEPT;
+template PDB::ChunkedMSFStream PDB::RawFile::CreateMSFStream<PDB::ChunkedMSFStream>(uint32_t streamIndex, uint32_t streamSize) const PDB_NO_EXCEPT;
@@ -6,8 +6,11 @@
 #include "Foundation/PDB_Macros.h"
 #include "Foundation/PDB_DisableWarningsPush.h"
 #include <cstdint>
+#include <atomic>
 #include "Foundation/PDB_DisableWarningsPop.h"
 #include "PDB_CoalescedMSFStream.h"
+#include "PDB_BlockSource.h"
+#include "PDB_Allocator.h"
 
 
 // https://llvm.org/docs/PDB/index.html
@@ -24,6 +27,18 @@ namespace PDB
 
 		explicit RawFile(const void* data) PDB_NO_EXCEPT;
 
+		// Creates a raw file that additionally knows the file descriptor backing the memory-mapped data.
+		// Coalesced streams use the descriptor to remap disjunct blocks instead of copying them, where supported.
+		explicit RawFile(const void* data, int fileDescriptor) PDB_NO_EXCEPT;
+
+		// Creates a raw file that reads all its data from the given block source.
+		// The source does not need to be memory-mapped, in which case all streams are read on demand.
+		explicit RawFile(const BlockSource& source) PDB_NO_EXCEPT;
+
+		// Creates a raw file that allocates all its memory using the given allocator.
+		// Streams created from the file use the same allocator.
+		explicit RawFile(const BlockSource& source, const Allocator& allocator) PDB_NO_EXCEPT;
+
 		~RawFile(void) PDB_NO_EXCEPT;
 
 		// Creates any type of MSF stream.
@@ -34,15 +49,42 @@ namespace PDB
 		template <typename T>
 		PDB_NO_DISCARD T CreateMSFStream(uint32_t streamIndex, uint32_t streamSize) const PDB_NO_EXCEPT;
 
+		// Returns the number of streams in the file.
+		PDB_NO_DISCARD inline uint32_t GetStreamCount(void) const PDB_NO_EXCEPT
+		{
+			return m_streamCount;
+		}
+
+		// Returns the allocator used by the file and all its streams.
+		PDB_NO_DISCARD inline const Allocator& GetAllocator(void) const PDB_NO_EXCEPT
+		{
+			return m_allocator;
+		}
+
+		// Creates a coalesced MSF stream, copying the blocks of large streams in parallel using the given executor.
+		PDB_NO_DISCARD CoalescedMSFStream CreateCoalescedMSFStream(uint32_t streamIndex, const Executor& executor) const PDB_NO_EXCEPT;
+
 	private:
-		const void* m_data;
+		// Returns the indices of the blocks making up the given stream, resolving the stream directory up to the given stream if needed.
+		PDB_NO_DISCARD const uint32_t* GetStreamBlockIndices(uint32_t streamIndex) const PDB_NO_EXCEPT;
+
+		BlockSource m_source;
+		Allocator m_allocator;
 		const SuperBlock* m_superBlock;
+		Byte* m_ownedSuperBlock;
 		CoalescedMSFStream m_directoryStream;
 
 		// stream directory
 		uint32_t m_streamCount;
 		const uint32_t* m_streamSizes;
-		const uint32_t** m_streamBlocks;
+		const uint32_t* m_directoryStreamBlocks;
+
+		// the stream directory is resolved lazily, so that opening a file does not depend on the number of streams it contains.
+		// the i-th entry stores the offset of the i-th stream's first block index into the directory's stream blocks,
+		// i.e. a prefix sum of block counts. only the first m_resolvedStreamCount entries are valid.
+		// entries are deterministic, so threads resolving the same entries concurrently store the same values.
+		std::atomic<uint32_t>* m_streamBlockOffsets;
+		mutable std::atomic<uint32_t> m_resolvedStreamCount;
 
 		PDB_DISABLE_COPY(RawFile);
 	};
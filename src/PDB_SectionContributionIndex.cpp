@@ -0,0 +1,453 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SectionContributionIndex.h"
+#include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
+#include "PDB_SectionContributionStream.h"
+#include "PDB_DBITypes.h"
+#include "PDB_SortUtil.h"
+
+
+namespace
+{
+	// number of contributions converted and sorted by a single task while building the index
+	static constexpr const uint32_t ChunkSize = 65536u;
+
+	// owner of ranges that do not belong to any contribution
+	static constexpr const uint32_t InvalidContribution = 0xFFFFFFFFu;
+
+
+	// a contribution converted into a range of RVAs.
+	// contributions that cannot be mapped into the image are stored as empty ranges, and ignored when building the index.
+	struct ContributionEntry
+	{
+		uint32_t start;
+		uint32_t end;					// exclusive
+		uint32_t index;
+	};
+
+
+	// the RVAs of the contributions stored in a chunk
+	struct ChunkInfo
+	{
+		uint32_t firstStart;			// start of the first non-empty entry
+		uint32_t lastStart;				// start of the last non-empty entry
+		bool hasEntries;
+		bool isSorted;
+	};
+
+
+	struct BuildData
+	{
+		const PDB::DBI::SectionContribution* contributions;
+		const PDB::ImageSectionStream* imageSectionStream;
+		ContributionEntry* entries;
+		ContributionEntry* temporary;
+		ChunkInfo* chunks;
+		uint32_t count;
+		uint32_t sectionCount;
+	};
+
+
+	struct MergeData
+	{
+		const ContributionEntry* source;
+		ContributionEntry* destination;
+		uint32_t count;
+		uint32_t width;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void ConvertChunk(void* taskData, uint32_t chunkIndex) PDB_NO_EXCEPT
+	{
+		const BuildData* data = static_cast<const BuildData*>(taskData);
+
+		const uint32_t first = chunkIndex * ChunkSize;
+		const uint32_t last = (data->count - first < ChunkSize) ? data->count : first + ChunkSize;
+
+		ChunkInfo info = { 0u, 0u, false, true };
+		uint32_t previousStart = 0u;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const PDB::DBI::SectionContribution& contribution = data->contributions[i];
+			ContributionEntry& entry = data->entries[i];
+			entry.index = i;
+
+			if ((contribution.section == 0u) || (contribution.section > data->sectionCount) || (contribution.size == 0u))
+			{
+				// empty entries inherit the start of their predecessor, which keeps sorted chunks sorted
+				entry.start = previousStart;
+				entry.end = previousStart;
+
+				continue;
+			}
+
+			// ranges reaching beyond the 32-bit address space are cut off
+			const uint32_t start = data->imageSectionStream->ConvertSectionOffsetToRVA(contribution.section, contribution.offset);
+			const uint64_t end = static_cast<uint64_t>(start) + contribution.size;
+			entry.start = start;
+			entry.end = (end > 0xFFFFFFFFull) ? 0xFFFFFFFFu : static_cast<uint32_t>(end);
+
+			if (!info.hasEntries)
+			{
+				info.firstStart = start;
+				info.hasEntries = true;
+			}
+			else if (start < previousStart)
+			{
+				info.isSorted = false;
+			}
+
+			info.lastStart = start;
+			previousStart = start;
+		}
+
+		data->chunks[chunkIndex] = info;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void SortChunk(void* taskData, uint32_t chunkIndex) PDB_NO_EXCEPT
+	{
+		const BuildData* data = static_cast<const BuildData*>(taskData);
+		if (data->chunks[chunkIndex].isSorted)
+		{
+			return;
+		}
+
+		const uint32_t first = chunkIndex * ChunkSize;
+		const uint32_t count = (data->count - first < ChunkSize) ? data->count - first : ChunkSize;
+		PDB::SortUtil::RadixSortByKey(data->entries + first, data->temporary + first, count, [](const ContributionEntry& entry) { return entry.start; });
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void MergeRuns(void* taskData, uint32_t pairIndex) PDB_NO_EXCEPT
+	{
+		const MergeData* data = static_cast<const MergeData*>(taskData);
+
+		// merges two adjacent sorted runs, preferring the left one in case of ties to keep the merge stable
+		const uint64_t first = static_cast<uint64_t>(pairIndex) * data->width * 2u;
+		const uint32_t middle = static_cast<uint32_t>((first + data->width < data->count) ? first + data->width : data->count);
+		const uint32_t last = static_cast<uint32_t>((first + data->width * 2ull < data->count) ? first + data->width * 2ull : data->count);
+
+		uint32_t left = static_cast<uint32_t>(first);
+		uint32_t right = middle;
+		uint32_t output = static_cast<uint32_t>(first);
+		while ((left < middle) && (right < last))
+		{
+			if (data->source[right].start < data->source[left].start)
+			{
+				data->destination[output++] = data->source[right++];
+			}
+			else
+			{
+				data->destination[output++] = data->source[left++];
+			}
+		}
+
+		while (left < middle)
+		{
+			data->destination[output++] = data->source[left++];
+		}
+
+		while (right < last)
+		{
+			data->destination[output++] = data->source[right++];
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void AddRange(uint32_t* rangeStarts, uint32_t* rangeOwners, uint32_t& rangeCount, uint32_t start, uint32_t owner) PDB_NO_EXCEPT
+	{
+		if ((rangeCount != 0u) && (rangeStarts[rangeCount - 1u] == start))
+		{
+			// a range starting at the same RVA replaces the previous, empty one
+			--rangeCount;
+		}
+
+		if ((rangeCount == 0u) ? (owner == InvalidContribution) : (rangeOwners[rangeCount - 1u] == owner))
+		{
+			// the range continues the previous one, or is a gap in front of all contributions
+			return;
+		}
+
+		rangeStarts[rangeCount] = start;
+		rangeOwners[rangeCount] = owner;
+		++rangeCount;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void EndRanges(const ContributionEntry* entries, const uint32_t* stack, uint32_t& stackCount, uint32_t* rangeStarts, uint32_t* rangeOwners, uint32_t& rangeCount, uint32_t rva) PDB_NO_EXCEPT
+	{
+		// end all contributions that do not reach the given RVA.
+		// whenever the innermost contribution ends, the enclosing one owns the following bytes again, unless it has ended as well.
+		while ((stackCount != 0u) && (entries[stack[stackCount - 1u]].end <= rva))
+		{
+			const uint32_t end = entries[stack[stackCount - 1u]].end;
+			--stackCount;
+
+			while ((stackCount != 0u) && (entries[stack[stackCount - 1u]].end <= end))
+			{
+				--stackCount;
+			}
+
+			const uint32_t owner = (stackCount != 0u) ? entries[stack[stackCount - 1u]].index : InvalidContribution;
+			AddRange(rangeStarts, rangeOwners, rangeCount, end, owner);
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex::SectionContributionIndex(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_contributions(nullptr)
+	, m_rangeStarts(nullptr)
+	, m_rangeOwners(nullptr)
+	, m_rangeCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex::SectionContributionIndex(SectionContributionIndex&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_contributions(PDB_MOVE(other.m_contributions))
+	, m_rangeStarts(PDB_MOVE(other.m_rangeStarts))
+	, m_rangeOwners(PDB_MOVE(other.m_rangeOwners))
+	, m_rangeCount(PDB_MOVE(other.m_rangeCount))
+{
+	other.m_contributions = nullptr;
+	other.m_rangeStarts = nullptr;
+	other.m_rangeOwners = nullptr;
+	other.m_rangeCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex& PDB::SectionContributionIndex::operator=(SectionContributionIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_rangeStarts);
+		FreeArray(m_allocator, m_rangeOwners);
+
+		m_allocator = other.m_allocator;
+		m_contributions = PDB_MOVE(other.m_contributions);
+		m_rangeStarts = PDB_MOVE(other.m_rangeStarts);
+		m_rangeOwners = PDB_MOVE(other.m_rangeOwners);
+		m_rangeCount = PDB_MOVE(other.m_rangeCount);
+
+		other.m_contributions = nullptr;
+		other.m_rangeStarts = nullptr;
+		other.m_rangeOwners = nullptr;
+		other.m_rangeCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex::SectionContributionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const SectionContributionStream& sectionContributionStream) PDB_NO_EXCEPT
+	: SectionContributionIndex(file, imageSectionStream, sectionContributionStream, Executor { nullptr, nullptr })
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex::SectionContributionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const SectionContributionStream& sectionContributionStream, const Executor& executor) PDB_NO_EXCEPT
+	: m_allocator(file.GetAllocator())
+	, m_contributions(nullptr)
+	, m_rangeStarts(nullptr)
+	, m_rangeOwners(nullptr)
+	, m_rangeCount(0u)
+{
+	const ArrayView<DBI::SectionContribution> contributions = sectionContributionStream.GetContributions();
+	const uint32_t count = static_cast<uint32_t>(contributions.GetLength());
+	if (count == 0u)
+	{
+		return;
+	}
+
+	m_contributions = contributions.Decay();
+
+	// convert all contributions into RVA ranges. linkers emit contributions sorted by section and offset, and sections sorted by RVA,
+	// so the ranges are almost always sorted already.
+	const uint32_t chunkCount = (count + ChunkSize - 1u) / ChunkSize;
+	ContributionEntry* entries = AllocateArray<ContributionEntry>(m_allocator, count);
+	ContributionEntry* temporary = AllocateArray<ContributionEntry>(m_allocator, count);
+	ChunkInfo* chunks = AllocateArray<ChunkInfo>(m_allocator, chunkCount);
+
+	BuildData data = { m_contributions, &imageSectionStream, entries, temporary, chunks, count, static_cast<uint32_t>(imageSectionStream.GetImageSections().GetLength()) };
+	ParallelFor(executor, chunkCount, &ConvertChunk, &data);
+
+	// empty entries are ignored by the sweep below, so only non-empty ones need to be sorted across chunks
+	bool isSorted = true;
+	uint32_t previousStart = 0u;
+	for (uint32_t i = 0u; i < chunkCount; ++i)
+	{
+		const ChunkInfo& info = chunks[i];
+		if (!info.hasEntries)
+		{
+			continue;
+		}
+
+		if (!info.isSorted || (info.firstStart < previousStart))
+		{
+			isSorted = false;
+			break;
+		}
+
+		previousStart = info.lastStart;
+	}
+
+	// otherwise, sort each chunk on its own, and merge pairs of sorted runs until a single run remains
+	const ContributionEntry* sortedEntries = entries;
+	if (!isSorted)
+	{
+		ParallelFor(executor, chunkCount, &SortChunk, &data);
+
+		ContributionEntry* source = entries;
+		ContributionEntry* destination = temporary;
+		for (uint32_t width = ChunkSize; width < count; width = (width > count / 2u) ? count : width * 2u)
+		{
+			MergeData mergeData = { source, destination, count, width };
+			const uint32_t pairCount = static_cast<uint32_t>((count + width * 2ull - 1u) / (width * 2ull));
+			ParallelFor(executor, pairCount, &MergeRuns, &mergeData);
+
+			ContributionEntry* swap = source;
+			source = destination;
+			destination = swap;
+		}
+
+		sortedEntries = source;
+	}
+
+	FreeArray(m_allocator, chunks);
+
+	// sweep over the sorted contributions, keeping a stack of all contributions the current RVA is part of.
+	// each contribution adds at most two ranges: one where it starts, and one where it ends.
+	uint32_t* stack = AllocateArray<uint32_t>(m_allocator, count);
+	uint32_t* rangeStarts = AllocateArray<uint32_t>(m_allocator, count * 2ull);
+	uint32_t* rangeOwners = AllocateArray<uint32_t>(m_allocator, count * 2ull);
+	uint32_t stackCount = 0u;
+	uint32_t rangeCount = 0u;
+
+	for (uint32_t i = 0u; i < count; ++i)
+	{
+		const ContributionEntry& entry = sortedEntries[i];
+		if (entry.start == entry.end)
+		{
+			continue;
+		}
+
+		EndRanges(sortedEntries, stack, stackCount, rangeStarts, rangeOwners, rangeCount, entry.start);
+
+		// a contribution starting at the same RVA as a larger one is nested inside the latter, and must end first
+		uint32_t position = stackCount;
+		while ((position != 0u) && (sortedEntries[stack[position - 1u]].start == entry.start) && (sortedEntries[stack[position - 1u]].end < entry.end))
+		{
+			stack[position] = stack[position - 1u];
+			--position;
+		}
+
+		stack[position] = i;
+		++stackCount;
+
+		AddRange(rangeStarts, rangeOwners, rangeCount, entry.start, sortedEntries[stack[stackCount - 1u]].index);
+	}
+
+	EndRanges(sortedEntries, stack, stackCount, rangeStarts, rangeOwners, rangeCount, 0xFFFFFFFFu);
+
+	FreeArray(m_allocator, stack);
+	FreeArray(m_allocator, entries);
+	FreeArray(m_allocator, temporary);
+
+	// store the ranges without wasting memory
+	m_rangeCount = rangeCount;
+	m_rangeStarts = AllocateArray<uint32_t>(m_allocator, rangeCount);
+	m_rangeOwners = AllocateArray<uint32_t>(m_allocator, rangeCount);
+	std::memcpy(m_rangeStarts, rangeStarts, rangeCount * sizeof(uint32_t));
+	std::memcpy(m_rangeOwners, rangeOwners, rangeCount * sizeof(uint32_t));
+
+	FreeArray(m_allocator, rangeStarts);
+	FreeArray(m_allocator, rangeOwners);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionContributionIndex::~SectionContributionIndex(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_rangeStarts);
+	FreeArray(m_allocator, m_rangeOwners);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::DBI::SectionContribution* PDB::SectionContributionIndex::FindContribution(uint32_t rva) const PDB_NO_EXCEPT
+{
+	// find the first range starting after the given RVA
+	uint32_t first = 0u;
+	uint32_t count = m_rangeCount;
+	while (count > 0u)
+	{
+		const uint32_t step = count / 2u;
+		if (m_rangeStarts[first + step] <= rva)
+		{
+			first += step + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	if (first == 0u)
+	{
+		// the RVA lies in front of all contributions
+		return nullptr;
+	}
+
+	const uint32_t owner = m_rangeOwners[first - 1u];
+	if (owner == InvalidContribution)
+	{
+		// the RVA lies in a gap between contributions, or behind all of them
+		return nullptr;
+	}
+
+	return &m_contributions[owner];
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::ModuleInfoStream::Module* PDB::SectionContributionIndex::FindModule(const ModuleInfoStream& moduleInfoStream, uint32_t rva) const PDB_NO_EXCEPT
+{
+	const DBI::SectionContribution* contribution = FindContribution(rva);
+	if (!contribution || (contribution->moduleIndex >= moduleInfoStream.GetModules().GetLength()))
+	{
+		return nullptr;
+	}
+
+	return &moduleInfoStream.GetModule(contribution->moduleIndex);
+}
@@ -0,0 +1,66 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+#include "PDB_Executor.h"
+#include "PDB_ModuleInfoStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ImageSectionStream;
+	class SectionContributionStream;
+
+	namespace DBI
+	{
+		struct SectionContribution;
+	}
+
+
+	// an immutable index that maps RVAs to the section contributions, and therefore modules, owning them.
+	// the address space is split into disjunct ranges, each of which is owned by exactly one contribution or by none at all.
+	// where contributions overlap, the contribution starting last owns the overlapping range, and enclosing contributions own the rest again.
+	// padding between contributions is not owned by any contribution.
+	// the index refers to the contributions of the given stream, which needs to outlive the index.
+	class PDB_NO_DISCARD SectionContributionIndex
+	{
+	public:
+		SectionContributionIndex(void) PDB_NO_EXCEPT;
+		SectionContributionIndex(SectionContributionIndex&& other) PDB_NO_EXCEPT;
+		SectionContributionIndex& operator=(SectionContributionIndex&& other) PDB_NO_EXCEPT;
+
+		// Builds the index from the given streams. All streams must have been validated before.
+		explicit SectionContributionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const SectionContributionStream& sectionContributionStream) PDB_NO_EXCEPT;
+
+		// Builds the index from the given streams, converting and sorting the contributions in parallel using the given executor.
+		explicit SectionContributionIndex(const RawFile& file, const ImageSectionStream& imageSectionStream, const SectionContributionStream& sectionContributionStream, const Executor& executor) PDB_NO_EXCEPT;
+
+		~SectionContributionIndex(void) PDB_NO_EXCEPT;
+
+		// Returns the contribution owning the given RVA, or nullptr in case the RVA is not part of any contribution.
+		// The contribution's moduleIndex denotes the module it belongs to.
+		PDB_NO_DISCARD const DBI::SectionContribution* FindContribution(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Returns the module owning the given RVA, or nullptr in case the RVA is not part of any contribution.
+		PDB_NO_DISCARD const ModuleInfoStream::Module* FindModule(const ModuleInfoStream& moduleInfoStream, uint32_t rva) const PDB_NO_EXCEPT;
+
+	private:
+		Allocator m_allocator;
+		const DBI::SectionContribution* m_contributions;
+
+		// the start of each range, and the index of the contribution owning it
+		uint32_t* m_rangeStarts;
+		uint32_t* m_rangeOwners;
+		uint32_t m_rangeCount;
+
+		PDB_DISABLE_COPY(SectionContributionIndex);
+	};
+}
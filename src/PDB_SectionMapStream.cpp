@@ -0,0 +1,129 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SectionMapStream.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_ImageSectionStream.h"
+
+
+namespace
+{
+	// used by streams without any entries, so that conversions never need to check for a missing table
+	static const uint32_t NoSegmentRVAs[1u] = { 0u };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(void) PDB_NO_EXCEPT
+	: m_stream()
+	, m_entries(nullptr)
+	, m_count(0u)
+	, m_allocator(GetDefaultAllocator())
+	, m_ownedSegmentRVAs(nullptr)
+	, m_segmentRVAs(NoSegmentRVAs)
+	, m_segmentRVACount(1u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(SectionMapStream&& other) PDB_NO_EXCEPT
+	: m_stream(PDB_MOVE(other.m_stream))
+	, m_entries(PDB_MOVE(other.m_entries))
+	, m_count(PDB_MOVE(other.m_count))
+	, m_allocator(other.m_allocator)
+	, m_ownedSegmentRVAs(PDB_MOVE(other.m_ownedSegmentRVAs))
+	, m_segmentRVAs(PDB_MOVE(other.m_segmentRVAs))
+	, m_segmentRVACount(PDB_MOVE(other.m_segmentRVACount))
+{
+	other.m_entries = nullptr;
+	other.m_count = 0u;
+	other.m_ownedSegmentRVAs = nullptr;
+	other.m_segmentRVAs = NoSegmentRVAs;
+	other.m_segmentRVACount = 1u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream& PDB::SectionMapStream::operator=(SectionMapStream&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_ownedSegmentRVAs);
+
+		m_stream = PDB_MOVE(other.m_stream);
+		m_entries = PDB_MOVE(other.m_entries);
+		m_count = PDB_MOVE(other.m_count);
+		m_allocator = other.m_allocator;
+		m_ownedSegmentRVAs = PDB_MOVE(other.m_ownedSegmentRVAs);
+		m_segmentRVAs = PDB_MOVE(other.m_segmentRVAs);
+		m_segmentRVACount = PDB_MOVE(other.m_segmentRVACount);
+
+		other.m_entries = nullptr;
+		other.m_count = 0u;
+		other.m_ownedSegmentRVAs = nullptr;
+		other.m_segmentRVAs = NoSegmentRVAs;
+		other.m_segmentRVACount = 1u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+	: m_stream(directStream, size, offset)
+	, m_entries(nullptr)
+	, m_count(0u)
+	, m_allocator(directStream.GetAllocator())
+	, m_ownedSegmentRVAs(nullptr)
+	, m_segmentRVAs(NoSegmentRVAs)
+	, m_segmentRVACount(1u)
+{
+	if (size < sizeof(DBI::SectionMapHeader))
+	{
+		// no section map
+		return;
+	}
+
+	// the header is directly followed by the entries
+	const DBI::SectionMapHeader* header = m_stream.GetDataAtOffset<const DBI::SectionMapHeader>(0u);
+	const size_t maximumCount = (size - sizeof(DBI::SectionMapHeader)) / sizeof(DBI::SectionMapEntry);
+
+	m_entries = m_stream.GetDataAtOffset<const DBI::SectionMapEntry>(sizeof(DBI::SectionMapHeader));
+	m_count = (header->count < maximumCount) ? header->count : maximumCount;
+
+	// resolve the RVA of each logical segment once, which turns conversions into a table lookup
+	const ArrayView<IMAGE_SECTION_HEADER> sections = imageSectionStream.GetImageSections();
+
+	m_segmentRVACount = static_cast<uint32_t>(m_count + 1u);
+	m_ownedSegmentRVAs = AllocateArray<uint32_t>(m_allocator, m_segmentRVACount);
+	m_ownedSegmentRVAs[0u] = 0u;
+	for (size_t i = 0u; i < m_count; ++i)
+	{
+		const DBI::SectionMapEntry& entry = m_entries[i];
+		const bool isAbsolute = ((entry.flags & DBI::SectionMapEntry::Flags::IsAbsoluteAddress) != DBI::SectionMapEntry::Flags::None);
+		if (isAbsolute || (entry.frame == 0u) || (entry.frame > sections.GetLength()))
+		{
+			m_ownedSegmentRVAs[i + 1u] = 0u;
+			continue;
+		}
+
+		m_ownedSegmentRVAs[i + 1u] = sections[entry.frame - 1u].VirtualAddress + entry.offset;
+	}
+
+	m_segmentRVAs = m_ownedSegmentRVAs;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::~SectionMapStream(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_ownedSegmentRVAs);
+}
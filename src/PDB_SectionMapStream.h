@@ -0,0 +1,67 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_Allocator.h"
+#include "PDB_DBITypes.h"
+#include "PDB_CoalescedMSFStream.h"
+
+
+namespace PDB
+{
+	class DirectMSFStream;
+	class ImageSectionStream;
+
+
+	// the section map describes the logical segments that symbols and contributions refer to, and the physical sections of the image they live in.
+	class PDB_NO_DISCARD SectionMapStream
+	{
+	public:
+		SectionMapStream(void) PDB_NO_EXCEPT;
+		SectionMapStream(SectionMapStream&& other) PDB_NO_EXCEPT;
+		SectionMapStream& operator=(SectionMapStream&& other) PDB_NO_EXCEPT;
+
+		explicit SectionMapStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+
+		~SectionMapStream(void) PDB_NO_EXCEPT;
+
+		// Converts a one-based logical segment offset into an RVA.
+		// Returns 0 in case the segment does not map to any section of the image, e.g. for absolute symbols.
+		PDB_NO_DISCARD inline uint32_t ConvertSegmentOffsetToRVA(uint16_t oneBasedSegmentIndex, uint32_t offsetInSegment) const PDB_NO_EXCEPT
+		{
+			// unknown segments are redirected to entry 0, and all invalid entries store an RVA of 0, which masks the result without branching
+			const uint32_t index = (oneBasedSegmentIndex < m_segmentRVACount) ? oneBasedSegmentIndex : 0u;
+			const uint32_t segmentRVA = m_segmentRVAs[index];
+
+			return (segmentRVA + offsetInSegment) & (0u - static_cast<uint32_t>(segmentRVA != 0u));
+		}
+
+		// Returns a view of all entries in the stream. The entry at index i describes the logical segment with one-based index i + 1.
+		PDB_NO_DISCARD inline ArrayView<DBI::SectionMapEntry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<DBI::SectionMapEntry>(m_entries, m_count);
+		}
+
+		// Returns the RVA at which each logical segment starts, indexed by its one-based segment index.
+		// Index 0 and segments that do not map to any section of the image store an RVA of 0.
+		PDB_NO_DISCARD inline ArrayView<uint32_t> GetSegmentRVAs(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<uint32_t>(m_segmentRVAs, m_segmentRVACount);
+		}
+
+	private:
+		CoalescedMSFStream m_stream;
+		const DBI::SectionMapEntry* m_entries;
+		size_t m_count;
+
+		Allocator m_allocator;
+		uint32_t* m_ownedSegmentRVAs;
+		const uint32_t* m_segmentRVAs;
+		uint32_t m_segmentRVACount;
+
+		PDB_DISABLE_COPY(SectionMapStream);
+	};
+}
@@ -0,0 +1,168 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#if PDB_SSE2
+#	include <emmintrin.h>
+#endif
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	namespace SortUtil
+	{
+		// returned by searches that find no value
+		static constexpr const uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+		// number of searches that are interleaved when searching for a batch of values
+		static constexpr const size_t SearchBatchSize = 16u;
+
+
+		// Sorts the given entries by the 32-bit key returned by the given functor, using a stable LSD radix sort with one byte of the key per pass.
+		// The temporary array needs to hold at least as many entries, and is clobbered.
+		template <typename T, typename F>
+		inline void RadixSortByKey(T* entries, T* temporary, size_t count, F&& getKey) PDB_NO_EXCEPT
+		{
+			if (count == 0u)
+			{
+				return;
+			}
+
+			T* source = entries;
+			T* destination = temporary;
+
+			for (uint32_t shift = 0u; shift < 32u; shift += 8u)
+			{
+				size_t offsets[256u] = {};
+				for (size_t i = 0u; i < count; ++i)
+				{
+					++offsets[(static_cast<uint32_t>(getKey(source[i])) >> shift) & 0xFFu];
+				}
+
+				// all entries share the same byte, nothing to do in this pass
+				if (offsets[(static_cast<uint32_t>(getKey(source[0])) >> shift) & 0xFFu] == count)
+				{
+					continue;
+				}
+
+				size_t sum = 0u;
+				for (size_t i = 0u; i < 256u; ++i)
+				{
+					const size_t bucketCount = offsets[i];
+					offsets[i] = sum;
+					sum += bucketCount;
+				}
+
+				for (size_t i = 0u; i < count; ++i)
+				{
+					destination[offsets[(static_cast<uint32_t>(getKey(source[i])) >> shift) & 0xFFu]++] = source[i];
+				}
+
+				T* swap = source;
+				source = destination;
+				destination = swap;
+			}
+
+			if (source != entries)
+			{
+				std::memcpy(entries, source, count * sizeof(T));
+			}
+		}
+
+
+		// Sorts the given entries by the 32-bit key returned by the given functor, allocating the temporary array using the given allocator.
+		template <typename T, typename F>
+		inline void RadixSortByKey(const Allocator& allocator, T* entries, size_t count, F&& getKey) PDB_NO_EXCEPT
+		{
+			if (count == 0u)
+			{
+				return;
+			}
+
+			T* temporary = AllocateArray<T>(allocator, count);
+			RadixSortByKey(entries, temporary, count, getKey);
+			FreeArray(allocator, temporary);
+		}
+
+
+		// Returns the index of the last of the given sorted values that is less than or equal to the given value, or InvalidIndex if there is none.
+		PDB_NO_DISCARD inline uint32_t FindLastLessOrEqual(const uint32_t* values, uint32_t count, uint32_t value) PDB_NO_EXCEPT
+		{
+			if (count == 0u)
+			{
+				return InvalidIndex;
+			}
+
+			// branch-free binary search
+			const uint32_t* base = values;
+			uint32_t remaining = count;
+			while (remaining > 1u)
+			{
+				const uint32_t half = remaining / 2u;
+				base = (base[half] <= value) ? base + half : base;
+				remaining -= half;
+			}
+
+			return (*base <= value) ? static_cast<uint32_t>(base - values) : InvalidIndex;
+		}
+
+
+		// Stores the index of the last of the given sorted values that is less than or equal to each of the searched values, or InvalidIndex
+		// if there is none.
+		inline void FindLastLessOrEqual(const uint32_t* values, uint32_t count, const uint32_t* searchedValues, size_t searchedCount, uint32_t* indices) PDB_NO_EXCEPT
+		{
+			if (count == 0u)
+			{
+				for (size_t i = 0u; i < searchedCount; ++i)
+				{
+					indices[i] = InvalidIndex;
+				}
+
+				return;
+			}
+
+			// every search takes the same number of steps, so several values can be searched in lockstep, overlapping their cache misses
+			for (size_t first = 0u; first < searchedCount; first += SearchBatchSize)
+			{
+				const size_t batchCount = (searchedCount - first < SearchBatchSize) ? searchedCount - first : SearchBatchSize;
+				const uint32_t* batchValues = searchedValues + first;
+
+				const uint32_t* bases[SearchBatchSize];
+				for (size_t i = 0u; i < batchCount; ++i)
+				{
+					bases[i] = values;
+				}
+
+				uint32_t remaining = count;
+				while (remaining > 1u)
+				{
+					const uint32_t half = remaining / 2u;
+					remaining -= half;
+
+					for (size_t i = 0u; i < batchCount; ++i)
+					{
+						bases[i] = (bases[i][half] <= batchValues[i]) ? bases[i] + half : bases[i];
+
+#if PDB_SSE2
+						// the value compared against in the next step is known already, fetch it early
+						_mm_prefetch(reinterpret_cast<const char*>(bases[i] + remaining / 2u), _MM_HINT_T0);
+#endif
+					}
+				}
+
+				for (size_t i = 0u; i < batchCount; ++i)
+				{
+					indices[first + i] = (*bases[i] <= batchValues[i]) ? static_cast<uint32_t>(bases[i] - values) : InvalidIndex;
+				}
+			}
+		}
+	}
+}
@@ -10,7 +10,7 @@
 
 namespace PDB
 {
-	class PDB_NO_DISCARD DirectMSFStream;
+	class DirectMSFStream;
 
 
 	class PDB_NO_DISCARD SourceFileStream
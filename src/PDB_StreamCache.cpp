@@ -0,0 +1,279 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_StreamCache.h"
+#include "PDB_RawFile.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <atomic>
+#include "Foundation/PDB_DisableWarningsPop.h"
+
+
+struct PDB::StreamCache::Entry
+{
+	explicit Entry(CoalescedMSFStream&& coalescedStream, const Allocator& entryAllocator) PDB_NO_EXCEPT
+		: stream(PDB_MOVE(coalescedStream))
+		, referenceCount(1u)
+		, allocator(entryAllocator)
+	{
+	}
+
+	void AddReference(void) PDB_NO_EXCEPT
+	{
+		referenceCount.fetch_add(1u, std::memory_order_relaxed);
+	}
+
+	void RemoveReference(void) PDB_NO_EXCEPT
+	{
+		// the last reference frees the entry. acquire-release ensures that all accesses through other references happen before.
+		if (referenceCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+		{
+			const Allocator entryAllocator = allocator;
+			this->~Entry();
+			entryAllocator.free(entryAllocator.userData, this);
+		}
+	}
+
+	const CoalescedMSFStream stream;
+	std::atomic<uint32_t> referenceCount;
+
+	// the entry can outlive the cache, and frees itself using the allocator of the raw file
+	const Allocator allocator;
+
+	PDB_DISABLE_COPY_MOVE(Entry);
+};
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle::Handle(void) PDB_NO_EXCEPT
+	: m_entry(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle::Handle(Entry* entry) PDB_NO_EXCEPT
+	: m_entry(entry)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle::Handle(const Handle& other) PDB_NO_EXCEPT
+	: m_entry(other.m_entry)
+{
+	if (m_entry)
+	{
+		m_entry->AddReference();
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle::Handle(Handle&& other) PDB_NO_EXCEPT
+	: m_entry(PDB_MOVE(other.m_entry))
+{
+	other.m_entry = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle& PDB::StreamCache::Handle::operator=(const Handle& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		// add the new reference first, in case both handles refer to the same entry
+		if (other.m_entry)
+		{
+			other.m_entry->AddReference();
+		}
+
+		if (m_entry)
+		{
+			m_entry->RemoveReference();
+		}
+
+		m_entry = other.m_entry;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle& PDB::StreamCache::Handle::operator=(Handle&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		if (m_entry)
+		{
+			m_entry->RemoveReference();
+		}
+
+		m_entry = PDB_MOVE(other.m_entry);
+
+		other.m_entry = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::Handle::~Handle(void) PDB_NO_EXCEPT
+{
+	if (m_entry)
+	{
+		m_entry->RemoveReference();
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CoalescedMSFStream& PDB::StreamCache::Handle::GetStream(void) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(m_entry != nullptr, "Invalid handle.");
+
+	return m_entry->stream;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::StreamCache(const RawFile& file) PDB_NO_EXCEPT
+	: StreamCache(file, Executor { nullptr, nullptr })
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::StreamCache(const RawFile& file, const Executor& executor) PDB_NO_EXCEPT
+	: m_file(&file)
+	, m_executor(executor)
+	, m_entries(nullptr)
+	, m_states(nullptr)
+	, m_streamCount(file.GetStreamCount())
+	, m_cachedSize(0u)
+	, m_mutex()
+	, m_coalesced()
+{
+	m_entries = AllocateArray<Entry*>(file.GetAllocator(), m_streamCount);
+	m_states = AllocateArray<SlotState>(file.GetAllocator(), m_streamCount);
+
+	for (uint32_t i = 0u; i < m_streamCount; ++i)
+	{
+		m_entries[i] = nullptr;
+		m_states[i] = SlotState::Empty;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::StreamCache::~StreamCache(void) PDB_NO_EXCEPT
+{
+	EvictAll();
+
+	FreeArray(m_file->GetAllocator(), m_states);
+	FreeArray(m_file->GetAllocator(), m_entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::StreamCache::Handle PDB::StreamCache::Acquire(uint32_t streamIndex) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(streamIndex < m_streamCount, "Invalid stream index %u.", streamIndex);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// wait until any other thread coalescing the same stream is done
+	while (m_states[streamIndex] == SlotState::Coalescing)
+	{
+		m_coalesced.wait(lock);
+	}
+
+	if (m_states[streamIndex] == SlotState::Cached)
+	{
+		Entry* entry = m_entries[streamIndex];
+		entry->AddReference();
+
+		return Handle(entry);
+	}
+
+	// this thread is the first to ask for the stream. coalesce it without holding the lock, so that other streams can be acquired meanwhile.
+	m_states[streamIndex] = SlotState::Coalescing;
+	lock.unlock();
+
+	const Allocator& allocator = m_file->GetAllocator();
+	void* memory = allocator.allocate(allocator.userData, sizeof(Entry), alignof(Entry));
+	Entry* entry = new (memory) Entry(m_file->CreateCoalescedMSFStream(streamIndex, m_executor), allocator);
+
+	lock.lock();
+
+	// one reference is held by the cache, the other one by the returned handle
+	entry->AddReference();
+	m_entries[streamIndex] = entry;
+	m_states[streamIndex] = SlotState::Cached;
+	m_cachedSize += entry->stream.GetSize();
+
+	lock.unlock();
+	m_coalesced.notify_all();
+
+	return Handle(entry);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::StreamCache::Evict(uint32_t streamIndex) PDB_NO_EXCEPT
+{
+	PDB_ASSERT(streamIndex < m_streamCount, "Invalid stream index %u.", streamIndex);
+
+	Entry* entry = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_states[streamIndex] != SlotState::Cached)
+		{
+			return;
+		}
+
+		entry = m_entries[streamIndex];
+		m_entries[streamIndex] = nullptr;
+		m_states[streamIndex] = SlotState::Empty;
+		m_cachedSize -= entry->stream.GetSize();
+	}
+
+	// dropping the reference might free the stream, which does not need to happen while holding the lock
+	entry->RemoveReference();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::StreamCache::EvictAll(void) PDB_NO_EXCEPT
+{
+	for (uint32_t i = 0u; i < m_streamCount; ++i)
+	{
+		Evict(i);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::StreamCache::GetCachedSize(void) const PDB_NO_EXCEPT
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_cachedSize;
+}
@@ -0,0 +1,101 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "PDB_CoalescedMSFStream.h"
+#include "PDB_Executor.h"
+
+
+namespace PDB
+{
+	class RawFile;
+
+
+	// a thread-safe cache of coalesced streams of a raw file, keyed by stream index.
+	// each stream is coalesced only once, no matter how many threads ask for it concurrently.
+	// cached streams are reference-counted. evicting a stream only drops the cache's reference, the stream itself is freed once
+	// the last handle referring to it is released.
+	// the raw file needs to outlive the cache and all handles.
+	class PDB_NO_DISCARD StreamCache
+	{
+		struct Entry;
+
+	public:
+		// shared, read-only access to a cached stream.
+		class PDB_NO_DISCARD Handle
+		{
+		public:
+			Handle(void) PDB_NO_EXCEPT;
+			Handle(const Handle& other) PDB_NO_EXCEPT;
+			Handle(Handle&& other) PDB_NO_EXCEPT;
+			Handle& operator=(const Handle& other) PDB_NO_EXCEPT;
+			Handle& operator=(Handle&& other) PDB_NO_EXCEPT;
+			~Handle(void) PDB_NO_EXCEPT;
+
+			// Returns whether the handle refers to a stream.
+			PDB_NO_DISCARD inline bool IsValid(void) const PDB_NO_EXCEPT
+			{
+				return (m_entry != nullptr);
+			}
+
+			// Returns the cached stream.
+			PDB_NO_DISCARD const CoalescedMSFStream& GetStream(void) const PDB_NO_EXCEPT;
+
+		private:
+			friend class StreamCache;
+
+			explicit Handle(Entry* entry) PDB_NO_EXCEPT;
+
+			Entry* m_entry;
+		};
+
+		explicit StreamCache(const RawFile& file) PDB_NO_EXCEPT;
+
+		// Creates a cache that coalesces large streams in parallel using the given executor.
+		explicit StreamCache(const RawFile& file, const Executor& executor) PDB_NO_EXCEPT;
+
+		~StreamCache(void) PDB_NO_EXCEPT;
+
+		// Returns a handle to the coalesced stream with the given index, coalescing the stream first if it is not cached yet.
+		// Threads asking for a stream that is being coalesced by another thread wait until it is available.
+		PDB_NO_DISCARD Handle Acquire(uint32_t streamIndex) PDB_NO_EXCEPT;
+
+		// Drops the cache's reference to the stream with the given index. Streams that are still being coalesced are not evicted.
+		void Evict(uint32_t streamIndex) PDB_NO_EXCEPT;
+
+		// Drops the cache's references to all streams.
+		void EvictAll(void) PDB_NO_EXCEPT;
+
+		// Returns the combined size of all streams currently referenced by the cache.
+		PDB_NO_DISCARD size_t GetCachedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		enum class PDB_NO_DISCARD SlotState : uint8_t
+		{
+			Empty,
+			Coalescing,
+			Cached
+		};
+
+		const RawFile* m_file;
+		Executor m_executor;
+
+		// one slot per stream
+		Entry** m_entries;
+		SlotState* m_states;
+		uint32_t m_streamCount;
+		size_t m_cachedSize;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_coalesced;
+
+		PDB_DISABLE_COPY_MOVE(StreamCache);
+	};
+}
@@ -0,0 +1,274 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SymbolHashTable.h"
+#include "PDB_CoalescedMSFStream.h"
+#include "PDB_Types.h"
+#include "PDB_DBITypes.h"
+
+
+namespace
+{
+	// number of hash buckets, IPHR_HASH in gsi.h
+	static constexpr const uint32_t BucketCount = 4096u;
+
+	// the bitmap of non-empty buckets stores one bit more than there are buckets
+	static constexpr const uint32_t BitmapWordCount = (BucketCount + 32u) / 32u;
+
+	// bucket offsets are stored as if hash records were 12 bytes in size, which is the size of the in-memory HROffsetCalc structure of 32-bit builds
+	static constexpr const uint32_t HashRecordOffsetSize = 12u;
+
+	// marks empty buckets while decoding
+	static constexpr const uint32_t EmptyBucket = 0xFFFFFFFFu;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t HashName(const char* name, size_t length) PDB_NO_EXCEPT
+	{
+		// LHashPbCb, the hash function used by the symbol hash tables
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/misc.h
+		uint32_t hash = 0u;
+
+		size_t i = 0u;
+		for (/* nothing */; i + 4u <= length; i += 4u)
+		{
+			uint32_t value;
+			std::memcpy(&value, name + i, sizeof(uint32_t));
+			hash ^= value;
+		}
+
+		if (length & 2u)
+		{
+			uint16_t value;
+			std::memcpy(&value, name + i, sizeof(uint16_t));
+			hash ^= value;
+			i += 2u;
+		}
+
+		if (length & 1u)
+		{
+			hash ^= static_cast<uint8_t>(name[i]);
+		}
+
+		hash |= 0x20202020u;
+		hash ^= (hash >> 11u);
+		hash ^= (hash >> 16u);
+
+		return hash;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static const char* GetConstantName(const PDB::CodeView::DBI::Record* record) PDB_NO_EXCEPT
+	{
+		// values below LF_NUMERIC are stored directly, others are followed by a numeric leaf of the given kind
+		// https://llvm.org/docs/PDB/CodeViewTypes.html#numeric-leaves
+		const uint16_t value = record->data.S_CONSTANT.value;
+		if (value < 0x8000u)
+		{
+			return record->data.S_CONSTANT.name;
+		}
+
+		size_t leafSize = 0u;
+		switch (value)
+		{
+			case 0x8000u:		// LF_CHAR
+				leafSize = 1u;
+				break;
+
+			case 0x8001u:		// LF_SHORT
+			case 0x8002u:		// LF_USHORT
+				leafSize = 2u;
+				break;
+
+			case 0x8003u:		// LF_LONG
+			case 0x8004u:		// LF_ULONG
+			case 0x8005u:		// LF_REAL32
+				leafSize = 4u;
+				break;
+
+			case 0x8006u:		// LF_REAL64
+			case 0x8009u:		// LF_QUADWORD
+			case 0x800Au:		// LF_UQUADWORD
+				leafSize = 8u;
+				break;
+
+			default:
+				// unsupported leaf kind
+				return nullptr;
+		}
+
+		return record->data.S_CONSTANT.name + leafSize;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolHashTable::SymbolHashTable(void) PDB_NO_EXCEPT
+	: m_allocator(GetDefaultAllocator())
+	, m_hashRecords(nullptr)
+	, m_bucketStarts(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolHashTable::SymbolHashTable(SymbolHashTable&& other) PDB_NO_EXCEPT
+	: m_allocator(other.m_allocator)
+	, m_hashRecords(PDB_MOVE(other.m_hashRecords))
+	, m_bucketStarts(PDB_MOVE(other.m_bucketStarts))
+{
+	other.m_hashRecords = nullptr;
+	other.m_bucketStarts = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolHashTable& PDB::SymbolHashTable::operator=(SymbolHashTable&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		FreeArray(m_allocator, m_bucketStarts);
+
+		m_allocator = other.m_allocator;
+		m_hashRecords = PDB_MOVE(other.m_hashRecords);
+		m_bucketStarts = PDB_MOVE(other.m_bucketStarts);
+
+		other.m_hashRecords = nullptr;
+		other.m_bucketStarts = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolHashTable::SymbolHashTable(const CoalescedMSFStream& stream, size_t headerOffset) PDB_NO_EXCEPT
+	: m_allocator(stream.GetAllocator())
+	, m_hashRecords(nullptr)
+	, m_bucketStarts(nullptr)
+{
+	if (headerOffset + sizeof(HashTableHeader) > stream.GetSize())
+	{
+		return;
+	}
+
+	const HashTableHeader* header = stream.GetDataAtOffset<const HashTableHeader>(headerOffset);
+	const size_t recordsOffset = headerOffset + sizeof(HashTableHeader);
+	const size_t bitmapOffset = recordsOffset + header->size;
+	const uint32_t recordCount = header->size / sizeof(HashRecord);
+
+	m_hashRecords = stream.GetDataAtOffset<const HashRecord>(recordsOffset);
+
+	// tables without a bitmap are treated as having no buckets, which makes all lookups fail
+	if ((header->bucketCount < BitmapWordCount * sizeof(uint32_t)) || (bitmapOffset + header->bucketCount > stream.GetSize()))
+	{
+		return;
+	}
+
+	const uint32_t* bitmap = stream.GetDataAtOffset<const uint32_t>(bitmapOffset);
+	const uint32_t* bucketOffsets = bitmap + BitmapWordCount;
+	const uint32_t bucketOffsetCount = header->bucketCount / sizeof(uint32_t) - BitmapWordCount;
+
+	m_bucketStarts = AllocateArray<uint32_t>(m_allocator, BucketCount + 1u);
+	m_bucketStarts[BucketCount] = recordCount;
+
+	// non-empty buckets store the index of their first record
+	uint32_t nonEmptyBucket = 0u;
+	for (uint32_t i = 0u; i < BucketCount; ++i)
+	{
+		const bool isEmpty = ((bitmap[i / 32u] & (1u << (i % 32u))) == 0u) || (nonEmptyBucket == bucketOffsetCount);
+		if (isEmpty)
+		{
+			m_bucketStarts[i] = EmptyBucket;
+		}
+		else
+		{
+			const uint32_t firstRecord = bucketOffsets[nonEmptyBucket] / HashRecordOffsetSize;
+			m_bucketStarts[i] = (firstRecord < recordCount) ? firstRecord : recordCount;
+			++nonEmptyBucket;
+		}
+	}
+
+	// empty buckets start and end where the next non-empty bucket starts
+	for (uint32_t i = BucketCount; i > 0u; --i)
+	{
+		if (m_bucketStarts[i - 1u] == EmptyBucket)
+		{
+			m_bucketStarts[i - 1u] = m_bucketStarts[i];
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolHashTable::~SymbolHashTable(void) PDB_NO_EXCEPT
+{
+	FreeArray(m_allocator, m_bucketStarts);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::HashRecord> PDB::SymbolHashTable::GetBucketRecords(const char* name) const PDB_NO_EXCEPT
+{
+	if (!m_bucketStarts)
+	{
+		return ArrayView<HashRecord>(nullptr, 0u);
+	}
+
+	const uint32_t bucket = HashName(name, std::strlen(name)) % BucketCount;
+	const uint32_t first = m_bucketStarts[bucket];
+	const uint32_t last = m_bucketStarts[bucket + 1u];
+
+	// offsets of corrupt tables need not be sorted
+	return ArrayView<HashRecord>(m_hashRecords + first, (last > first) ? last - first : 0u);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::SymbolHashTable::HasName(const CodeView::DBI::Record* record, const char* name) PDB_NO_EXCEPT
+{
+	const char* recordName = nullptr;
+	switch (record->header.kind)
+	{
+		case CodeView::DBI::SymbolRecordKind::S_PUB32:
+			recordName = record->data.S_PUB32.name;
+			break;
+
+		case CodeView::DBI::SymbolRecordKind::S_GDATA32:
+		case CodeView::DBI::SymbolRecordKind::S_GTHREAD32:
+		case CodeView::DBI::SymbolRecordKind::S_LDATA32:
+		case CodeView::DBI::SymbolRecordKind::S_LTHREAD32:
+			recordName = record->data.S_GDATA32.name;
+			break;
+
+		case CodeView::DBI::SymbolRecordKind::S_PROCREF:
+		case CodeView::DBI::SymbolRecordKind::S_LPROCREF:
+		case CodeView::DBI::SymbolRecordKind::S_DATAREF:
+			recordName = record->data.S_PROCREF.name;
+			break;
+
+		case CodeView::DBI::SymbolRecordKind::S_UDT:
+			recordName = record->data.S_UDT.name;
+			break;
+
+		case CodeView::DBI::SymbolRecordKind::S_CONSTANT:
+			recordName = GetConstantName(record);
+			break;
+
+		default:
+			break;
+	}
+
+	return recordName && (std::strcmp(recordName, name) == 0);
+}
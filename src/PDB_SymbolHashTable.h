@@ -0,0 +1,53 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_Allocator.h"
+
+
+namespace PDB
+{
+	class CoalescedMSFStream;
+	struct HashRecord;
+
+	namespace CodeView
+	{
+		namespace DBI
+		{
+			struct Record;
+		}
+	}
+
+
+	// The hash table stored in the public and global symbol streams, based on GSIHashTbl defined here:
+	// https://github.com/Microsoft/microsoft-pdb/blob/master/PDB/dbi/gsi.h
+	// The table stores a header, the hash records sorted by bucket, a bitmap of non-empty buckets, and the offset of the first record of each non-empty bucket.
+	class PDB_NO_DISCARD SymbolHashTable
+	{
+	public:
+		SymbolHashTable(void) PDB_NO_EXCEPT;
+		SymbolHashTable(SymbolHashTable&& other) PDB_NO_EXCEPT;
+		SymbolHashTable& operator=(SymbolHashTable&& other) PDB_NO_EXCEPT;
+
+		// Decodes the buckets of the hash table whose header is stored at the given offset.
+		explicit SymbolHashTable(const CoalescedMSFStream& stream, size_t headerOffset) PDB_NO_EXCEPT;
+		~SymbolHashTable(void) PDB_NO_EXCEPT;
+
+		// Returns the hash records stored in the bucket the given name hashes to.
+		// Records of different names can end up in the same bucket, use HasName() to find the records with the given name.
+		PDB_NO_DISCARD ArrayView<HashRecord> GetBucketRecords(const char* name) const PDB_NO_EXCEPT;
+
+		// Returns whether the given record has the given name. Records of kinds that are not stored in hash tables never match.
+		PDB_NO_DISCARD static bool HasName(const CodeView::DBI::Record* record, const char* name) PDB_NO_EXCEPT;
+
+	private:
+		Allocator m_allocator;
+		const HashRecord* m_hashRecords;
+		uint32_t* m_bucketStarts;			// index of the first record of each bucket, followed by the number of records
+
+		PDB_DISABLE_COPY(SymbolHashTable);
+	};
+}
@@ -0,0 +1,155 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_DisableWarningsPush.h"
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "Foundation/PDB_DisableWarningsPop.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "PDB_DBITypes.h"
+#include "PDB_Util.h"
+#include "PDB_CoalescedMSFStream.h"
+#include "PDB_ModuleSymbolStream.h"
+#include "PDB_ModuleSymbolCursor.h"
+
+// visiting records filtered by kind at compile time needs C++17, unlike the rest of the library.
+// this header is therefore never included by any other header, and needs to be included explicitly.
+
+
+namespace PDB
+{
+	// maps a symbol record kind onto the member of CodeView::DBI::Record::Data describing its layout.
+	// kinds without any data, e.g. S_END, have no mapping.
+	template <CodeView::DBI::SymbolRecordKind Kind>
+	struct SymbolRecordData;
+
+#define PDB_SYMBOL_RECORD_DATA(_kind)																				\
+	template <>																										\
+	struct SymbolRecordData<CodeView::DBI::SymbolRecordKind::_kind>													\
+	{																												\
+		using Type = decltype(CodeView::DBI::Record::Data::_kind);													\
+																													\
+		PDB_NO_DISCARD static inline const Type& Get(const CodeView::DBI::Record* record) PDB_NO_EXCEPT				\
+		{																											\
+			return record->data._kind;																				\
+		}																											\
+	}
+
+	PDB_SYMBOL_RECORD_DATA(S_PUB32);
+	PDB_SYMBOL_RECORD_DATA(S_GDATA32);
+	PDB_SYMBOL_RECORD_DATA(S_GTHREAD32);
+	PDB_SYMBOL_RECORD_DATA(S_LDATA32);
+	PDB_SYMBOL_RECORD_DATA(S_LTHREAD32);
+	PDB_SYMBOL_RECORD_DATA(S_OBJNAME);
+	PDB_SYMBOL_RECORD_DATA(S_UDT);
+	PDB_SYMBOL_RECORD_DATA(S_CONSTANT);
+	PDB_SYMBOL_RECORD_DATA(S_PROCREF);
+	PDB_SYMBOL_RECORD_DATA(S_LPROCREF);
+	PDB_SYMBOL_RECORD_DATA(S_DATAREF);
+	PDB_SYMBOL_RECORD_DATA(S_TRAMPOLINE);
+	PDB_SYMBOL_RECORD_DATA(S_SECTION);
+	PDB_SYMBOL_RECORD_DATA(S_COFFGROUP);
+	PDB_SYMBOL_RECORD_DATA(S_THUNK32);
+	PDB_SYMBOL_RECORD_DATA(S_LPROC32);
+	PDB_SYMBOL_RECORD_DATA(S_GPROC32);
+	PDB_SYMBOL_RECORD_DATA(S_LPROC32_ID);
+	PDB_SYMBOL_RECORD_DATA(S_GPROC32_ID);
+	PDB_SYMBOL_RECORD_DATA(S_LPROC32_DPC);
+	PDB_SYMBOL_RECORD_DATA(S_LPROC32_DPC_ID);
+	PDB_SYMBOL_RECORD_DATA(S_BLOCK32);
+	PDB_SYMBOL_RECORD_DATA(S_LABEL32);
+	PDB_SYMBOL_RECORD_DATA(S_BUILDINFO);
+	PDB_SYMBOL_RECORD_DATA(S_COMPILE3);
+	PDB_SYMBOL_RECORD_DATA(S_ENVBLOCK);
+	PDB_SYMBOL_RECORD_DATA(S_INLINESITE);
+	PDB_SYMBOL_RECORD_DATA(S_INLINESITE2);
+
+#undef PDB_SYMBOL_RECORD_DATA
+
+
+	// a strongly typed view of a record whose kind is known at compile time.
+	// kinds sharing the same layout, e.g. S_GPROC32 and S_LPROC32, have views with data of the same type, so a generic functor can handle
+	// them using the same code. the kind of a view can be checked at compile time using 'if constexpr'.
+	template <CodeView::DBI::SymbolRecordKind K>
+	struct SymbolRecordView
+	{
+		static constexpr const CodeView::DBI::SymbolRecordKind Kind = K;
+
+		const CodeView::DBI::Record* record;
+
+		// Returns the data of the record, e.g. record->data.S_GPROC32 for a view of kind S_GPROC32.
+		PDB_NO_DISCARD inline const typename SymbolRecordData<K>::Type& GetData(void) const PDB_NO_EXCEPT
+		{
+			return SymbolRecordData<K>::Get(record);
+		}
+	};
+
+
+	// Hands the given record to the functor as a SymbolRecordView of its kind, in case its kind is one of the given kinds.
+	// Returns whether the functor was called.
+	// Records outside of the range spanned by the given kinds are dropped using a single compare. The remaining kinds are compared
+	// against constants only, which compilers lower like a switch statement.
+	template <CodeView::DBI::SymbolRecordKind... Kinds, typename F>
+	inline bool VisitSymbolOfKind(const CodeView::DBI::Record* record, F&& functor) PDB_NO_EXCEPT
+	{
+		static_assert(sizeof...(Kinds) != 0u, "At least one kind needs to be given.");
+
+		constexpr uint16_t minKind = std::min({ PDB_AS_UNDERLYING(Kinds)... });
+		constexpr uint16_t maxKind = std::max({ PDB_AS_UNDERLYING(Kinds)... });
+
+		const uint16_t kind = PDB_AS_UNDERLYING(record->header.kind);
+		if (static_cast<uint16_t>(kind - minKind) > maxKind - minKind)
+		{
+			return false;
+		}
+
+		return ((kind == PDB_AS_UNDERLYING(Kinds) ? (functor(SymbolRecordView<Kinds> { record }), true) : false) || ...);
+	}
+
+
+	// Iterates all records in the symbol record stream, handing records of the given kinds to the functor as a SymbolRecordView.
+	// The symbol record stream holds the records of all public and global symbols, see DBIStream::CreateSymbolRecordStream().
+	template <CodeView::DBI::SymbolRecordKind... Kinds, typename F>
+	inline void ForEachSymbolOfKind(const CoalescedMSFStream& symbolRecordStream, F&& functor) PDB_NO_EXCEPT
+	{
+		// unlike module symbol streams, the symbol record stream has no signature
+		size_t offset = 0u;
+
+		while (offset + sizeof(CodeView::DBI::RecordHeader) <= symbolRecordStream.GetSize())
+		{
+			const CodeView::DBI::Record* record = symbolRecordStream.GetDataAtOffset<const CodeView::DBI::Record>(offset);
+			const uint32_t recordSize = GetCodeViewRecordSize(record);
+
+			VisitSymbolOfKind<Kinds...>(record, functor);
+
+			offset = BitUtil::RoundUpToMultiple<size_t>(offset + sizeof(CodeView::DBI::RecordHeader) + recordSize, 4u);
+		}
+	}
+
+
+	// Iterates all records in the module symbol stream, handing records of the given kinds to the functor as a SymbolRecordView.
+	// e.g. ForEachSymbolOfKind<S_GPROC32, S_LPROC32>(moduleSymbolStream, [](const auto& view) { ... view.GetData().name ... });
+	template <CodeView::DBI::SymbolRecordKind... Kinds, typename F>
+	inline void ForEachSymbolOfKind(const ModuleSymbolStream& moduleSymbolStream, F&& functor) PDB_NO_EXCEPT
+	{
+		moduleSymbolStream.ForEachSymbol([&functor](const CodeView::DBI::Record* record)
+		{
+			VisitSymbolOfKind<Kinds...>(record, functor);
+		});
+	}
+
+
+	// Iterates all remaining records of the cursor, handing records of the given kinds to the functor as a SymbolRecordView.
+	template <CodeView::DBI::SymbolRecordKind... Kinds, typename F>
+	inline void ForEachSymbolOfKind(ModuleSymbolCursor& cursor, F&& functor) PDB_NO_EXCEPT
+	{
+		cursor.ForEachSymbol([&functor](const CodeView::DBI::Record* record)
+		{
+			VisitSymbolOfKind<Kinds...>(record, functor);
+		});
+	}
+}
@@ -10,3 +10,6 @@ const char PDB::SuperBlock::MAGIC[30u] = "Microsoft C/C++ MSF 7.00\r\n\x1a\x44\x
 
 const uint32_t PDB::HashTableHeader::Signature = 0xffffffffu;
 const uint32_t PDB::HashTableHeader::Version = 0xeffe0000u + 19990810u;
+
+// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/nmtni.h#L77
+const uint32_t PDB::NamesHeader::Signature = 0xeffeeffeu;
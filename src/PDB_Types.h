@@ -17,7 +17,7 @@ namespace PDB
 	// this matches the definition in guiddef.h, but we don't want to pull that in
 	struct GUID
 	{
-		unsigned long  Data1;
+		uint32_t       Data1;
 		unsigned short Data2;
 		unsigned short Data3;
 		unsigned char  Data4[8];
@@ -31,17 +31,17 @@ namespace PDB
 		unsigned char Name[8];
 		union
 		{
-			unsigned long PhysicalAddress;
-			unsigned long VirtualSize;
+			uint32_t PhysicalAddress;
+			uint32_t VirtualSize;
 		} Misc;
-		unsigned long VirtualAddress;
-		unsigned long SizeOfRawData;
-		unsigned long PointerToRawData;
-		unsigned long PointerToRelocations;
-		unsigned long PointerToLinenumbers;
+		uint32_t VirtualAddress;
+		uint32_t SizeOfRawData;
+		uint32_t PointerToRawData;
+		uint32_t PointerToRelocations;
+		uint32_t PointerToLinenumbers;
 		unsigned short NumberOfRelocations;
 		unsigned short NumberOfLinenumbers;
-		unsigned long Characteristics;
+		uint32_t Characteristics;
 	};
 
 	static_assert(sizeof(IMAGE_SECTION_HEADER) == 40u, "Size mismatch.");
@@ -113,6 +113,17 @@ namespace PDB
 		};
 	};
 
+	// header of the "/names" stream, which stores the file names referenced by the C13 line information of all modules
+	// https://llvm.org/docs/PDB/StringTable.html
+	struct NamesHeader
+	{
+		static const uint32_t Signature;
+
+		uint32_t signature;
+		uint32_t hashVersion;
+		uint32_t size;				// size of the string buffer following the header
+	};
+
 	// https://llvm.org/docs/PDB/PdbStream.html#pdb-feature-codes
 	enum class PDB_NO_DISCARD FeatureCode : uint32_t
 	{
@@ -139,6 +150,16 @@ namespace PDB
 		uint16_t padding2;
 	};
 
+	// entry of the section map stored at the end of the public stream, mapping the thunk map's RVAs back to sections.
+	// based on SO defined here:
+	// https://github.com/Microsoft/microsoft-pdb/blob/master/PDB/dbi/gsi.h
+	struct PublicStreamSectionMapEntry
+	{
+		uint32_t offset;			// RVA of the section
+		uint16_t section;			// one-based section index
+		uint16_t padding;
+	};
+
 	// header of the hash tables used by the public and global symbol stream, based on GSIHashHdr defined here:
 	// https://github.com/Microsoft/microsoft-pdb/blob/master/PDB/dbi/gsi.h#L62
 	struct HashTableHeader